@@ -0,0 +1,518 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>       // clock_gettime()
+#include <unistd.h>     // fork()
+#include <sys/resource.h> // getrusage()
+#include <sys/wait.h>   // waitpid()
+#include "jsonParser.h"
+
+//
+// Benchmark
+// ** `make bench` (or ./benchmark [-r repetitions] [-w warmup] [-s MB] [-j] [file ...])
+// ** Every workload (the corpus below, then each file given) runs in a child process of its own, so that
+//    its peak RSS is not the one of an earlier workload. Each operation runs `warmup` times untimed,
+//    then `repetitions` times: the median is reported.
+// ** Allocations are counted by wrapping malloc(), calloc() and realloc() at link time
+//    (BENCH_COUNT_ALLOCATIONS, see the Makefile); without it they are reported as -1.
+// ** -j prints one JSON object per line (workload, operation and metrics) to track results over time.
+//
+
+//
+// Allocation Counters
+//
+static long long g_allocCount = 0;
+static long long g_allocBytes = 0;
+
+#ifdef BENCH_COUNT_ALLOCATIONS
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size)
+{
+    g_allocCount++;
+    g_allocBytes += (long long)size;
+    return __real_malloc( size );
+}
+
+void *__wrap_calloc(size_t count, size_t size)
+{
+    g_allocCount++;
+    g_allocBytes += (long long)(count * size);
+    return __real_calloc( count, size );
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    g_allocCount++;
+    g_allocBytes += (long long)size;
+    return __real_realloc( ptr, size );
+}
+#define ALLOCATIONS_COUNTED 1
+#else
+#define ALLOCATIONS_COUNTED 0
+#endif
+
+//
+// Input Text
+//
+typedef struct
+{
+    char  *data;
+    size_t size;
+    size_t capacity;
+} Text;
+
+static void appendText(Text *pText, const char *bytes, size_t size)
+{
+    if( pText->size + size + 1 > pText->capacity ) {
+        size_t newCapacity = pText->capacity ? pText->capacity : 4096;
+        while( pText->size + size + 1 > newCapacity ) { newCapacity *= 2; }
+        pText->data = (char *)realloc( pText->data, newCapacity );
+        if( !pText->data ) {
+            fprintf( stderr, "Out of memory\n" );
+            exit( 1 );
+        }
+        pText->capacity = newCapacity;
+    }
+    memcpy( pText->data + pText->size, bytes, size );
+    pText->size += size;
+    pText->data[pText->size] = '\0';
+}
+
+static void appendFormat(Text *pText, const char *format, ...)
+{
+    char buffer[512];
+    va_list args;
+    va_start( args, format );
+    int size = vsnprintf( buffer, sizeof(buffer), format, args );
+    va_end( args );
+    appendText( pText, buffer, (size_t)size );
+}
+
+static int readFile(Text *pText, const char *path)
+{
+    FILE *fp = fopen( path, "rb" );
+    if( !fp ) { return 0; }
+
+    char buffer[64 * 1024];
+    size_t readBytes;
+    while( (readBytes = fread( buffer, 1, sizeof(buffer), fp )) > 0 ) {
+        appendText( pText, buffer, readBytes );
+    }
+    fclose( fp );
+    return 1;
+}
+
+//
+// Synthetic Workloads (deterministic: the same bytes on every run)
+//
+static uint64_t g_random = 0x9E3779B97F4A7C15ull;
+
+static uint32_t nextRandom(void)
+{
+    g_random ^= g_random << 13;
+    g_random ^= g_random >> 7;
+    g_random ^= g_random << 17;
+    return (uint32_t)(g_random >> 16);
+}
+
+static void makeNumbers(Text *pText, size_t targetSize)
+{
+    appendText( pText, "[", 1 );
+    for( size_t i = 0; pText->size < targetSize; i++ ) {
+        if( i ) { appendText( pText, ",", 1 ); }
+        switch( nextRandom() % 4 ) {
+            case 0:  appendFormat( pText, "%u", nextRandom() % 1000 ); break;
+            case 1:  appendFormat( pText, "%lld", (long long)(((uint64_t)nextRandom() << 32) | nextRandom()) ); break;
+            case 2:  appendFormat( pText, "%.17g", (double)nextRandom() / (double)nextRandom() ); break;
+            default: appendFormat( pText, "%.3fe%d", (double)(nextRandom() % 100000) / 1000.0, (int)(nextRandom() % 40) - 20 ); break;
+        }
+    }
+    appendText( pText, "]", 1 );
+}
+
+static void makeStrings(Text *pText, size_t targetSize)
+{
+    static const char *parts[] = {
+        "lorem ", "ipsum ", "dolor ", "sit amet, ", "consectetur ", "\\\"quoted\\\" ", "tab\\t", "line\\n",
+        "\\u00e9t\\u00e9 ", "\xed\x95\x9c\xea\xb8\x80 ", "caf\xc3\xa9 ", "\\ud83d\\ude00 ", "path\\/to ",
+    };
+    appendText( pText, "[", 1 );
+    for( size_t i = 0; pText->size < targetSize; i++ ) {
+        if( i ) { appendText( pText, ",", 1 ); }
+        appendText( pText, "\"", 1 );
+        for( uint32_t n = 1 + nextRandom() % 24; n; n-- ) {
+            const char *part = parts[nextRandom() % (sizeof(parts) / sizeof(parts[0]))];
+            appendText( pText, part, strlen( part ) );
+        }
+        appendText( pText, "\"", 1 );
+    }
+    appendText( pText, "]", 1 );
+}
+
+// Objects and arrays nested 512 deep, side by side in the root array
+static void makeNested(Text *pText, size_t targetSize)
+{
+    const int depth = 512;
+    appendText( pText, "[", 1 );
+    for( size_t i = 0; pText->size < targetSize; i++ ) {
+        if( i ) { appendText( pText, ",", 1 ); }
+        for( int d = 0; d < depth; d++ ) { appendText( pText, (d & 1) ? "[" : "{\"child\":", (d & 1) ? 1 : 9 ); }
+        appendFormat( pText, "%u", nextRandom() % 100 );
+        for( int d = depth - 1; d >= 0; d-- ) { appendText( pText, (d & 1) ? "]" : "}", 1 ); }
+    }
+    appendText( pText, "]", 1 );
+}
+
+// Objects of 256 members (above JSON_OBJECT_INDEX_THRESHOLD)
+static void makeWideObjects(Text *pText, size_t targetSize)
+{
+    appendText( pText, "[", 1 );
+    for( size_t i = 0; pText->size < targetSize; i++ ) {
+        if( i ) { appendText( pText, ",", 1 ); }
+        appendText( pText, "{", 1 );
+        for( int m = 0; m < 256; m++ ) {
+            appendFormat( pText, "%s\"field_%d\":", m ? "," : "", m );
+            if( m % 3 == 0 )      { appendFormat( pText, "%u", nextRandom() ); }
+            else if( m % 3 == 1 ) { appendFormat( pText, "\"value %u\"", nextRandom() % 10000 ); }
+            else                  { appendText( pText, (nextRandom() & 1) ? "true" : "null", 4 ); }
+        }
+        appendText( pText, "}", 1 );
+    }
+    appendText( pText, "]", 1 );
+}
+
+static void makeJsonLines(Text *pText, size_t targetSize)
+{
+    for( uint32_t id = 0; pText->size < targetSize; id++ ) {
+        appendFormat( pText, "{\"id\":%u,\"user\":\"user%u\",\"score\":%.4f,\"active\":%s,\"tags\":[\"t%u\",\"t%u\"],\"geo\":{\"lat\":%.6f,\"lon\":%.6f}}\n",
+            id, nextRandom() % 100000, (double)nextRandom() / 4294967296.0 * 100.0, (nextRandom() & 1) ? "true" : "false",
+            nextRandom() % 50, nextRandom() % 50, (double)nextRandom() / 4294967296.0 * 180.0 - 90.0, (double)nextRandom() / 4294967296.0 * 360.0 - 180.0 );
+    }
+}
+
+// Copies of a document in a root array
+static int makeScaled(Text *pText, const char *path, size_t targetSize)
+{
+    Text document = { 0, };
+    if( !readFile( &document, path ) ) { return 0; }
+
+    appendText( pText, "[", 1 );
+    for( size_t i = 0; pText->size < targetSize; i++ ) {
+        if( i ) { appendText( pText, ",\n", 2 ); }
+        appendText( pText, document.data, document.size );
+    }
+    appendText( pText, "]", 1 );
+    free( document.data );
+    return 1;
+}
+
+//
+// Measurement
+//
+typedef struct
+{
+    const char *operation;
+    double      seconds;     // median
+    long long   allocCount;  // per run (-1: not counted)
+    long long   allocBytes;
+} Result;
+
+typedef struct
+{
+    int    repetitions;
+    int    warmup;
+    size_t targetSize;
+    int    jsonOutput;
+} Settings;
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// The timed part of a run: its seconds and allocations
+typedef struct
+{
+    double    start;
+    long long allocCount;
+    long long allocBytes;
+} Timer;
+
+static void startTimer(Timer *pTimer)
+{
+    pTimer->allocCount = g_allocCount;
+    pTimer->allocBytes = g_allocBytes;
+    pTimer->start = now();
+}
+
+static double stopTimer(Timer *pTimer)
+{
+    double seconds = now() - pTimer->start;
+    pTimer->allocCount = g_allocCount - pTimer->allocCount;
+    pTimer->allocBytes = g_allocBytes - pTimer->allocBytes;
+    return seconds;
+}
+
+static int compareDouble(const void *pA, const void *pB)
+{
+    double a = *(const double *)pA, b = *(const double *)pB;
+    return (a > b) - (a < b);
+}
+
+static double median(double *times, int count)
+{
+    qsort( times, (size_t)count, sizeof(double), compareDouble );
+    return (count & 1) ? times[count / 2] : (times[count / 2 - 1] + times[count / 2]) / 2.0;
+}
+
+static size_t countNodes(const Element *pElement)
+{
+    size_t count = 1;
+    if( pElement->type == TYPE_ARRAY ) {
+        for( uint32_t i = 0; i < pElement->length; i++ ) { count += countNodes( &(pElement->arrayValue[i]) ); }
+    }
+    else if( pElement->type == TYPE_OBJECT ) {
+        for( uint32_t i = 0; i < pElement->length; i++ ) { count += countNodes( &(pElement->objectValue[i].element) ); }
+    }
+    return count;
+}
+
+typedef enum
+{
+    OP_PARSE,           // parseJsonBuffer() (then resetElement(), untimed)
+    OP_TEARDOWN,        // resetElement() (after parseJsonBuffer(), untimed)
+    OP_PARSE_ARENA,     // parseJsonBufferArena() (then clearJsonArena())
+    OP_PARSE_TWO_STAGE, // parseJsonBufferEx() with JSON_PARSE_TWO_STAGE and an arena
+    OP_SERIALIZE,       // writeJson() of the parsed tree
+    OP_JSON_LINES_1,    // parseJsonLines() on one thread
+    OP_JSON_LINES_N     // parseJsonLines() on every online CPU
+} Operation;
+
+static const char *OPERATION_NAMES[] = {
+    "parse", "teardown", "parse-arena", "parse-two-stage", "serialize", "lines-1-thread", "lines-all-threads",
+};
+
+// One run: returns the timed seconds (negative on failure), pTimer has the allocations
+static double runOnce(Operation operation, const Text *pInput, const Element *pTree, JsonArena *pArena, Timer *pTimer)
+{
+    Element element = { 0, };
+    JsonParseOptions options = { 0, };
+    JsonRecordSet records;
+    double seconds = -1.0;
+
+    switch( operation ) {
+        case OP_PARSE:
+            startTimer( pTimer );
+            if( parseJsonBuffer( &element, pInput->data, pInput->size, NULL ) == JPE_NO_ERROR ) { seconds = stopTimer( pTimer ); }
+            resetElement( &element );
+            break;
+        case OP_TEARDOWN:
+            if( parseJsonBuffer( &element, pInput->data, pInput->size, NULL ) == JPE_NO_ERROR ) {
+                startTimer( pTimer );
+                resetElement( &element );
+                seconds = stopTimer( pTimer );
+            }
+            else {
+                resetElement( &element );
+            }
+            break;
+        case OP_PARSE_ARENA:
+            startTimer( pTimer );
+            if( parseJsonBufferArena( &element, pInput->data, pInput->size, pArena, NULL ) == JPE_NO_ERROR ) { seconds = stopTimer( pTimer ); }
+            clearJsonArena( pArena );
+            break;
+        case OP_PARSE_TWO_STAGE:
+            options.flags = JSON_PARSE_TWO_STAGE;
+            options.pArena = pArena;
+            startTimer( pTimer );
+            if( parseJsonBufferEx( &element, pInput->data, pInput->size, &options, NULL ) == JPE_NO_ERROR ) { seconds = stopTimer( pTimer ); }
+            clearJsonArena( pArena );
+            break;
+        case OP_SERIALIZE:
+        {
+            startTimer( pTimer );
+            char *text = writeJson( pTree, 0, NULL );
+            if( text ) { seconds = stopTimer( pTimer ); }
+            free( text );
+        }
+        break;
+        case OP_JSON_LINES_1:
+        case OP_JSON_LINES_N:
+            startTimer( pTimer );
+            if( parseJsonLines( &records, pInput->data, pInput->size, NULL, operation == OP_JSON_LINES_1 ? 1 : 0 ) == JPE_NO_ERROR ) { seconds = stopTimer( pTimer ); }
+            releaseJsonRecordSet( &records );
+            break;
+    }
+    return seconds;
+}
+
+static int measure(Operation operation, const Text *pInput, const Element *pTree, const Settings *pSettings, Result *pOutResult)
+{
+    JsonArena arena;
+    initJsonArena( &arena, 0 );
+
+    Timer timer;
+    for( int i = 0; i < pSettings->warmup; i++ ) { runOnce( operation, pInput, pTree, &arena, &timer ); }
+
+    double *times = (double *)malloc( (size_t)pSettings->repetitions * sizeof(double) );
+    int ok = (times != NULL);
+    for( int i = 0; ok && i < pSettings->repetitions; i++ ) {
+        times[i] = runOnce( operation, pInput, pTree, &arena, &timer );
+        ok = (times[i] >= 0.0);
+    }
+    if( ok ) {
+        // Allocations of the last run (an arena keeps its chunks from one run to the next)
+        pOutResult->allocCount = ALLOCATIONS_COUNTED ? timer.allocCount : -1;
+        pOutResult->allocBytes = ALLOCATIONS_COUNTED ? timer.allocBytes : -1;
+        pOutResult->operation = OPERATION_NAMES[operation];
+        pOutResult->seconds = median( times, pSettings->repetitions );
+    }
+    free( times );
+    releaseJsonArena( &arena );
+    return ok;
+}
+
+static void report(const char *workload, const Text *pInput, size_t nodeCount, const Result *pResult, long peakRssKb, const Settings *pSettings)
+{
+    double megabytesPerSecond = (double)pInput->size / pResult->seconds / 1e6;
+    double nanosecondsPerNode = nodeCount ? pResult->seconds * 1e9 / (double)nodeCount : 0.0;
+
+    if( pSettings->jsonOutput ) {
+        printf( "{\"workload\":\"%s\",\"operation\":\"%s\",\"bytes\":%zu,\"nodes\":%zu,\"repetitions\":%d,\"seconds\":%.9f,"
+                "\"mbPerSecond\":%.2f,\"nsPerNode\":%.2f,\"allocations\":%lld,\"allocatedBytes\":%lld,\"peakRssKb\":%ld}\n",
+            workload, pResult->operation, pInput->size, nodeCount, pSettings->repetitions, pResult->seconds,
+            megabytesPerSecond, nanosecondsPerNode, pResult->allocCount, pResult->allocBytes, peakRssKb );
+    }
+    else {
+        printf( "%-14s %-18s %10.2f %10.1f %9.2f %12lld %12.2f %10ld\n",
+            workload, pResult->operation, (double)pInput->size / 1e6, megabytesPerSecond, nanosecondsPerNode,
+            pResult->allocCount, pResult->allocBytes < 0 ? -1.0 : (double)pResult->allocBytes / 1e6, peakRssKb );
+    }
+}
+
+// In a child process: every operation on one input
+static int runWorkload(const char *workload, const Text *pInput, int isJsonLines, const Settings *pSettings)
+{
+    static const Operation DOCUMENT_OPERATIONS[] = { OP_PARSE, OP_TEARDOWN, OP_PARSE_ARENA, OP_PARSE_TWO_STAGE, OP_SERIALIZE };
+    static const Operation JSON_LINES_OPERATIONS[] = { OP_JSON_LINES_1, OP_JSON_LINES_N };
+    const Operation *operations = isJsonLines ? JSON_LINES_OPERATIONS : DOCUMENT_OPERATIONS;
+    size_t operationCount = isJsonLines ? 2 : 5;
+
+    // The tree to serialize, and the nodes to report ns/node
+    Element tree = { 0, };
+    size_t nodeCount = 0;
+    if( isJsonLines ) {
+        JsonRecordSet records;
+        if( parseJsonLines( &records, pInput->data, pInput->size, NULL, 0 ) == JPE_NO_ERROR ) {
+            for( size_t i = 0; i < records.count; i++ ) { nodeCount += countNodes( &(records.records[i].element) ); }
+        }
+        releaseJsonRecordSet( &records );
+    }
+    else {
+        JsonErrorInfo errorInfo;
+        if( parseJsonBuffer( &tree, pInput->data, pInput->size, &errorInfo ) != JPE_NO_ERROR ) {
+            fprintf( stderr, "%s: error %d at line %zu, column %zu\n", workload, (int)errorInfo.error, errorInfo.line, errorInfo.column );
+            resetElement( &tree );
+            return 0;
+        }
+        nodeCount = countNodes( &tree );
+    }
+
+    Result results[8];
+    int ok = 1;
+    for( size_t i = 0; ok && i < operationCount; i++ ) {
+        ok = measure( operations[i], pInput, &tree, pSettings, &(results[i]) );
+        if( !ok ) { fprintf( stderr, "%s: %s failed\n", workload, OPERATION_NAMES[operations[i]] ); }
+    }
+    resetElement( &tree );
+
+    struct rusage usage;
+    getrusage( RUSAGE_SELF, &usage );
+    long peakRssKb = usage.ru_maxrss; // (kilobytes on Linux)
+    for( size_t i = 0; ok && i < operationCount; i++ ) {
+        report( workload, pInput, nodeCount, &(results[i]), peakRssKb, pSettings );
+    }
+    return ok;
+}
+
+typedef enum { WORKLOAD_FILE, WORKLOAD_NUMBERS, WORKLOAD_STRINGS, WORKLOAD_NESTED, WORKLOAD_WIDE, WORKLOAD_JSON_LINES, WORKLOAD_SCALED } WorkloadKind;
+
+// Returns 0 if the workload failed
+static int forkWorkload(const char *workload, WorkloadKind kind, const char *path, const Settings *pSettings)
+{
+    fflush( stdout );
+    pid_t pid = fork();
+    if( pid < 0 ) {
+        perror( "fork" );
+        return 0;
+    }
+    if( pid == 0 ) {
+        Text input = { 0, };
+        int ok = 1;
+        switch( kind ) {
+            case WORKLOAD_FILE:       ok = readFile( &input, path ); break;
+            case WORKLOAD_NUMBERS:    makeNumbers( &input, pSettings->targetSize ); break;
+            case WORKLOAD_STRINGS:    makeStrings( &input, pSettings->targetSize ); break;
+            case WORKLOAD_NESTED:     makeNested( &input, pSettings->targetSize ); break;
+            case WORKLOAD_WIDE:       makeWideObjects( &input, pSettings->targetSize ); break;
+            case WORKLOAD_JSON_LINES: makeJsonLines( &input, pSettings->targetSize ); break;
+            case WORKLOAD_SCALED:     ok = makeScaled( &input, path, pSettings->targetSize * 8 ); break;
+        }
+        if( !ok ) { fprintf( stderr, "%s: cannot read %s\n", workload, path ); }
+        ok = ok && runWorkload( workload, &input, kind == WORKLOAD_JSON_LINES, pSettings );
+        free( input.data );
+        fflush( stdout );
+        _exit( ok ? 0 : 1 );
+    }
+
+    int status = 0;
+    waitpid( pid, &status, 0 );
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+int main(int argc, char *argv[])
+{
+    Settings settings = { .repetitions = 5, .warmup = 1, .targetSize = 8 * 1000 * 1000, .jsonOutput = 0, };
+    int firstFile = argc;
+
+    for( int i = 1; i < argc; i++ ) {
+        if( !strcmp( argv[i], "-r" ) && i + 1 < argc )      { settings.repetitions = atoi( argv[++i] ); }
+        else if( !strcmp( argv[i], "-w" ) && i + 1 < argc ) { settings.warmup = atoi( argv[++i] ); }
+        else if( !strcmp( argv[i], "-s" ) && i + 1 < argc ) { settings.targetSize = (size_t)(atof( argv[++i] ) * 1e6); }
+        else if( !strcmp( argv[i], "-j" ) )                 { settings.jsonOutput = 1; }
+        else if( argv[i][0] == '-' ) {
+            fprintf( stderr, "Usage: %s [-r repetitions] [-w warmup] [-s MB] [-j] [file ...]\n", argv[0] );
+            return 2;
+        }
+        else {
+            firstFile = i;
+            break;
+        }
+    }
+    if( settings.repetitions < 1 ) { settings.repetitions = 1; }
+    if( settings.warmup < 0 ) { settings.warmup = 0; }
+
+    if( !settings.jsonOutput ) {
+        printf( "%-14s %-18s %10s %10s %9s %12s %12s %10s\n", "workload", "operation", "MB", "MB/s", "ns/node", "allocations", "alloc MB", "peak KB" );
+    }
+
+    int failures = 0;
+    failures += !forkWorkload( "Fox.gltf", WORKLOAD_FILE, "Fox.gltf", &settings );
+    failures += !forkWorkload( "numbers", WORKLOAD_NUMBERS, NULL, &settings );
+    failures += !forkWorkload( "strings", WORKLOAD_STRINGS, NULL, &settings );
+    failures += !forkWorkload( "nested", WORKLOAD_NESTED, NULL, &settings );
+    failures += !forkWorkload( "wide-objects", WORKLOAD_WIDE, NULL, &settings );
+    failures += !forkWorkload( "ndjson", WORKLOAD_JSON_LINES, NULL, &settings );
+    failures += !forkWorkload( "fox-scaled", WORKLOAD_SCALED, "Fox.gltf", &settings );
+    for( int i = firstFile; i < argc; i++ ) {
+        failures += !forkWorkload( argv[i], WORKLOAD_FILE, argv[i], &settings );
+    }
+
+    return failures ? 1 : 0;
+}
@@ -1,589 +1,5193 @@
 #include "jsonParser.h"
+#include "jsonNumberTable.h"
 #include <stdlib.h>
 #include <stdio.h>
-#include <string.h> // strncmp
-#include <ctype.h> // isspace()
-#include <math.h>  // fabs(), ceil()
-#include <float.h> // DBL_EPSILON
+#include <stddef.h> // max_align_t
+#include <string.h> // memcpy(), memcmp()
+#include <math.h>  // fabs(), ceil(), isnan()
+#include <float.h> // DBL_EPSILON, FLT_EVAL_METHOD
+#include <locale.h> // localeconv()
+#include <time.h>   // clock_gettime(), timespec_get()
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>    // open()
+#include <errno.h>    // EINTR
+#include <unistd.h>   // close()
+#include <sys/mman.h> // mmap(), madvise(), munmap()
+#include <sys/stat.h> // fstat()
+#include <pthread.h>  // pthread_create()
+#include <stdatomic.h>
+#define _HAVE_MMAP_ 1
+#define _HAVE_PTHREAD_ 1
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__PCLMUL__)
+#include <wmmintrin.h> // _mm_clmulepi64_si128()
+#endif
+
+//
+// Projection: the paths of JsonParseOptions::ppPaths as a tree of segments (node 0 is the root value)
+//
+typedef struct
+{
+    const char *segment;     // in the caller's path (JSON Pointer escapes are undone when matching)
+    size_t      length;
+    size_t      index;       // the segment as an array index (SIZE_MAX: it is not one)
+    size_t      firstChild;  // 0: none
+    size_t      nextSibling; // 0: none
+    int         keepAll;     // a path ends here
+} _ProjectionNode;
+
+#define _SELECT_ALL  SIZE_MAX       // the value is kept whole
+#define _SELECT_SKIP (SIZE_MAX - 1) // the value is skipped
+
+//
+// Container being parsed (one per nesting level)
+//
+typedef struct tagJsonFrame
+{
+    ElementType type;      // TYPE_OBJECT or TYPE_ARRAY
+    uint32_t    keyLength; // TYPE_OBJECT: key of the member whose value is being parsed
+    uint32_t    keyHash;
+    char       *key;       //     (`NULL` between members)
+    size_t      stackBase; // first member / element of this container in the scratch stack
+    size_t      lazyEntry; // lazy document: its entry in pLazyDocument->containers
+    size_t      select;    // projection: node of this container (_SELECT_ALL: everything in it is kept)
+    size_t      next;      //     node of the member whose value is being parsed (TYPE_OBJECT), elements so far (TYPE_ARRAY)
+} JsonFrame;
+
+//
+// Parser Context (shared by all parsing functions of one parse)
+//
+typedef struct tagJsonParserContext
+{
+    JsonArena *pArena;        // `NULL`: every node and string is a separate calloc() block
+    uint32_t   flags;         // JSON_PARSE_* (and _JSON_PARSE_INSITU)
+    const char *pInputEnd;    // one past the last byte of the input (never read)
+    JsonParseStats *pStats;   // `NULL`, or the costs are counted there
+    const JsonAllocator *pAllocator; // nodes (without pArena) and the buffers below (`NULL`: malloc/realloc/free)
+
+    // Interned Keys: pKeyPool is the caller's pool, or documentKeys (its bytes in pArena) for JSON_PARSE_INTERN_KEYS
+    JsonKeyPool *pKeyPool;
+    JsonKeyPool  documentKeys;
+
+    // Event API: values are reported to pHandler instead of being stored (strings are borrowed)
+    const JsonSaxHandler *pHandler;
+    void                 *pUserData;
+    JsonLazyDocument     *pLazyDocument; // openJsonLazyDocument(): record where containers open / close
+
+    // Frames: containers being parsed, outermost first
+    JsonFrame *pFrames;
+    size_t     frameCount;
+    size_t     frameCapacity;
+    JsonFrame *pInlineFrames; // `NULL` or the caller's array pFrames starts with (moved to the heap if it is outgrown)
+    size_t     maxDepth;      // 0: JSON_DEFAULT_MAX_DEPTH
+    size_t     tokenScanned;  // _JSON_PARSE_PARTIAL: bytes of the incomplete token at the end of the input already scanned
+
+    // Scratch Stack: elements / members of the containers being parsed (copied out once at ']' or '}')
+    char      *pStack;
+    size_t     stackSize;
+    size_t     stackCapacity;
+
+    // Scratch Buffer: strings with escapes are decoded here before the right-sized copy
+    char      *pScratch;
+    size_t     scratchCapacity;
+
+    // Projection: ppPaths are compiled into pProjection by _parseJson() (`NULL`: everything is kept)
+    const char * const *ppPaths;
+    size_t              pathCount;
+    _ProjectionNode    *pProjection;
+} JsonParserContext;
+
+// Internal Parse Flags
+#define _JSON_PARSE_INSITU  0x80000000u // set by parseJsonInsitu()
+#define _JSON_PARSE_PARTIAL 0x40000000u // set by the push parser until jsonParserFinish(): more input may follow
+#define _JSON_PARSE_VALIDATE 0x20000000u // set by openJsonLazyDocument() and validateJson(): numbers and strings are checked, not converted
+
+// Container of a lazy document (offsets in its data)
+struct tagJsonLazyContainer
+{
+    size_t  open;      // '{' or '['
+    size_t  close;     // the matching '}' or ']'
+    size_t *pItems;    // offsets of its member keys / elements, recorded by the first accessor reading it
+    size_t  itemCount; // SIZE_MAX: not recorded yet
+};
 
 //
 // Parsing Functions (Trim Left is required)
 //
-JsonParsingError parseValue(const char *pCurrChar, const char **pEnd, Element *pElement);
-JsonParsingError parseObject(const char *pCurrChar, const char **pEnd, Element *pElement);
-JsonParsingError parseArray(const char *pCurrChar, const char **pEnd, Element *pElement);
-JsonParsingError parseString(const char *pCurrChar, const char **pEnd, Element *pElement);
-JsonParsingError parseNumber(const char *pCurrChar, const char **pEnd, Element *pElement);
-JsonParsingError parseBoolean(const char *pCurrChar, const char **pEnd, Element *pElement);
-JsonParsingError parseNull(const char *pCurrChar, const char **pEnd, Element *pElement);
+JsonParsingError parseValue(JsonParserContext *pCtx, const char *pCurrChar, const char **pEnd, Element *pElement);
+JsonParsingError parseString(JsonParserContext *pCtx, const char *pCurrChar, const char **pEnd, Element *pElement);
+JsonParsingError parseNumber(JsonParserContext *pCtx, const char *pCurrChar, const char **pEnd, Element *pElement);
+JsonParsingError parseBoolean(JsonParserContext *pCtx, const char *pCurrChar, const char **pEnd, Element *pElement);
+JsonParsingError parseNull(JsonParserContext *pCtx, const char *pCurrChar, const char **pEnd, Element *pElement);
+static JsonParsingError _parseTwoStage(JsonParserContext *pCtx, const char *data, size_t length, const char **ppEnd, Element *pElement);
+static const char *_skipString(const char *pCurrChar, const char *pInputEnd);
+static const char *_skipValue(const char *pCurrChar, const char *pInputEnd, JsonParsingError *pError);
 
-// Calculate Error Location for Debug?
-static void _errorLocation( JsonErrorInfo *pOut, const char *startPos, const char *endPos )
+//
+// Character Classification (JSON-exact, independent of the locale)
+//
+#define _CC_SPACE  0x01 // ' ', '\t', '\n', '\r'
+#define _CC_DIGIT  0x02 // '0' ~ '9'
+#define _CC_HEX    0x04 // '0' ~ '9', 'a' ~ 'f', 'A' ~ 'F'
+
+static const unsigned char _charClass[256] = {
+    ['\t'] = _CC_SPACE, ['\n'] = _CC_SPACE, ['\r'] = _CC_SPACE, [' '] = _CC_SPACE,
+    ['0'] = _CC_DIGIT | _CC_HEX, ['1'] = _CC_DIGIT | _CC_HEX, ['2'] = _CC_DIGIT | _CC_HEX, ['3'] = _CC_DIGIT | _CC_HEX,
+    ['4'] = _CC_DIGIT | _CC_HEX, ['5'] = _CC_DIGIT | _CC_HEX, ['6'] = _CC_DIGIT | _CC_HEX, ['7'] = _CC_DIGIT | _CC_HEX,
+    ['8'] = _CC_DIGIT | _CC_HEX, ['9'] = _CC_DIGIT | _CC_HEX,
+    ['a'] = _CC_HEX, ['b'] = _CC_HEX, ['c'] = _CC_HEX, ['d'] = _CC_HEX, ['e'] = _CC_HEX, ['f'] = _CC_HEX,
+    ['A'] = _CC_HEX, ['B'] = _CC_HEX, ['C'] = _CC_HEX, ['D'] = _CC_HEX, ['E'] = _CC_HEX, ['F'] = _CC_HEX,
+};
+
+static const unsigned char _hexValue[256] = {
+    ['0'] = 0, ['1'] = 1, ['2'] = 2, ['3'] = 3, ['4'] = 4, ['5'] = 5, ['6'] = 6, ['7'] = 7, ['8'] = 8, ['9'] = 9,
+    ['a'] = 10, ['b'] = 11, ['c'] = 12, ['d'] = 13, ['e'] = 14, ['f'] = 15,
+    ['A'] = 10, ['B'] = 11, ['C'] = 12, ['D'] = 13, ['E'] = 14, ['F'] = 15,
+};
+
+#define _isSpace(c)    ( _charClass[(unsigned char)(c)] & _CC_SPACE )
+#define _isDigit(c)    ( _charClass[(unsigned char)(c)] & _CC_DIGIT )
+#define _isHexDigit(c) ( _charClass[(unsigned char)(c)] & _CC_HEX )
+#define _hex2int(c)    ( (int)_hexValue[(unsigned char)(c)] )
+
+// Byte at p, or '\0' at the end of the input
+#define _peekChar(p, pInputEnd) ( (p) < (pInputEnd) ? *(p) : '\0' )
+// Bytes a number or a literal (true, false, null) can continue with
+#define _isLiteralChar(c) ( _isDigit(c) || (c) == '+' || (c) == '-' || (c) == '.' || (((c) | 0x20) >= 'a' && ((c) | 0x20) <= 'z') )
+
+//
+// SIMD Helpers
+// ** Unaligned block loads, only while a whole block is left before the end of the input.
+//
+#if defined(__AVX2__) || defined(__SSE2__)
+#if defined(__AVX2__)
+#define _SCAN_BLOCK 32
+typedef __m256i   _ScanBlock;
+#define _loadBlock(p)            _mm256_loadu_si256( (const __m256i *)(p) )
+#define _set1Block(c)            _mm256_set1_epi8( (char)(c) )
+#define _cmpeqBlock(a, b)        _mm256_cmpeq_epi8( a, b )
+#define _orBlock(a, b)           _mm256_or_si256( a, b )
+#define _minBlock(a, b)          _mm256_min_epu8( a, b )
+#define _maskBlock(a)            (uint32_t)_mm256_movemask_epi8( a )
+#define _FULL_MASK               0xFFFFFFFFu
+#else
+#define _SCAN_BLOCK 16
+typedef __m128i   _ScanBlock;
+#define _loadBlock(p)            _mm_loadu_si128( (const __m128i *)(p) )
+#define _set1Block(c)            _mm_set1_epi8( (char)(c) )
+#define _cmpeqBlock(a, b)        _mm_cmpeq_epi8( a, b )
+#define _orBlock(a, b)           _mm_or_si128( a, b )
+#define _minBlock(a, b)          _mm_min_epu8( a, b )
+#define _maskBlock(a)            (uint32_t)_mm_movemask_epi8( a )
+#define _FULL_MASK               0xFFFFu
+#endif
+#endif
+
+//
+// Whitespace Skipper
+// ** Most tokens follow no or a single whitespace; longer runs (indentation) are skipped a block at a time.
+//
+#if defined(__AVX2__) || defined(__SSE2__)
+static inline uint32_t _nonSpaceMask(_ScanBlock block)
+{
+    _ScanBlock space = _orBlock( _orBlock( _cmpeqBlock( block, _set1Block(' ') ), _cmpeqBlock( block, _set1Block('\n') ) ),
+                                 _orBlock( _cmpeqBlock( block, _set1Block('\t') ), _cmpeqBlock( block, _set1Block('\r') ) ) );
+    return ~_maskBlock( space ) & _FULL_MASK;
+}
+
+static const char *_skipSpaceRun(const char *pCurrChar, const char *pInputEnd)
+{
+    while( pInputEnd - pCurrChar >= _SCAN_BLOCK ) {
+        uint32_t mask = _nonSpaceMask( _loadBlock(pCurrChar) );
+        if( mask ) { return pCurrChar + __builtin_ctz(mask); }
+        pCurrChar += _SCAN_BLOCK;
+    }
+    while( pCurrChar < pInputEnd && _isSpace(*pCurrChar) ) { pCurrChar++; }
+    return pCurrChar;
+}
+#else
+static const char *_skipSpaceRun(const char *pCurrChar, const char *pInputEnd)
 {
-    int ln  = 1;
-    int col = 1;
+    while( pCurrChar < pInputEnd && _isSpace(*pCurrChar) ) { pCurrChar++; }
+    return pCurrChar;
+}
+#endif
+
+static inline const char *_skipSpace(const char *pCurrChar, const char *pInputEnd)
+{
+    if( pCurrChar >= pInputEnd || !_isSpace(pCurrChar[0]) ) { return pCurrChar; }
+    if( pCurrChar + 1 >= pInputEnd || !_isSpace(pCurrChar[1]) ) { return pCurrChar + 1; }
+    return _skipSpaceRun( pCurrChar + 2, pInputEnd );
+}
 
-    for( const char *currPos = startPos; currPos <= endPos; currPos++ ) {
+// Count lines / columns of [startPos, endPos)
+static void _countLocation( size_t *pLine, size_t *pColumn, const char *startPos, const char *endPos )
+{
+    for( const char *currPos = startPos; currPos < endPos; currPos++ ) {
         if( *currPos == '\n' ) {
-            ++ln;    // add line number
-            col = 1; // reset column number
+            ++(*pLine);   // add line number
+            *pColumn = 1; // reset column number
         }
         else if( (((unsigned char)*currPos) & 0xC0) != 0x80 ) {
-            ++col;
+            ++(*pColumn);
         }
         // else // 10xxxxxx xxxxxxxx -> ignore
     }
+}
+
+// Location of endPos, counting on from (ln, col) at startPos
+// ** endPos itself is counted too (as '\0' when it is the end of the input)
+static void _locate( JsonErrorInfo *pOut, size_t ln, size_t col, const char *startPos, const char *endPos, const char *inputEnd )
+{
+    _countLocation( &ln, &col, startPos, endPos );
+    if( endPos < inputEnd ) { _countLocation( &ln, &col, endPos, endPos + 1 ); }
+    else { ++col; }
 
     pOut->line = ln;
     pOut->column = col;
-    pOut->position = (int)(endPos - startPos);
+    pOut->position = (size_t)(endPos - startPos);
+}
+
+// Calculate Error Location for Debug?
+static void _errorLocation( JsonErrorInfo *pOut, const char *startPos, const char *endPos, const char *inputEnd )
+{
+    if( !endPos ) { // nothing parsed
+        pOut->line = 1;
+        pOut->column = 1;
+        pOut->position = 0;
+        return;
+    }
+    _locate( pOut, 1, 1, startPos, endPos, inputEnd );
 }
 
 //
-// Main Function of Json Parser
+// Allocator (`NULL`: the C library)
 //
-JsonParsingError parseJsonString(Element *pOutElement, const char *jsonStr, JsonErrorInfo* pOutErrorInfo)
+static inline void *_mallocWith(const JsonAllocator *pAllocator, size_t size)
 {
-    JsonParsingError ret = JPE_NO_ERROR;
-    const char *pCurrChar = jsonStr;
-    const char *pEnd = (const char *)0;
-    
-    if( pOutElement && pCurrChar && *pCurrChar )
-    {
-        ret = parseValue( pCurrChar, &pEnd, pOutElement );
-        if( ret == JPE_NO_ERROR ) {
-            pCurrChar = pEnd;
-            while( isspace( *pCurrChar ) ) { pCurrChar++; }
-            if( *pCurrChar ) { 
-                pEnd = pCurrChar;
-                ret = JPE_SYNTAX_ERROR;
-            }
+    return pAllocator ? pAllocator->pfnMalloc( pAllocator->pUserData, size ) : malloc( size );
+}
+
+static inline void *_callocWith(const JsonAllocator *pAllocator, size_t size)
+{
+    if( !pAllocator ) { return calloc( 1, size ); }
+    void *ptr = pAllocator->pfnMalloc( pAllocator->pUserData, size );
+    if( ptr ) { memset( ptr, 0, size ); }
+    return ptr;
+}
+
+static inline void *_reallocWith(const JsonAllocator *pAllocator, void *ptr, size_t size)
+{
+    return pAllocator ? pAllocator->pfnRealloc( pAllocator->pUserData, ptr, size ) : realloc( ptr, size );
+}
+
+static inline void _freeWith(const JsonAllocator *pAllocator, void *ptr)
+{
+    if( !ptr ) { return; } // (as free() does)
+    if( pAllocator ) { pAllocator->pfnFree( pAllocator->pUserData, ptr ); }
+    else { free( ptr ); }
+}
+
+//
+// Arena (Bump Allocator)
+//
+struct tagJsonArenaChunk
+{
+    struct tagJsonArenaChunk *next;
+    size_t                    capacity; // bytes of data[]
+    size_t                    used;     // bytes of data[] handed out
+    max_align_t               data[];
+};
+
+#define _ARENA_ALIGN(size) ( ((size) + (sizeof(max_align_t) - 1)) & ~(sizeof(max_align_t) - 1) )
+
+void initJsonArena(JsonArena *pArena, size_t chunkSize)
+{
+    initJsonArenaEx( pArena, chunkSize, (const JsonAllocator *)0 );
+}
+
+void initJsonArenaEx(JsonArena *pArena, size_t chunkSize, const JsonAllocator *pAllocator)
+{
+    pArena->chunks     = (JsonArenaChunk *)0;
+    pArena->freeChunks = (JsonArenaChunk *)0;
+    pArena->chunkSize  = chunkSize ? chunkSize : JSON_ARENA_DEFAULT_CHUNK_SIZE;
+    pArena->pAllocator = pAllocator;
+}
+
+static JsonArenaChunk *_arenaNewChunk(JsonArena *pArena, size_t size)
+{
+    // Reuse a chunk released by clearJsonArena() if it is big enough
+    JsonArenaChunk **ppPrev = &(pArena->freeChunks);
+    while( *ppPrev ) {
+        JsonArenaChunk *pChunk = *ppPrev;
+        if( pChunk->capacity >= size ) {
+            *ppPrev = pChunk->next;
+            pChunk->used = 0;
+            return pChunk;
         }
-        // else {
-        //     if( *pEnd == '\0' && ret != JPE_SYNTAX_ERROR_END ) {
-        //         ret = JPE_SYNTAX_ERROR_END;
-        //     }
-        // }
+        ppPrev = &(pChunk->next);
     }
 
-    if( pOutErrorInfo ) {
-        pOutErrorInfo->error = ret;
-        _errorLocation( pOutErrorInfo, jsonStr, pEnd );
+    size_t capacity = ( size > pArena->chunkSize ) ? size : pArena->chunkSize;
+    JsonArenaChunk *pChunk = (JsonArenaChunk *)_mallocWith( pArena->pAllocator, sizeof(JsonArenaChunk) + capacity );
+    if( pChunk ) {
+        pChunk->capacity = capacity;
+        pChunk->used     = 0;
     }
-    
-    return ret;
+    return pChunk;
 }
 
-static int hex2int(char hexCode)
+static void *_arenaAlloc(JsonArena *pArena, size_t size)
 {
-    if( 96 < hexCode && hexCode < 103 ) { return hexCode - 'a' + 10; }
-    else if( 64 < hexCode && hexCode < 71 ) { return hexCode - 'A' + 10; }
-    else if( 47 < hexCode && hexCode < 58 ) { return hexCode - '0'; }
+    JsonArenaChunk *pChunk = pArena->chunks;
+    size = _ARENA_ALIGN(size);
 
-    return 0;
+    if( pChunk && pChunk->capacity - pChunk->used >= size ) {
+        void *ptr = (char *)pChunk->data + pChunk->used;
+        pChunk->used += size;
+        return ptr;
+    }
+
+    JsonArenaChunk *pNewChunk = _arenaNewChunk( pArena, size );
+    if( !pNewChunk ) { return (void *)0; }
+
+    if( pChunk && size > pArena->chunkSize ) {
+        // Oversized block: keep bump allocating from the current chunk
+        pNewChunk->next = pChunk->next;
+        pChunk->next    = pNewChunk;
+    }
+    else {
+        pNewChunk->next = pChunk;
+        pArena->chunks  = pNewChunk;
+    }
+
+    pNewChunk->used = size;
+    return pNewChunk->data;
 }
 
-JsonParsingError _getString(char **pOutString, const char *pCurrChar, const char ** ppEnd)
+void clearJsonArena(JsonArena *pArena)
 {
-    const char *pTmp = pCurrChar + 1;
-    int charCount = 0;
-    char *stringValue = (char *)0;
+    JsonArenaChunk *pChunk = pArena->chunks;
+    while( pChunk ) {
+        JsonArenaChunk *pNext = pChunk->next;
+        pChunk->next = pArena->freeChunks;
+        pArena->freeChunks = pChunk;
+        pChunk = pNext;
+    }
+    pArena->chunks = (JsonArenaChunk *)0;
+}
 
-    // Not allow single quote string
-    if( *pCurrChar != '"' ) { 
-        *ppEnd = pCurrChar;
-        return JPE_SYNTAX_ERROR;
+void releaseJsonArena(JsonArena *pArena)
+{
+    clearJsonArena( pArena );
+
+    JsonArenaChunk *pChunk = pArena->freeChunks;
+    while( pChunk ) {
+        JsonArenaChunk *pNext = pChunk->next;
+        _freeWith( pArena->pAllocator, pChunk );
+        pChunk = pNext;
     }
+    pArena->freeChunks = (JsonArenaChunk *)0;
+}
 
-    // Count Total Characters (utf-8)
-    while( *pTmp )
-    {
-        if( *pTmp == '\\') {
-            switch( *++pTmp )
-            {
-                case '"':
-                case '\\':
-                case '/':
-                case 'b':
-                case 'f':
-                case 'n':
-                case 'r':
-                case 't':
-                    break;
-                case 'u': // Convert UTF-16 to UTF-8
-                    if( !isxdigit(pTmp[1]) || !isxdigit(pTmp[2]) || !isxdigit(pTmp[3]) || !isxdigit(pTmp[4]) ) {
-                        *ppEnd = pTmp;
-                        return JPE_SYNTAX_ERROR_UNICODE_ESCAPE;
-                    }
-                    pTmp += 4;
-                    // Calculate Bytes of UTF-8 Conversion
-                    if( pTmp[1] != '0' || pTmp[2] > '7' ) { charCount += 2; }      // 0x0800 ~ 0xFFFF
-                    else if( pTmp[2] > '0' || pTmp[3] > '7' ) { charCount += 1; }  // 0x0080 ~ 0x07FF
-                    // else // 0x0000 ~ 0x007F
-                    break;
-                case '\0':
-                    *ppEnd = pTmp;
-                    return JPE_SYNTAX_ERROR_END;
-                default:
-                    *ppEnd = pTmp;
-                    return JPE_SYNTAX_ERROR_STRING_ESCAPE;
-            }
+// Move the chunks of pFrom into pArena (behind its current chunk, which goes on bump allocating); same allocator
+static void _mergeJsonArena(JsonArena *pArena, JsonArena *pFrom)
+{
+    JsonArenaChunk *pLast = pFrom->chunks;
+    if( pLast ) {
+        while( pLast->next ) { pLast = pLast->next; }
+        if( pArena->chunks ) {
+            pLast->next = pArena->chunks->next;
+            pArena->chunks->next = pFrom->chunks;
         }
-        else if( *pTmp == '"' ) { // End of String
-            break;
-        } 
-        pTmp++;
-        charCount++;
+        else {
+            pArena->chunks = pFrom->chunks;
+        }
+        pFrom->chunks = (JsonArenaChunk *)0;
     }
-    if( *pTmp != '"' ) { return JPE_SYNTAX_ERROR_END; }
+    releaseJsonArena( pFrom );
+}
 
-    stringValue = (char *)calloc(charCount + 1, sizeof(char));
-    if( !stringValue ) {
-        *ppEnd = pTmp + 1;
-        return JPE_OUT_OF_MEMORY;
+//
+// Parse Statistics
+// ** Counters are added where the values are made (by both engines), only if pCtx->pStats is set;
+//    JSON_ENABLE_PARSE_STATS 0 leaves them out.
+//
+static uint64_t _nanoseconds(void)
+{
+    struct timespec ts;
+#if _HAVE_MMAP_
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+#else
+    timespec_get( &ts, TIME_UTC );
+#endif
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static inline void _countContainer(JsonParserContext *pCtx, ElementType type)
+{
+#if JSON_ENABLE_PARSE_STATS
+    JsonParseStats *pStats = pCtx->pStats;
+    if( pStats ) {
+        if( type == TYPE_OBJECT ) { pStats->objects++; }
+        else { pStats->arrays++; }
+        if( pCtx->frameCount > pStats->maxDepth ) { pStats->maxDepth = pCtx->frameCount; }
     }
+#else
+    (void)pCtx;
+    (void)type;
+#endif
+}
 
-    // Copy String
-    const char *pSrc = pCurrChar + 1;
-    char *pDst = stringValue;
-    while( pSrc < pTmp ) {
-        if( *pSrc == '\\' ) {
-            switch( *++pSrc ) {
-                case '"' : *pDst++ = '"'; break;
-                case '\\': *pDst++ = '\\'; break; 
-                case '/' : *pDst++ = '/'; break;
-                case 'b' : *pDst++ = '\b'; break;
-                case 'f' : *pDst++ = '\f'; break;
-                case 'n' : *pDst++ = '\n'; break;
-                case 'r' : *pDst++ = '\r'; break;
-                case 't' : *pDst++ = '\t'; break;
-                case 'u': // Convert UTF-16 to UTF-8
-                {
-                    int unicode = hex2int(pSrc[1]) << 12
-                                | hex2int(pSrc[2]) << 8
-                                | hex2int(pSrc[3]) << 4
-                                | hex2int(pSrc[4]);
-                    if( unicode < 0x80 ) { // U+0000 ~ U+007F -> | 0xxxxxxx |
-                        *pDst++ = (char)unicode;
-                    }
-                    else if( unicode < 0x800 ) { // U+0080 ~ U+07FF -> | 110xxxxx | 10xxxxxx |
-                        *pDst++ = (char)(0xC0 + (unicode >> 6));
-                        *pDst++ = (char)(0x80 + (unicode & 0x3F));
-                    }
-                    else { // U+0800 ~ U+FFFF -> | 1110xxxx | 10xxxxxx | 10xxxxxx |
-                        *pDst++ = (char)(0xe0 + (unicode >> 12));          // 0xe0 + unicode / 4096
-                        *pDst++ = (char)(0x80 + ((unicode >> 6) & 0x3F));  // 0x80 + unicode / 64 % 64
-                        *pDst++ = (char)(0x80 + (unicode & 0x3F));         // 0x80 + unicode % 64
-                    }
-                    pSrc += 4;
-                }
+static inline void _countScalar(JsonParserContext *pCtx, const Element *pValue)
+{
+#if JSON_ENABLE_PARSE_STATS
+    JsonParseStats *pStats = pCtx->pStats;
+    if( pStats ) {
+        switch( pValue->type ) {
+            case TYPE_STRING:
+                pStats->strings++;
+                pStats->stringBytes += pValue->length;
                 break;
-            }
-            pSrc++;
+            case TYPE_INT_NUMBER:
+            case TYPE_DBL_NUMBER:
+                pStats->numbers++;
+                break;
+            default:
+                pStats->literals++;
+                break;
+        }
+    }
+#else
+    (void)pCtx;
+    (void)pValue;
+#endif
+}
+
+static inline void _countKey(JsonParserContext *pCtx, size_t keyLength)
+{
+#if JSON_ENABLE_PARSE_STATS
+    if( pCtx->pStats ) {
+        pCtx->pStats->keys++;
+        pCtx->pStats->stringBytes += keyLength;
+    }
+#else
+    (void)pCtx;
+    (void)keyLength;
+#endif
+}
+
+static inline void _countAllocation(JsonParserContext *pCtx, size_t size)
+{
+#if JSON_ENABLE_PARSE_STATS
+    if( pCtx->pStats ) {
+        pCtx->pStats->allocations++;
+        pCtx->pStats->allocatedBytes += size;
+    }
+#else
+    (void)pCtx;
+    (void)size;
+#endif
+}
+
+static void _countWorkingBytes(JsonParserContext *pCtx)
+{
+    size_t workingBytes = pCtx->frameCapacity * sizeof(JsonFrame) + pCtx->stackCapacity + pCtx->scratchCapacity;
+    if( pCtx->pStats && workingBytes > pCtx->pStats->workingBytes ) { pCtx->pStats->workingBytes = workingBytes; }
+}
+
+// Every function taking JsonParseOptions starts from zero
+static void _resetParseStats(const JsonParseOptions *pOptions)
+{
+    if( pOptions->pStats ) { memset( pOptions->pStats, 0, sizeof(JsonParseStats) ); }
+}
+
+// The counts of values made by an attempt that is given up (its costs stay)
+static void _rollbackParseStats(JsonParseStats *pStats, const JsonParseStats *pSaved)
+{
+    JsonParseStats stats = *pSaved;
+    stats.allocations = pStats->allocations;
+    stats.allocatedBytes = pStats->allocatedBytes;
+    stats.workingBytes = pStats->workingBytes;
+    stats.indexNanoseconds = pStats->indexNanoseconds;
+    stats.parseNanoseconds = pStats->parseNanoseconds;
+    stats.totalNanoseconds = pStats->totalNanoseconds;
+    *pStats = stats;
+}
+
+// Stats of another thread
+static void _mergeParseStats(JsonParseStats *pStats, const JsonParseStats *pFrom)
+{
+    pStats->bytes += pFrom->bytes;
+    pStats->objects += pFrom->objects;
+    pStats->arrays += pFrom->arrays;
+    pStats->strings += pFrom->strings;
+    pStats->numbers += pFrom->numbers;
+    pStats->literals += pFrom->literals;
+    pStats->keys += pFrom->keys;
+    if( pFrom->maxDepth > pStats->maxDepth ) { pStats->maxDepth = pFrom->maxDepth; }
+    pStats->stringBytes += pFrom->stringBytes;
+    pStats->allocations += pFrom->allocations;
+    pStats->allocatedBytes += pFrom->allocatedBytes;
+    pStats->workingBytes += pFrom->workingBytes; // (at the same time)
+    pStats->indexNanoseconds += pFrom->indexNanoseconds;
+    pStats->parseNanoseconds += pFrom->parseNanoseconds;
+}
+
+//
+// Memory of Nodes and Strings (Arena or calloc/free)
+//
+static void *_allocMemory(JsonParserContext *pCtx, size_t size)
+{
+    _countAllocation( pCtx, size );
+    if( pCtx->pArena ) { return _arenaAlloc( pCtx->pArena, size ); }
+    return _callocWith( pCtx->pAllocator, size );
+}
+
+static void _freeMemory(JsonParserContext *pCtx, void *ptr)
+{
+    if( !pCtx->pArena ) { _freeWith( pCtx->pAllocator, ptr ); }
+}
+
+// Release partially parsed values on error (arena memory is released with the arena)
+static void _releaseElement(JsonParserContext *pCtx, Element *pElement)
+{
+    if( !pCtx->pArena ) { resetElementEx( pElement, pCtx->pAllocator ); }
+}
+
+//
+// Scratch Stack
+//
+#define _STACK_INITIAL_CAPACITY (8 * 1024)
+
+// Push an Element (array) or an ObjectNode (object)
+static int _pushStack(JsonParserContext *pCtx, const void *pItem, size_t itemSize)
+{
+    if( pCtx->stackCapacity - pCtx->stackSize < itemSize ) {
+        size_t newCapacity = pCtx->stackCapacity ? pCtx->stackCapacity * 2 : _STACK_INITIAL_CAPACITY;
+        char *pNewStack = (char *)_reallocWith( pCtx->pAllocator, pCtx->pStack, newCapacity );
+        if( !pNewStack ) { return 0; }
+        pCtx->pStack = pNewStack;
+        pCtx->stackCapacity = newCapacity;
+    }
+    memcpy( pCtx->pStack + pCtx->stackSize, pItem, itemSize );
+    pCtx->stackSize += itemSize;
+    return 1;
+}
+
+// Pop items above `base` (release them on error)
+static void _popStack(JsonParserContext *pCtx, size_t base, size_t itemSize)
+{
+    while( pCtx->stackSize > base ) {
+        pCtx->stackSize -= itemSize;
+        if( itemSize == sizeof(ObjectNode) ) {
+            ObjectNode *pMember = (ObjectNode *)(pCtx->pStack + pCtx->stackSize);
+            _freeMemory( pCtx, pMember->key );
+            _releaseElement( pCtx, &(pMember->element) );
         }
         else {
-            *pDst++ = *pSrc++;
+            _releaseElement( pCtx, (Element *)(pCtx->pStack + pCtx->stackSize) );
         }
     }
+}
 
-    *ppEnd = pTmp + 1;
-    *pOutString = stringValue;
-    return JPE_NO_ERROR;
+//
+// Object Key Index
+// ** Objects with JSON_OBJECT_INDEX_THRESHOLD or more members carry an open addressing table
+//    (`member index + 1`, 0 is empty) right after their members.
+//
+static uint32_t _hashKey(const char *key, size_t length)
+{
+    uint64_t hash = 0x9E3779B97F4A7C15ull ^ length;
+    uint64_t word;
+
+    while( length >= 8 ) {
+        memcpy( &word, key, 8 );
+        hash = (hash ^ word) * 0xBF58476D1CE4E5B9ull;
+        key += 8;
+        length -= 8;
+    }
+    if( length ) {
+        word = 0;
+        memcpy( &word, key, length );
+        hash = (hash ^ word) * 0xBF58476D1CE4E5B9ull;
+    }
+
+    hash ^= hash >> 29;
+    hash *= 0x94D049BB133111EBull;
+    return (uint32_t)(hash ^ (hash >> 32));
 }
 
-JsonParsingError parseValue(const char *pCurrChar, const char **ppEnd, Element *pElement)
+static size_t _objectIndexCapacity(size_t count)
 {
-    // Trim Left
-    while( isspace(*pCurrChar) ) { pCurrChar++; }
+    size_t capacity = 1;
+    if( count < JSON_OBJECT_INDEX_THRESHOLD ) { return 0; }
+    while( capacity < count * 2 ) { capacity <<= 1; }
+    return capacity;
+}
 
-    switch( *pCurrChar ) 
-    {
-        // Try parse as Object
-        case '{': return parseObject( pCurrChar, ppEnd, pElement );
-        // Try parse as Array
-        case '[': return parseArray( pCurrChar, ppEnd, pElement );
-        // Try parse as String
-        case '"': return parseString( pCurrChar, ppEnd, pElement );
-        // Try parse as Number (Octal, Decimal, Hex Integer and Floating Point)
-        case '+':
-        case '-': 
-        case '0': 
-        case '1':
-        case '2':
-        case '3':
-        case '4':
-        case '5':
-        case '6':
-        case '7':
-        case '8':
-        case '9': 
-    #if _ALLOW_LOOSEN_NUMBER_FORMAT_ // allow floating point, skipping leading zero (ex> .12)
-        case '.':
+static size_t _objectIndexBytes(size_t count)
+{
+    return _objectIndexCapacity(count) * sizeof(uint32_t);
+}
+
+static void _buildObjectIndex(Element *pElement)
+{
+    size_t capacity = _objectIndexCapacity( pElement->length );
+    if( !capacity ) { return; }
+
+    uint32_t *pSlots = (uint32_t *)(pElement->objectValue + pElement->length);
+    memset( pSlots, 0, capacity * sizeof(uint32_t) );
+
+    for( uint32_t i = 0; i < pElement->length; i++ ) {
+        size_t slot = pElement->objectValue[i].keyHash & (capacity - 1);
+        while( pSlots[slot] ) { slot = (slot + 1) & (capacity - 1); }
+        pSlots[slot] = i + 1;
+    }
+}
+
+//
+// Key Pool
+//
+struct tagJsonKeyPoolEntry
+{
+    const char *key;    // `NULL`: empty slot
+    uint32_t    length;
+    uint32_t    hash;
+};
+
+void initJsonKeyPool(JsonKeyPool *pPool)
+{
+    initJsonKeyPoolEx( pPool, (const JsonAllocator *)0 );
+}
+
+void initJsonKeyPoolEx(JsonKeyPool *pPool, const JsonAllocator *pAllocator)
+{
+    pPool->entries = (JsonKeyPoolEntry *)0;
+    pPool->capacity = 0;
+    pPool->count = 0;
+    initJsonArenaEx( &(pPool->arena), JSON_KEY_POOL_CHUNK_SIZE, pAllocator ); // (its allocator is the pool's)
+}
+
+void releaseJsonKeyPool(JsonKeyPool *pPool)
+{
+    _freeWith( pPool->arena.pAllocator, pPool->entries );
+    pPool->entries = (JsonKeyPoolEntry *)0;
+    pPool->capacity = 0;
+    pPool->count = 0;
+    releaseJsonArena( &(pPool->arena) );
+}
+
+static int _growKeyPool(JsonKeyPool *pPool)
+{
+    size_t newCapacity = pPool->capacity ? pPool->capacity * 2 : 64;
+    JsonKeyPoolEntry *pNewEntries = (JsonKeyPoolEntry *)_callocWith( pPool->arena.pAllocator, newCapacity * sizeof(JsonKeyPoolEntry) );
+    if( !pNewEntries ) { return 0; }
+
+    for( size_t i = 0; i < pPool->capacity; i++ ) {
+        if( pPool->entries[i].key ) {
+            size_t slot = pPool->entries[i].hash & (newCapacity - 1);
+            while( pNewEntries[slot].key ) { slot = (slot + 1) & (newCapacity - 1); }
+            pNewEntries[slot] = pPool->entries[i];
+        }
+    }
+    _freeWith( pPool->arena.pAllocator, pPool->entries );
+    pPool->entries = pNewEntries;
+    pPool->capacity = newCapacity;
+    return 1;
+}
+
+// Pooled copy of key (new copies go to pStorage), or `NULL` if out of memory
+static char *_internKey(JsonKeyPool *pPool, JsonArena *pStorage, const char *key, size_t length, uint32_t hash)
+{
+    // Keep the load factor under 1/2
+    if( (pPool->count + 1) * 2 > pPool->capacity && !_growKeyPool( pPool ) ) { return (char *)0; }
+
+    size_t slot = hash & (pPool->capacity - 1);
+    for( ; pPool->entries[slot].key; slot = (slot + 1) & (pPool->capacity - 1) ) {
+        JsonKeyPoolEntry *pEntry = &(pPool->entries[slot]);
+        if( pEntry->hash == hash && pEntry->length == length && !memcmp( pEntry->key, key, length ) ) {
+            return (char *)pEntry->key;
+        }
+    }
+
+    char *pCopy = (char *)_arenaAlloc( pStorage, length + 1 );
+    if( !pCopy ) { return (char *)0; }
+    memcpy( pCopy, key, length );
+    pCopy[length] = '\0';
+
+    pPool->entries[slot].key = pCopy;
+    pPool->entries[slot].length = (uint32_t)length;
+    pPool->entries[slot].hash = hash;
+    pPool->count++;
+    return pCopy;
+}
+
+const char *internJsonKey(JsonKeyPool *pPool, const char *key, size_t keyLength)
+{
+    if( keyLength > UINT32_MAX ) { return (const char *)0; }
+    return _internKey( pPool, &(pPool->arena), key, keyLength, _hashKey( key, keyLength ) );
+}
+
+//
+// Projection (JsonParseOptions::ppPaths)
+// ** Each frame holds its node: members / elements matching a child are parsed (whole if a path ends there),
+//    the others are skipped with _skipValue(). Keys are matched before they are decoded (see _STATE_OBJECT_KEY).
+//
+// "" or '/' segments, '~' only in "~0" and "~1"
+static int _isValidPointer(const char *path)
+{
+    if( !path || (*path && *path != '/') ) { return 0; }
+    for( ; *path; path++ ) {
+        if( *path == '~' && path[1] != '0' && path[1] != '1' ) { return 0; }
+    }
+    return 1;
+}
+
+// Segment (with JSON Pointer escapes) == key (decoded)
+static int _isSegmentOf(const _ProjectionNode *pNode, const char *key, size_t keyLength)
+{
+    const char *pSegment = pNode->segment;
+    const char *pSegmentEnd = pSegment + pNode->length;
+    for( ; pSegment < pSegmentEnd; pSegment++, key++, keyLength-- ) {
+        char c = *pSegment;
+        if( c == '~' ) { c = (*++pSegment == '0') ? '~' : '/'; }
+        if( !keyLength || *key != c ) { return 0; }
+    }
+    return keyLength == 0;
+}
+
+// Node of the member `key` in the container at `node` (_SELECT_ALL, or _SELECT_SKIP if no path goes there)
+static size_t _selectMember(const JsonParserContext *pCtx, size_t node, const char *key, size_t keyLength)
+{
+    const _ProjectionNode *pNodes = pCtx->pProjection;
+    for( size_t child = pNodes[node].firstChild; child; child = pNodes[child].nextSibling ) {
+        if( _isSegmentOf( &(pNodes[child]), key, keyLength ) ) { return pNodes[child].keepAll ? _SELECT_ALL : child; }
+    }
+    return _SELECT_SKIP;
+}
+
+// Node of the value starting now (the root value, or in the current container)
+static size_t _selectValue(JsonParserContext *pCtx)
+{
+    if( pCtx->frameCount == 0 ) { return 0; }
+
+    JsonFrame *pFrame = &(pCtx->pFrames[pCtx->frameCount - 1]);
+    if( pFrame->select == _SELECT_ALL ) { return _SELECT_ALL; }
+    if( pFrame->type == TYPE_OBJECT ) { return pFrame->next; } // (matched with its key)
+
+    const _ProjectionNode *pNodes = pCtx->pProjection;
+    size_t index = pFrame->next++;
+    for( size_t child = pNodes[pFrame->select].firstChild; child; child = pNodes[child].nextSibling ) {
+        if( pNodes[child].index == index ) { return pNodes[child].keepAll ? _SELECT_ALL : child; }
+    }
+    return _SELECT_SKIP;
+}
+
+// Tree of the paths in pCtx->pProjection (left `NULL` if a path keeps the whole document); returns 0 if out of memory
+static int _compileProjection(JsonParserContext *pCtx)
+{
+    size_t capacity = 1;
+    for( size_t i = 0; i < pCtx->pathCount; i++ ) {
+        for( const char *p = pCtx->ppPaths[i]; *p; p++ ) { capacity += (*p == '/'); }
+    }
+    _ProjectionNode *pNodes = (_ProjectionNode *)_callocWith( pCtx->pAllocator, capacity * sizeof(_ProjectionNode) );
+    if( !pNodes ) { return 0; }
+
+    size_t count = 1;
+    for( size_t i = 0; i < pCtx->pathCount; i++ ) {
+        size_t node = 0;
+        for( const char *pSegment = pCtx->ppPaths[i]; *pSegment; ) {
+            pSegment++; // '/'
+            size_t length = strcspn( pSegment, "/" );
+            size_t child = pNodes[node].firstChild;
+            while( child && (pNodes[child].length != length || memcmp( pNodes[child].segment, pSegment, length )) ) {
+                child = pNodes[child].nextSibling;
+            }
+            if( !child ) {
+                child = count++;
+                pNodes[child].segment = pSegment;
+                pNodes[child].length = length;
+                pNodes[child].index = SIZE_MAX;
+                if( length && (pSegment[0] != '0' || length == 1) && strspn( pSegment, "0123456789" ) >= length ) {
+                    size_t index = 0;
+                    for( size_t j = 0; j < length && index != SIZE_MAX; j++ ) {
+                        int digit = pSegment[j] - '0';
+                        index = (index > (SIZE_MAX - 1 - digit) / 10) ? SIZE_MAX : index * 10 + digit;
+                    }
+                    pNodes[child].index = index;
+                }
+                pNodes[child].nextSibling = pNodes[node].firstChild;
+                pNodes[node].firstChild = child;
+            }
+            node = child;
+            pSegment += length;
+        }
+        pNodes[node].keepAll = 1;
+    }
+
+    if( pNodes[0].keepAll ) {
+        _freeWith( pCtx->pAllocator, pNodes );
+        pNodes = (_ProjectionNode *)0;
+    }
+    pCtx->pProjection = pNodes;
+    pCtx->ppPaths = (const char * const *)0; // (compiled)
+    return 1;
+}
+
+// Errors found before parsing (arguments, files)
+static JsonParsingError _errorWithoutLocation(JsonErrorInfo* pOutErrorInfo, JsonParsingError error)
+{
+    if( pOutErrorInfo ) {
+        pOutErrorInfo->error = error;
+        pOutErrorInfo->line = 1;
+        pOutErrorInfo->column = 1;
+        pOutErrorInfo->position = 0;
+    }
+    return error;
+}
+
+// Free the working memory of a parse (not its result)
+static void _releaseContext(JsonParserContext *pCtx)
+{
+    _countWorkingBytes( pCtx );
+    if( pCtx->pFrames != pCtx->pInlineFrames ) { _freeWith( pCtx->pAllocator, pCtx->pFrames ); }
+    _freeWith( pCtx->pAllocator, pCtx->pStack );
+    _freeWith( pCtx->pAllocator, pCtx->pScratch );
+    _freeWith( pCtx->pAllocator, pCtx->documentKeys.entries ); // key bytes stay in the arena
+    _freeWith( pCtx->pAllocator, pCtx->pProjection );
+}
+
+static JsonParsingError _parseJson(JsonParserContext *pCtx, Element *pOutElement, const char *jsonStr, size_t length, JsonErrorInfo* pOutErrorInfo)
+{
+    JsonParsingError ret = JPE_NO_ERROR;
+    const char *pCurrChar = jsonStr;
+    const char *pEnd = (const char *)0;
+
+    if( pCtx->ppPaths && !pCtx->pProjection && !_compileProjection( pCtx ) ) {
+        _releaseContext( pCtx );
+        return _errorWithoutLocation( pOutErrorInfo, JPE_OUT_OF_MEMORY );
+    }
+
+    JsonParseStats *pStats = pCtx->pStats;
+    JsonParseStats savedStats = { 0, };
+    uint64_t start = 0, indexTime = 0;
+    if( pStats ) {
+        start = _nanoseconds();
+        indexTime = pStats->indexNanoseconds;
+        savedStats = *pStats;
+    }
+
+    pCtx->pInputEnd = jsonStr + length;
+    if( pCtx->maxDepth == 0 ) { pCtx->maxDepth = JSON_DEFAULT_MAX_DEPTH; }
+    if( pOutElement && pCurrChar && length )
+    {
+        // Two-Stage Parsing reports nothing but success: otherwise the engine parses again (and reports the error)
+        int twoStage = (pCtx->flags & JSON_PARSE_TWO_STAGE) && !pCtx->pHandler && !(pCtx->flags & _JSON_PARSE_INSITU) && !pCtx->pProjection;
+        if( !twoStage || _parseTwoStage( pCtx, pCurrChar, length, &pEnd, pOutElement ) != JPE_NO_ERROR ) {
+            if( twoStage && pStats ) { _rollbackParseStats( pStats, &savedStats ); }
+            ret = parseValue( pCtx, pCurrChar, &pEnd, pOutElement );
+        }
+        if( ret == JPE_NO_ERROR ) {
+            pCurrChar = pEnd;
+            pCurrChar = _skipSpace( pCurrChar, pCtx->pInputEnd );
+            if( pCurrChar != pCtx->pInputEnd ) { 
+                pEnd = pCurrChar;
+                ret = JPE_SYNTAX_ERROR;
+            }
+        }
+        // else {
+        //     if( *pEnd == '\0' && ret != JPE_SYNTAX_ERROR_END ) {
+        //         ret = JPE_SYNTAX_ERROR_END;
+        //     }
+        // }
+    }
+
+    if( pOutErrorInfo ) {
+        pOutErrorInfo->error = ret;
+        _errorLocation( pOutErrorInfo, jsonStr, pEnd, pCtx->pInputEnd );
+    }
+
+    _releaseContext( pCtx );
+    if( pStats ) {
+        uint64_t elapsed = _nanoseconds() - start;
+        pStats->bytes += (ret == JPE_NO_ERROR || !pEnd) ? length : (size_t)(pEnd - jsonStr);
+        pStats->parseNanoseconds += elapsed - (pStats->indexNanoseconds - indexTime);
+        pStats->totalNanoseconds += elapsed;
+    }
+    return ret;
+}
+
+//
+// Main Function of Json Parser
+//
+JsonParsingError parseJsonString(Element *pOutElement, const char *jsonStr, JsonErrorInfo* pOutErrorInfo)
+{
+    JsonParserContext ctx = { .pArena = (JsonArena *)0, };
+    return _parseJson( &ctx, pOutElement, jsonStr, jsonStr ? strlen(jsonStr) : 0, pOutErrorInfo );
+}
+
+JsonParsingError parseJsonStringArena(Element *pOutElement, const char *jsonStr, JsonArena *pArena, JsonErrorInfo* pOutErrorInfo)
+{
+    JsonParserContext ctx = { .pArena = pArena, };
+    return _parseJson( &ctx, pOutElement, jsonStr, jsonStr ? strlen(jsonStr) : 0, pOutErrorInfo );
+}
+
+JsonParsingError parseJsonBuffer(Element *pOutElement, const char *data, size_t length, JsonErrorInfo* pOutErrorInfo)
+{
+    JsonParserContext ctx = { .pArena = (JsonArena *)0, };
+    return _parseJson( &ctx, pOutElement, data, length, pOutErrorInfo );
+}
+
+JsonParsingError parseJsonBufferArena(Element *pOutElement, const char *data, size_t length, JsonArena *pArena, JsonErrorInfo* pOutErrorInfo)
+{
+    JsonParserContext ctx = { .pArena = pArena, };
+    return _parseJson( &ctx, pOutElement, data, length, pOutErrorInfo );
+}
+
+// Returns 0 for invalid options
+static int _setupOptions(JsonParserContext *pCtx, const JsonParseOptions *pOptions)
+{
+    // Shared strings (slices, interned keys) can not be free()'d by resetElement()
+    if( !pOptions->pArena && ((pOptions->flags & (JSON_PARSE_ZERO_COPY | JSON_PARSE_INTERN_KEYS)) || pOptions->pKeyPool) ) {
+        return 0;
+    }
+    for( size_t i = 0; pOptions->ppPaths && i < pOptions->pathCount; i++ ) {
+        if( !_isValidPointer( pOptions->ppPaths[i] ) ) { return 0; }
+    }
+
+    pCtx->pArena = pOptions->pArena;
+    pCtx->flags = pOptions->flags;
+    pCtx->maxDepth = pOptions->maxDepth;
+    pCtx->pStats = pOptions->pStats;
+    pCtx->pAllocator = pOptions->pAllocator;
+    pCtx->documentKeys.arena.pAllocator = pOptions->pAllocator; // (of its entries)
+    pCtx->ppPaths = pOptions->pathCount ? pOptions->ppPaths : (const char * const *)0;
+    pCtx->pathCount = pOptions->pathCount;
+    if( pOptions->pKeyPool ) {
+        pCtx->pKeyPool = pOptions->pKeyPool;
+    }
+    else if( pOptions->flags & JSON_PARSE_INTERN_KEYS ) {
+        pCtx->pKeyPool = &(pCtx->documentKeys);
+    }
+    return 1;
+}
+
+JsonParsingError parseJsonBufferEx(Element *pOutElement, const char *data, size_t length, const JsonParseOptions *pOptions, JsonErrorInfo* pOutErrorInfo)
+{
+    JsonParseOptions defaultOptions = { 0, };
+    if( !pOptions ) { pOptions = &defaultOptions; }
+
+    _resetParseStats( pOptions );
+    JsonParserContext ctx = { .pArena = (JsonArena *)0, };
+    if( !_setupOptions( &ctx, pOptions ) ) { return _errorWithoutLocation( pOutErrorInfo, JPE_INVALID_ARGUMENT ); }
+    return _parseJson( &ctx, pOutElement, data, length, pOutErrorInfo );
+}
+
+JsonParsingError parseJsonInsitu(Element *pOutElement, char *data, size_t length, const JsonParseOptions *pOptions, JsonErrorInfo* pOutErrorInfo)
+{
+    JsonParserContext ctx = { .pArena = (JsonArena *)0, };
+    if( pOptions ) { _resetParseStats( pOptions ); }
+    if( !pOptions || !pOptions->pArena || !_setupOptions( &ctx, pOptions ) ) { // strings in data can not be free()'d by resetElement()
+        return _errorWithoutLocation( pOutErrorInfo, JPE_INVALID_ARGUMENT );
+    }
+    ctx.flags |= _JSON_PARSE_INSITU;
+    return _parseJson( &ctx, pOutElement, data, length, pOutErrorInfo );
+}
+
+JsonParsingError parseJsonSax(const char *data, size_t length, const JsonSaxHandler *pHandler, void *pUserData, JsonErrorInfo* pOutErrorInfo)
+{
+    if( !pHandler ) { return _errorWithoutLocation( pOutErrorInfo, JPE_INVALID_ARGUMENT ); }
+
+    JsonParserContext ctx = { .pHandler = pHandler, .pUserData = pUserData, };
+    Element rootElement; // values are not stored
+    return _parseJson( &ctx, &rootElement, data, length, pOutErrorInfo );
+}
+
+// Validation: the engine in the event mode without callbacks, checking numbers and strings without decoding them
+#define _VALIDATE_INLINE_FRAMES 64
+
+static const JsonSaxHandler _noEvents = { 0, };
+
+JsonParsingError validateJson(const char *data, size_t length, JsonErrorInfo* pOutErrorInfo)
+{
+    return validateJsonEx( data, length, (const JsonAllocator *)0, pOutErrorInfo );
+}
+
+JsonParsingError validateJsonEx(const char *data, size_t length, const JsonAllocator *pAllocator, JsonErrorInfo* pOutErrorInfo)
+{
+    JsonFrame frames[_VALIDATE_INLINE_FRAMES];
+    JsonParserContext ctx = { .flags = _JSON_PARSE_VALIDATE, .pHandler = &_noEvents, .pAllocator = pAllocator,
+                              .pFrames = frames, .frameCapacity = _VALIDATE_INLINE_FRAMES, .pInlineFrames = frames, };
+    Element rootElement; // values are not stored
+    return _parseJson( &ctx, &rootElement, data, length, pOutErrorInfo );
+}
+
+#if _HAVE_MMAP_
+static JsonParsingError _parseJsonFile(JsonParserContext *pCtx, Element *pOutElement, const char *path, JsonErrorInfo* pOutErrorInfo)
+{
+    int fd = path ? open( path, O_RDONLY ) : -1;
+    if( fd < 0 ) { return _errorWithoutLocation( pOutErrorInfo, JPE_IO_ERROR ); }
+
+    struct stat fileStat;
+    if( fstat( fd, &fileStat ) != 0 || !S_ISREG(fileStat.st_mode) || (uint64_t)fileStat.st_size > SIZE_MAX ) {
+        close( fd );
+        return _errorWithoutLocation( pOutErrorInfo, JPE_IO_ERROR );
+    }
+
+    // Empty File: same as an empty string (mmap() does not accept 0 bytes)
+    size_t fileSize = (size_t)fileStat.st_size;
+    if( fileSize == 0 ) {
+        close( fd );
+        return _parseJson( pCtx, pOutElement, "", 0, pOutErrorInfo );
+    }
+
+    // The parser never reads at or past data[fileSize], so a file ending exactly on a page boundary is safe
+    void *pData = mmap( (void *)0, fileSize, PROT_READ, MAP_PRIVATE, fd, 0 );
+    close( fd ); // the mapping stays valid
+    if( pData == MAP_FAILED ) { return _errorWithoutLocation( pOutErrorInfo, JPE_IO_ERROR ); }
+    madvise( pData, fileSize, MADV_SEQUENTIAL );
+
+    JsonParsingError ret = _parseJson( pCtx, pOutElement, (const char *)pData, fileSize, pOutErrorInfo );
+    munmap( pData, fileSize );
+    return ret;
+}
+#else
+// No mmap(): read the whole file into a buffer
+static JsonParsingError _parseJsonFile(JsonParserContext *pCtx, Element *pOutElement, const char *path, JsonErrorInfo* pOutErrorInfo)
+{
+    FILE *fp = path ? fopen( path, "rb" ) : (FILE *)0;
+    if( !fp ) { return _errorWithoutLocation( pOutErrorInfo, JPE_IO_ERROR ); }
+
+    long fileSize = ( fseek( fp, 0L, SEEK_END ) == 0 ) ? ftell( fp ) : -1L;
+    if( fileSize < 0 || fseek( fp, 0L, SEEK_SET ) != 0 ) {
+        fclose( fp );
+        return _errorWithoutLocation( pOutErrorInfo, JPE_IO_ERROR );
+    }
+
+    const JsonAllocator *pAllocator = pCtx->pAllocator; // (pCtx is released by _parseJson())
+    char *pData = (char *)_mallocWith( pAllocator, fileSize ? (size_t)fileSize : 1 );
+    if( !pData ) {
+        fclose( fp );
+        if( pOutErrorInfo ) { pOutErrorInfo->error = JPE_OUT_OF_MEMORY; }
+        return JPE_OUT_OF_MEMORY;
+    }
+    size_t readBytes = fread( pData, 1, (size_t)fileSize, fp );
+    fclose( fp );
+    if( readBytes != (size_t)fileSize ) {
+        _freeWith( pAllocator, pData );
+        return _errorWithoutLocation( pOutErrorInfo, JPE_IO_ERROR );
+    }
+
+    JsonParsingError ret = _parseJson( pCtx, pOutElement, pData, readBytes, pOutErrorInfo );
+    _freeWith( pAllocator, pData );
+    return ret;
+}
+#endif
+
+JsonParsingError parseJsonFile(Element *pOutElement, const char *path, JsonErrorInfo* pOutErrorInfo)
+{
+    JsonParserContext ctx = { .pArena = (JsonArena *)0, };
+    return _parseJsonFile( &ctx, pOutElement, path, pOutErrorInfo );
+}
+
+JsonParsingError parseJsonFileArena(Element *pOutElement, const char *path, JsonArena *pArena, JsonErrorInfo* pOutErrorInfo)
+{
+    JsonParserContext ctx = { .pArena = pArena, };
+    return _parseJsonFile( &ctx, pOutElement, path, pOutErrorInfo );
+}
+
+JsonParsingError parseJsonFileEx(Element *pOutElement, const char *path, const JsonParseOptions *pOptions, JsonErrorInfo* pOutErrorInfo)
+{
+    JsonParseOptions defaultOptions = { 0, };
+    if( !pOptions ) { pOptions = &defaultOptions; }
+
+    _resetParseStats( pOptions );
+    JsonParserContext ctx = { .pArena = (JsonArena *)0, };
+    if( (pOptions->flags & JSON_PARSE_ZERO_COPY) || !_setupOptions( &ctx, pOptions ) ) { // (slices would outlive the file data)
+        return _errorWithoutLocation( pOutErrorInfo, JPE_INVALID_ARGUMENT );
+    }
+    return _parseJsonFile( &ctx, pOutElement, path, pOutErrorInfo );
+}
+
+//
+// Worker Threads
+//
+// threadCount `0`: one per online CPU
+static unsigned int _threadCount(unsigned int threadCount)
+{
+    if( threadCount == 0 ) {
+    #if _HAVE_PTHREAD_
+        long cpuCount = sysconf( _SC_NPROCESSORS_ONLN );
+        threadCount = (cpuCount > 0) ? (unsigned int)cpuCount : 1;
+    #else
+        threadCount = 1;
     #endif
-            return parseNumber( pCurrChar, ppEnd, pElement );
-        // Try parse as Boolean
-        case 't':
-        case 'f': 
-            return parseBoolean( pCurrChar, ppEnd, pElement );
-        // Try parse as Null
-        case 'n':
-            return parseNull( pCurrChar, ppEnd, pElement );
-        // End of String
-        case '\0':
-            *ppEnd = pCurrChar;
-            return JPE_SYNTAX_ERROR_END;
+    }
+    return threadCount;
+}
+
+// Run pRoutine on each of the threadCount arguments (argSize bytes each) in its own thread and wait for all of them
+// ** This thread runs the first one; a thread that can not be created leaves its share of the work to the others.
+static void _runThreads(const JsonAllocator *pAllocator, void *(*pRoutine)(void *), void *pArgs, size_t argSize, unsigned int threadCount)
+{
+#if _HAVE_PTHREAD_
+    pthread_t *pThreads = (pthread_t *)_callocWith( pAllocator, threadCount * sizeof(pthread_t) );
+    int *pStarted = (int *)_callocWith( pAllocator, threadCount * sizeof(int) );
+    for( unsigned int i = 1; pThreads && pStarted && i < threadCount; i++ ) {
+        pStarted[i] = (pthread_create( &(pThreads[i]), (const pthread_attr_t *)0, pRoutine, (char *)pArgs + i * argSize ) == 0);
+    }
+    pRoutine( pArgs );
+    for( unsigned int i = 1; pThreads && pStarted && i < threadCount; i++ ) {
+        if( pStarted[i] ) { pthread_join( pThreads[i], (void **)0 ); }
+    }
+    _freeWith( pAllocator, pThreads );
+    _freeWith( pAllocator, pStarted );
+#else
+    (void)pAllocator;
+    (void)argSize;
+    (void)threadCount;
+    pRoutine( pArgs );
+#endif
+}
+
+//
+// JSON Lines (NDJSON)
+// ** Records are split at every '\n' with memchr(): a JSON string can not hold a raw newline,
+//    so no valid record spans two lines and no string has to be tracked while splitting.
+// ** Workers take batches of records from a shared counter and parse them into their own arena.
+//
+#define _JSON_LINES_BATCH 64 // records taken by a worker at once
+
+typedef struct
+{
+    JsonRecordSet          *pSet;
+    const char             *data;
+    const JsonParseOptions *pOptions;
+#if _HAVE_PTHREAD_
+    atomic_size_t           nextRecord;
+#else
+    size_t                  nextRecord;
+#endif
+} _JsonLinesJob;
+
+typedef struct
+{
+    _JsonLinesJob *pJob;
+    JsonArena     *pArena;
+    JsonParseStats stats; // added to the caller's at the end
+} _JsonLinesWorker;
+
+static void _parseJsonRecord(_JsonLinesWorker *pWorker, JsonRecord *pRecord)
+{
+    const _JsonLinesJob *pJob = pWorker->pJob;
+    JsonParseOptions options = *(pJob->pOptions);
+    options.pArena = pWorker->pArena;
+    options.pStats = options.pStats ? &(pWorker->stats) : (JsonParseStats *)0;
+
+    JsonParserContext ctx = { .pArena = (JsonArena *)0, };
+    _setupOptions( &ctx, &options ); // (checked by parseJsonLines())
+    pRecord->element.type = TYPE_NULL;
+    if( _parseJson( &ctx, &(pRecord->element), pJob->data + pRecord->offset, pRecord->length, &(pRecord->errorInfo) ) != JPE_NO_ERROR ) {
+        pRecord->element.type = TYPE_NULL; // (its nodes are left in the arena)
+    }
+
+    // Location in the whole buffer
+    pRecord->errorInfo.line += pRecord->line - 1;
+    pRecord->errorInfo.position += pRecord->offset;
+}
+
+static void *_jsonLinesWorker(void *pArg)
+{
+    _JsonLinesWorker *pWorker = (_JsonLinesWorker *)pArg;
+    _JsonLinesJob *pJob = pWorker->pJob;
+    size_t recordCount = pJob->pSet->count;
+
+    for( ;; ) {
+    #if _HAVE_PTHREAD_
+        size_t first = atomic_fetch_add( &(pJob->nextRecord), _JSON_LINES_BATCH );
+    #else
+        size_t first = pJob->nextRecord;
+        pJob->nextRecord += _JSON_LINES_BATCH;
+    #endif
+        if( first >= recordCount ) { break; }
+
+        size_t last = (recordCount - first > _JSON_LINES_BATCH) ? first + _JSON_LINES_BATCH : recordCount;
+        for( size_t i = first; i < last; i++ ) {
+            _parseJsonRecord( pWorker, &(pJob->pSet->records[i]) );
+        }
+    }
+    return (void *)0;
+}
+
+// Record per non-blank line
+static JsonParsingError _splitJsonLines(JsonRecordSet *pSet, const char *data, size_t length)
+{
+    const char *pInputEnd = data + length;
+    size_t capacity = 0;
+    size_t line = 1;
+
+    for( const char *pLine = data; pLine < pInputEnd; line++ ) {
+        const char *pNewLine = (const char *)memchr( pLine, '\n', (size_t)(pInputEnd - pLine) );
+        const char *pLineEnd = pNewLine ? pNewLine : pInputEnd;
+
+        if( _skipSpace( pLine, pLineEnd ) != pLineEnd ) {
+            if( pSet->count == capacity ) {
+                size_t newCapacity = capacity ? capacity * 2 : 1024;
+                JsonRecord *pNewRecords = (JsonRecord *)_reallocWith( pSet->pAllocator, pSet->records, newCapacity * sizeof(JsonRecord) );
+                if( !pNewRecords ) { return JPE_OUT_OF_MEMORY; }
+                pSet->records = pNewRecords;
+                capacity = newCapacity;
+            }
+            JsonRecord *pRecord = &(pSet->records[pSet->count++]);
+            pRecord->offset = (size_t)(pLine - data);
+            pRecord->length = (size_t)(pLineEnd - pLine);
+            pRecord->line = line;
+        }
+        pLine = pLineEnd + 1;
+    }
+    return JPE_NO_ERROR;
+}
+
+JsonParsingError parseJsonLines(JsonRecordSet *pOutSet, const char *data, size_t length, const JsonParseOptions *pOptions, unsigned int threadCount)
+{
+    JsonParseOptions defaultOptions = { 0, };
+    if( !pOptions ) { pOptions = &defaultOptions; }
+
+    pOutSet->records = (JsonRecord *)0;
+    pOutSet->count = 0;
+    pOutSet->arenas = (JsonArena *)0;
+    pOutSet->arenaCount = 0;
+    pOutSet->pAllocator = pOptions->pAllocator;
+    _resetParseStats( pOptions );
+    if( pOptions->pArena || pOptions->pKeyPool ) { return JPE_INVALID_ARGUMENT; } // not thread-safe
+    if( !data ) { return JPE_NO_ERROR; }
+
+    JsonParseStats *pStats = pOptions->pStats;
+    uint64_t start = pStats ? _nanoseconds() : 0;
+    if( _splitJsonLines( pOutSet, data, length ) != JPE_NO_ERROR ) {
+        releaseJsonRecordSet( pOutSet );
+        return JPE_OUT_OF_MEMORY;
+    }
+    if( pStats ) { pStats->indexNanoseconds = _nanoseconds() - start; }
+
+    // Threads: no more than there are batches
+    threadCount = _threadCount( threadCount );
+    size_t batchCount = (pOutSet->count + _JSON_LINES_BATCH - 1) / _JSON_LINES_BATCH;
+    if( threadCount > batchCount ) { threadCount = batchCount ? (unsigned int)batchCount : 1; }
+
+    pOutSet->arenas = (JsonArena *)_callocWith( pOutSet->pAllocator, threadCount * sizeof(JsonArena) );
+    _JsonLinesWorker *pWorkers = (_JsonLinesWorker *)_callocWith( pOutSet->pAllocator, threadCount * sizeof(_JsonLinesWorker) );
+    if( !pOutSet->arenas || !pWorkers ) {
+        _freeWith( pOutSet->pAllocator, pWorkers );
+        releaseJsonRecordSet( pOutSet );
+        return JPE_OUT_OF_MEMORY;
+    }
+    pOutSet->arenaCount = threadCount;
+
+    _JsonLinesJob job = { .pSet = pOutSet, .data = data, .pOptions = pOptions, };
+    for( unsigned int i = 0; i < threadCount; i++ ) {
+        initJsonArenaEx( &(pOutSet->arenas[i]), 0, pOutSet->pAllocator );
+        pWorkers[i].pJob = &job;
+        pWorkers[i].pArena = &(pOutSet->arenas[i]);
+    }
+
+    _runThreads( pOutSet->pAllocator, _jsonLinesWorker, pWorkers, sizeof(_JsonLinesWorker), threadCount );
+    if( pStats ) {
+        for( unsigned int i = 0; i < threadCount; i++ ) {
+            _mergeParseStats( pStats, &(pWorkers[i].stats) );
+        }
+        pStats->bytes = length; // (with the newlines)
+        pStats->totalNanoseconds = _nanoseconds() - start;
+    }
+    _freeWith( pOutSet->pAllocator, pWorkers );
+
+    for( size_t i = 0; i < pOutSet->count; i++ ) {
+        if( pOutSet->records[i].errorInfo.error != JPE_NO_ERROR ) { return pOutSet->records[i].errorInfo.error; }
+    }
+    return JPE_NO_ERROR;
+}
+
+void releaseJsonRecordSet(JsonRecordSet *pSet)
+{
+    for( size_t i = 0; i < pSet->arenaCount; i++ ) {
+        releaseJsonArena( &(pSet->arenas[i]) );
+    }
+    _freeWith( pSet->pAllocator, pSet->arenas );
+    _freeWith( pSet->pAllocator, pSet->records );
+    pSet->records = (JsonRecord *)0;
+    pSet->count = 0;
+    pSet->arenas = (JsonArena *)0;
+    pSet->arenaCount = 0;
+}
+
+//
+// String Scanner
+// ** Finds the first '"', '\\' or control character from pCurrChar (pInputEnd if there is none).
+//
+#if defined(__AVX2__) || defined(__SSE2__)
+static inline uint32_t _stringSpecialMask(_ScanBlock block)
+{
+    _ScanBlock special = _orBlock( _cmpeqBlock( block, _set1Block('"') ), _cmpeqBlock( block, _set1Block('\\') ) );
+    // (unsigned)c <= 0x1F
+    special = _orBlock( special, _cmpeqBlock( _minBlock( block, _set1Block(0x1F) ), block ) );
+    return _maskBlock( special );
+}
+
+static const char *_scanString(const char *pCurrChar, const char *pInputEnd)
+{
+    while( pInputEnd - pCurrChar >= _SCAN_BLOCK ) {
+        uint32_t mask = _stringSpecialMask( _loadBlock(pCurrChar) );
+        if( mask ) { return pCurrChar + __builtin_ctz(mask); }
+        pCurrChar += _SCAN_BLOCK;
+    }
+    while( pCurrChar < pInputEnd && *pCurrChar != '"' && *pCurrChar != '\\' && (unsigned char)*pCurrChar >= 0x20 ) { pCurrChar++; }
+    return pCurrChar;
+}
+
+#elif defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+// Portable: 8 bytes at a time (SWAR)
+#define _SWAR_ONES  0x0101010101010101ull
+#define _SWAR_HIGHS 0x8080808080808080ull
+#define _swarLess(x, n)   ( ((x) - _SWAR_ONES * (n)) & ~(x) & _SWAR_HIGHS )
+#define _swarEqual(x, c)  _swarLess( (x) ^ (_SWAR_ONES * (c)), 1 )
+
+static const char *_scanString(const char *pCurrChar, const char *pInputEnd)
+{
+    while( pInputEnd - pCurrChar >= 8 ) {
+        uint64_t word;
+        memcpy( &word, pCurrChar, sizeof(word) );
+        // Lowest flagged byte is exact (borrows only propagate upward)
+        uint64_t special = _swarEqual( word, '"' ) | _swarEqual( word, '\\' ) | _swarLess( word, 0x20 );
+        if( special ) { return pCurrChar + (__builtin_ctzll(special) >> 3); }
+        pCurrChar += 8;
+    }
+    while( pCurrChar < pInputEnd && *pCurrChar != '"' && *pCurrChar != '\\' && (unsigned char)*pCurrChar >= 0x20 ) { pCurrChar++; }
+    return pCurrChar;
+}
+
+#else
+static const char *_scanString(const char *pCurrChar, const char *pInputEnd)
+{
+    while( pCurrChar < pInputEnd && *pCurrChar != '"' && *pCurrChar != '\\' && (unsigned char)*pCurrChar >= 0x20 ) { pCurrChar++; }
+    return pCurrChar;
+}
+#endif
+
+static int _reserveScratch(JsonParserContext *pCtx, size_t size)
+{
+    if( size > pCtx->scratchCapacity ) {
+        size_t newCapacity = pCtx->scratchCapacity ? pCtx->scratchCapacity * 2 : 256;
+        while( newCapacity < size ) { newCapacity *= 2; }
+        char *pNewScratch = (char *)_reallocWith( pCtx->pAllocator, pCtx->pScratch, newCapacity );
+        if( !pNewScratch ) { return 0; }
+        pCtx->pScratch = pNewScratch;
+        pCtx->scratchCapacity = newCapacity;
+    }
+    return 1;
+}
+
+// pOutHash can be `NULL`, if the string is not an object key
+JsonParsingError _getString(JsonParserContext *pCtx, char **pOutString, size_t *pOutLength, uint32_t *pOutHash, const char *pCurrChar, const char ** ppEnd)
+{
+    const char *pInputEnd = pCtx->pInputEnd;
+
+    // Not allow single quote string
+    if( _peekChar(pCurrChar, pInputEnd) != '"' ) { 
+        *ppEnd = pCurrChar;
+        return JPE_SYNTAX_ERROR;
+    }
+
+    const char *pSrc = pCurrChar + 1;
+    const char *pSpecial = _scanString( pSrc, pInputEnd );
+    const char *pString = pSrc;                    // decoded bytes
+    size_t length = (size_t)(pSpecial - pSrc);
+
+    if( _peekChar(pSpecial, pInputEnd) != '"' && (pCtx->flags & _JSON_PARSE_VALIDATE) ) {
+        // Validation: escapes are checked as below, but nothing is decoded (the string is not used)
+        for(;;) {
+            if( pSpecial == pInputEnd ) {
+                *ppEnd = pSpecial;
+                return JPE_SYNTAX_ERROR_END;
+            }
+            else if( *pSpecial == '"' ) { // End of String
+                break;
+            }
+            else if( *pSpecial != '\\' ) {
+                *ppEnd = pSpecial;
+                return JPE_SYNTAX_ERROR_STRING_CONTROL;
+            }
+
+            const char *pEscape = pSpecial + 1;
+            if( pEscape == pInputEnd ) {
+                *ppEnd = pEscape;
+                return JPE_SYNTAX_ERROR_END;
+            }
+            switch( *pEscape ) {
+                case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+                    break;
+                case 'u':
+                    if( pInputEnd - pEscape < 5 ||
+                        !_isHexDigit(pEscape[1]) || !_isHexDigit(pEscape[2]) || !_isHexDigit(pEscape[3]) || !_isHexDigit(pEscape[4]) ) {
+                        *ppEnd = pEscape;
+                        return JPE_SYNTAX_ERROR_UNICODE_ESCAPE;
+                    }
+                    pEscape += 4;
+                    break;
+                default:
+                    *ppEnd = pEscape;
+                    return JPE_SYNTAX_ERROR_STRING_ESCAPE;
+            }
+
+            pSrc = pEscape + 1;
+            pSpecial = _scanString( pSrc, pInputEnd );
+        }
+        length = 0;
+    }
+    else if( _peekChar(pSpecial, pInputEnd) != '"' ) {
+        // Unescape into the scratch buffer in one pass (unescaped runs are copied in bulk)
+        length = 0;
+        for(;;) {
+            size_t runLength = (size_t)(pSpecial - pSrc);
+            if( !_reserveScratch( pCtx, length + runLength + 4 ) ) { // an escape produces 3 bytes at most
+                *ppEnd = pSpecial;
+                return JPE_OUT_OF_MEMORY;
+            }
+            memcpy( pCtx->pScratch + length, pSrc, runLength );
+            length += runLength;
+
+            if( pSpecial == pInputEnd ) {
+                *ppEnd = pSpecial;
+                return JPE_SYNTAX_ERROR_END;
+            }
+            else if( *pSpecial == '"' ) { // End of String
+                break;
+            }
+            else if( *pSpecial != '\\' ) {
+                *ppEnd = pSpecial;
+                return JPE_SYNTAX_ERROR_STRING_CONTROL;
+            }
+
+            const char *pEscape = pSpecial + 1;
+            if( pEscape == pInputEnd ) {
+                *ppEnd = pEscape;
+                return JPE_SYNTAX_ERROR_END;
+            }
+
+            char *pDst = pCtx->pScratch + length;
+            switch( *pEscape ) {
+                case '"' : *pDst++ = '"'; break;
+                case '\\': *pDst++ = '\\'; break; 
+                case '/' : *pDst++ = '/'; break;
+                case 'b' : *pDst++ = '\b'; break;
+                case 'f' : *pDst++ = '\f'; break;
+                case 'n' : *pDst++ = '\n'; break;
+                case 'r' : *pDst++ = '\r'; break;
+                case 't' : *pDst++ = '\t'; break;
+                case 'u': // Convert UTF-16 to UTF-8
+                {
+                    if( pInputEnd - pEscape < 5 ||
+                        !_isHexDigit(pEscape[1]) || !_isHexDigit(pEscape[2]) || !_isHexDigit(pEscape[3]) || !_isHexDigit(pEscape[4]) ) {
+                        *ppEnd = pEscape;
+                        return JPE_SYNTAX_ERROR_UNICODE_ESCAPE;
+                    }
+                    int unicode = _hex2int(pEscape[1]) << 12
+                                | _hex2int(pEscape[2]) << 8
+                                | _hex2int(pEscape[3]) << 4
+                                | _hex2int(pEscape[4]);
+                    if( unicode < 0x80 ) { // U+0000 ~ U+007F -> | 0xxxxxxx |
+                        *pDst++ = (char)unicode;
+                    }
+                    else if( unicode < 0x800 ) { // U+0080 ~ U+07FF -> | 110xxxxx | 10xxxxxx |
+                        *pDst++ = (char)(0xC0 + (unicode >> 6));
+                        *pDst++ = (char)(0x80 + (unicode & 0x3F));
+                    }
+                    else { // U+0800 ~ U+FFFF -> | 1110xxxx | 10xxxxxx | 10xxxxxx |
+                        *pDst++ = (char)(0xe0 + (unicode >> 12));          // 0xe0 + unicode / 4096
+                        *pDst++ = (char)(0x80 + ((unicode >> 6) & 0x3F));  // 0x80 + unicode / 64 % 64
+                        *pDst++ = (char)(0x80 + (unicode & 0x3F));         // 0x80 + unicode % 64
+                    }
+                    pEscape += 4;
+                }
+                break;
+                default:
+                    *ppEnd = pEscape;
+                    return JPE_SYNTAX_ERROR_STRING_ESCAPE;
+            }
+            length = (size_t)(pDst - pCtx->pScratch);
+
+            pSrc = pEscape + 1;
+            pSpecial = _scanString( pSrc, pInputEnd );
+        }
+        pString = pCtx->pScratch;
+    }
+
+    char *stringValue = (char *)0;
+    if( length > UINT32_MAX ) {
+        *ppEnd = pSpecial + 1;
+        return JPE_OUT_OF_MEMORY;
+    }
+    else if( pCtx->pHandler ) {
+        // Borrowed: slice of the input or the scratch buffer (valid until the next string)
+        *ppEnd = pSpecial + 1;
+        *pOutString = (char *)pString;
+        *pOutLength = length;
+        return JPE_NO_ERROR;
+    }
+    else if( pOutHash && pCtx->pKeyPool ) {
+        // Interned Key
+        *pOutHash = _hashKey( pString, length );
+        JsonArena *pStorage = (pCtx->pKeyPool == &(pCtx->documentKeys)) ? pCtx->pArena : &(pCtx->pKeyPool->arena);
+        stringValue = _internKey( pCtx->pKeyPool, pStorage, pString, length, *pOutHash );
+        if( !stringValue ) {
+            *ppEnd = pSpecial + 1;
+            return JPE_OUT_OF_MEMORY;
+        }
+        *ppEnd = pSpecial + 1;
+        *pOutString = stringValue;
+        *pOutLength = length;
+        return JPE_NO_ERROR;
+    }
+    else if( pCtx->flags & _JSON_PARSE_INSITU ) {
+        // Decoded bytes never outgrow the source: write them back and terminate (over the closing quote at most)
+        stringValue = (char *)(pCurrChar + 1);
+        if( pString != stringValue ) { memcpy( stringValue, pString, length ); }
+        stringValue[length] = '\0';
+    }
+    else if( (pCtx->flags & JSON_PARSE_ZERO_COPY) && pString == pCurrChar + 1 ) {
+        // Slice of the input (not NUL-terminated)
+        stringValue = (char *)pString;
+    }
+    else {
+        // Right-sized copy
+        stringValue = (char *)_allocMemory( pCtx, length + 1 );
+        if( !stringValue ) {
+            *ppEnd = pSpecial + 1;
+            return JPE_OUT_OF_MEMORY;
+        }
+        memcpy( stringValue, pString, length );
+        stringValue[length] = '\0';
+    }
+    if( pOutHash ) { *pOutHash = _hashKey( stringValue, length ); }
+
+    *ppEnd = pSpecial + 1;
+    *pOutString = stringValue;
+    *pOutLength = length;
+    return JPE_NO_ERROR;
+}
+
+//
+// Parsing Engine
+// ** Iterative: the containers being parsed are frames in pCtx->pFrames (not C stack frames),
+//    so deep nesting costs heap memory up to pCtx->maxDepth and then fails with JPE_NESTING_TOO_DEEP.
+// ** Errors are reported as the recursive descent parser did: a container turns a failure inside it
+//    into JPE_SYNTAX_ERROR_OBJECT / JPE_SYNTAX_ERROR_ARRAY (the outermost one wins), except END and system errors.
+// ** Resumable: with _JSON_PARSE_PARTIAL, reaching the end of the input (or a token that may continue past it)
+//    suspends the engine in *pState instead of failing, and it goes on from there with more input.
+// ** Event API: with pCtx->pHandler, values are reported by _emitValue() instead of being stored in containers.
+//
+typedef enum
+{
+    _STATE_VALUE,           // a value is expected
+    _STATE_VALUE_DONE,      // a value was parsed: store it into the current container
+    _STATE_CONTAINER_START, // '{' or '[' was consumed: the closing bracket or the first member / element is expected
+    _STATE_OBJECT_KEY,      // a key is expected
+    _STATE_OBJECT_COLON,    // ':' is expected
+    _STATE_AFTER_VALUE,     // ',' or the closing bracket is expected
+    _STATE_DONE
+} _ParserState;
+
+static int _pushFrame(JsonParserContext *pCtx, ElementType type)
+{
+    if( pCtx->frameCount == pCtx->frameCapacity ) {
+        size_t newCapacity = pCtx->frameCapacity ? pCtx->frameCapacity * 2 : 32;
+        JsonFrame *pNewFrames;
+        if( pCtx->pFrames && pCtx->pFrames == pCtx->pInlineFrames ) {
+            pNewFrames = (JsonFrame *)_mallocWith( pCtx->pAllocator, newCapacity * sizeof(JsonFrame) );
+            if( pNewFrames ) { memcpy( pNewFrames, pCtx->pFrames, pCtx->frameCount * sizeof(JsonFrame) ); }
+        }
+        else {
+            pNewFrames = (JsonFrame *)_reallocWith( pCtx->pAllocator, pCtx->pFrames, newCapacity * sizeof(JsonFrame) );
+        }
+        if( !pNewFrames ) { return 0; }
+        pCtx->pFrames = pNewFrames;
+        pCtx->frameCapacity = newCapacity;
+    }
+
+    JsonFrame *pFrame = &(pCtx->pFrames[pCtx->frameCount++]);
+    pFrame->type = type;
+    pFrame->key = (char *)0;
+    pFrame->keyLength = 0;
+    pFrame->keyHash = 0;
+    pFrame->stackBase = pCtx->stackSize;
+    pFrame->select = _SELECT_ALL;
+    pFrame->next = 0;
+    _countContainer( pCtx, type );
+    return 1;
+}
+
+// Copy the members / elements of the current container to one contiguous block and pop its frame
+static JsonParsingError _closeFrame(JsonParserContext *pCtx, Element *pElement)
+{
+    JsonFrame *pFrame = &(pCtx->pFrames[pCtx->frameCount - 1]);
+    size_t itemSize = (pFrame->type == TYPE_OBJECT) ? sizeof(ObjectNode) : sizeof(Element);
+    size_t count = (pCtx->stackSize - pFrame->stackBase) / itemSize;
+    size_t indexBytes = (pFrame->type == TYPE_OBJECT) ? _objectIndexBytes(count) : 0;
+
+    void *pItems = (void *)0;
+    if( count ) {
+        pItems = (count <= UINT32_MAX) ? _allocMemory( pCtx, count * itemSize + indexBytes ) : (void *)0;
+        if( !pItems ) { return JPE_OUT_OF_MEMORY; }
+        memcpy( pItems, pCtx->pStack + pFrame->stackBase, count * itemSize );
+    }
+    pCtx->stackSize = pFrame->stackBase;
+
+    pElement->type = pFrame->type;
+    pElement->length = (uint32_t)count;
+    if( pFrame->type == TYPE_OBJECT ) {
+        pElement->objectValue = (ObjectNode *)pItems;
+        _buildObjectIndex( pElement );
+    }
+    else {
+        pElement->arrayValue = (Element *)pItems;
+    }
+    pCtx->frameCount--;
+    return JPE_NO_ERROR;
+}
+
+// Release every container being parsed (on error)
+static void _releaseFrames(JsonParserContext *pCtx)
+{
+    while( pCtx->frameCount ) {
+        JsonFrame *pFrame = &(pCtx->pFrames[--pCtx->frameCount]);
+        if( pFrame->key ) { _freeMemory( pCtx, pFrame->key ); }
+        _popStack( pCtx, pFrame->stackBase, (pFrame->type == TYPE_OBJECT) ? sizeof(ObjectNode) : sizeof(Element) );
+    }
+}
+
+// Report a value (or the end of a container) to pCtx->pHandler; returns non-zero to stop parsing
+static int _emitValue(JsonParserContext *pCtx, const Element *pValue)
+{
+    const JsonSaxHandler *pHandler = pCtx->pHandler;
+    void *pUserData = pCtx->pUserData;
+    switch( pValue->type )
+    {
+        case TYPE_OBJECT:     return pHandler->endObject ? pHandler->endObject( pUserData ) : 0;
+        case TYPE_ARRAY:      return pHandler->endArray ? pHandler->endArray( pUserData ) : 0;
+        case TYPE_STRING:     return pHandler->stringValue ? pHandler->stringValue( pUserData, pValue->stringValue, pValue->length ) : 0;
+        case TYPE_DBL_NUMBER: return pHandler->dblNumberValue ? pHandler->dblNumberValue( pUserData, pValue->dNumberValue ) : 0;
+        case TYPE_INT_NUMBER: return pHandler->intNumberValue ? pHandler->intNumberValue( pUserData, pValue->iNumberValue ) : 0;
+        case TYPE_BOOLEAN:    return pHandler->booleanValue ? pHandler->booleanValue( pUserData, (int)pValue->iNumberValue ) : 0;
+        case TYPE_NULL:       return pHandler->nullValue ? pHandler->nullValue( pUserData ) : 0;
+    }
+    return 0;
+}
+
+// Lazy document: add the container opening at pCurrChar (for the frame just pushed)
+static int _openLazyContainer(JsonParserContext *pCtx, const char *pCurrChar)
+{
+    JsonLazyDocument *pDocument = pCtx->pLazyDocument;
+    if( pDocument->containerCount == pDocument->containerCapacity ) {
+        size_t newCapacity = pDocument->containerCapacity ? pDocument->containerCapacity * 2 : 64;
+        struct tagJsonLazyContainer *pNewContainers = (struct tagJsonLazyContainer *)_reallocWith( pDocument->pAllocator, pDocument->containers, newCapacity * sizeof(struct tagJsonLazyContainer) );
+        if( !pNewContainers ) { return 0; }
+        pDocument->containers = pNewContainers;
+        pDocument->containerCapacity = newCapacity;
+    }
+
+    pCtx->pFrames[pCtx->frameCount - 1].lazyEntry = pDocument->containerCount;
+    pDocument->containers[pDocument->containerCount].open = (size_t)(pCurrChar - pDocument->data);
+    pDocument->containers[pDocument->containerCount].close = 0;
+    pDocument->containers[pDocument->containerCount].pItems = (size_t *)0;
+    pDocument->containers[pDocument->containerCount].itemCount = SIZE_MAX;
+    pDocument->containerCount++;
+    return 1;
+}
+
+// Lazy document: the current container closes at pCurrChar
+static void _closeLazyContainer(JsonParserContext *pCtx, const char *pCurrChar)
+{
+    JsonLazyDocument *pDocument = pCtx->pLazyDocument;
+    pDocument->containers[pCtx->pFrames[pCtx->frameCount - 1].lazyEntry].close = (size_t)(pCurrChar - pDocument->data);
+}
+
+// _JSON_PARSE_PARTIAL: is the string / number / literal at pCurrChar followed by something in the input?
+// ** pCtx->tokenScanned remembers how far an incomplete token was scanned, so a long one is not rescanned per chunk.
+static int _isTokenComplete(JsonParserContext *pCtx, const char *pCurrChar)
+{
+    const char *pInputEnd = pCtx->pInputEnd;
+    const char *p = pCurrChar + (pCtx->tokenScanned ? pCtx->tokenScanned : 1);
+
+    if( *pCurrChar == '"' ) {
+        for( ;; ) {
+            p = _scanString( p, pInputEnd );
+            if( p == pInputEnd || (*p == '\\' && p + 1 == pInputEnd) ) { break; } // (never stop inside an escape)
+            if( *p != '\\' ) { pCtx->tokenScanned = 0; return 1; } // closing quote or control character
+            p += 2;
+        }
+    }
+    else {
+        for( ; p < pInputEnd; p++ ) {
+            if( !_isLiteralChar(*p) ) {
+                pCtx->tokenScanned = 0;
+                return 1;
+            }
+        }
+    }
+    pCtx->tokenScanned = (size_t)(p - pCurrChar);
+    return 0;
+}
+
+// String, number or literal at pCurrChar
+static inline JsonParsingError _parseScalar(JsonParserContext *pCtx, const char *pCurrChar, const char **ppEnd, Element *pElement)
+{
+    JsonParsingError ret;
+    switch( *pCurrChar )
+    {
+        // Try parse as String
+        case '"': ret = parseString( pCtx, pCurrChar, ppEnd, pElement ); break;
+        // Try parse as Number (Octal, Decimal, Hex Integer and Floating Point)
+        case '+':
+        case '-': 
+        case '0': 
+        case '1':
+        case '2':
+        case '3':
+        case '4':
+        case '5':
+        case '6':
+        case '7':
+        case '8':
+        case '9': 
+    #if _ALLOW_LOOSEN_NUMBER_FORMAT_ // allow floating point, skipping leading zero (ex> .12)
+        case '.':
+    #endif
+            ret = parseNumber( pCtx, pCurrChar, ppEnd, pElement );
+            break;
+        // Try parse as Boolean
+        case 't':
+        case 'f': 
+            ret = parseBoolean( pCtx, pCurrChar, ppEnd, pElement );
+            break;
+        // Try parse as Null
+        case 'n':
+            ret = parseNull( pCtx, pCurrChar, ppEnd, pElement );
+            break;
+
+        default: // Token Error
+            *ppEnd = pCurrChar;
+            return JPE_SYNTAX_ERROR;
+    }
+    if( ret == JPE_NO_ERROR ) { _countScalar( pCtx, pElement ); }
+    return ret;
+}
+
+// Run the engine from *pState until the root value is in *pElement (*pState is _STATE_DONE),
+// an error, or (_JSON_PARSE_PARTIAL) the end of the input is reached (JPE_NO_ERROR, *ppEnd: first byte not consumed)
+static JsonParsingError _runParser(JsonParserContext *pCtx, _ParserState *pState, const char *pCurrChar, const char **ppEnd, Element *pElement)
+{
+    const char *pInputEnd = pCtx->pInputEnd;
+    const char *ptrEnd = (const char *)0;
+    int partial = (pCtx->flags & _JSON_PARSE_PARTIAL) != 0;
+    JsonParsingError ret = JPE_NO_ERROR;
+    size_t wrappingFrames = 0;   // containers the error happened in (they wrap it)
+    Element value = { .type = TYPE_NULL, };
+    _ParserState state = *pState;
+
+    while( state != _STATE_DONE && ret == JPE_NO_ERROR )
+    {
+        switch( state )
+        {
+            case _STATE_VALUE:
+            {
+                // Trim Left
+                pCurrChar = _skipSpace( pCurrChar, pInputEnd );
+                if( pCurrChar == pInputEnd ) { // End of String
+                    if( partial ) { goto suspend; }
+                    ptrEnd = pCurrChar;
+                    ret = JPE_SYNTAX_ERROR_END;
+                    break;
+                }
+
+                char token = *pCurrChar;
+                size_t select = pCtx->pProjection ? _selectValue( pCtx ) : _SELECT_ALL;
+                if( select == _SELECT_SKIP || (select != _SELECT_ALL && token != '{' && token != '[') ) {
+                    // Not projected: a member is left out, an element (or the root value) is null
+                    ret = JPE_NO_ERROR;
+                    ptrEnd = _skipValue( pCurrChar, pInputEnd, &ret );
+                    wrappingFrames = pCtx->frameCount;
+                    pCurrChar = ptrEnd;
+                    value.type = TYPE_NULL;
+                    value.iNumberValue = 0;
+                    JsonFrame *pFrame = pCtx->frameCount ? &(pCtx->pFrames[pCtx->frameCount - 1]) : (JsonFrame *)0;
+                    if( pFrame && pFrame->type == TYPE_OBJECT ) {
+                        if( pFrame->key ) { _freeMemory( pCtx, pFrame->key ); } // (a path through a scalar)
+                        pFrame->key = (char *)0;
+                        state = _STATE_AFTER_VALUE;
+                    }
+                    else {
+                        state = _STATE_VALUE_DONE;
+                    }
+                    break;
+                }
+                if( token == '{' || token == '[' ) {
+                    if( pCtx->frameCount >= pCtx->maxDepth ) {
+                        ptrEnd = pCurrChar;
+                        ret = JPE_NESTING_TOO_DEEP;
+                        break;
+                    }
+                    if( !_pushFrame( pCtx, (token == '{') ? TYPE_OBJECT : TYPE_ARRAY ) ||
+                        (pCtx->pLazyDocument && !_openLazyContainer( pCtx, pCurrChar )) ) {
+                        ptrEnd = pCurrChar;
+                        ret = JPE_OUT_OF_MEMORY;
+                        break;
+                    }
+                    pCtx->pFrames[pCtx->frameCount - 1].select = select;
+                    if( pCtx->pHandler ) {
+                        int (*pStart)(void *) = (token == '{') ? pCtx->pHandler->startObject : pCtx->pHandler->startArray;
+                        if( pStart && pStart( pCtx->pUserData ) ) {
+                            ptrEnd = pCurrChar;
+                            ret = JPE_CANCELLED;
+                            break;
+                        }
+                    }
+                    pCurrChar++;
+                    state = _STATE_CONTAINER_START;
+                    break;
+                }
+
+                if( partial && !_isTokenComplete( pCtx, pCurrChar ) ) { goto suspend; }
+                ret = _parseScalar( pCtx, pCurrChar, &ptrEnd, &value );
+                wrappingFrames = pCtx->frameCount;
+                pCurrChar = ptrEnd;
+                state = _STATE_VALUE_DONE;
+            }
+            break;
+
+            case _STATE_VALUE_DONE:
+            {
+                if( pCtx->pHandler ) {
+                    if( _emitValue( pCtx, &value ) ) {
+                        ptrEnd = pCurrChar;
+                        ret = JPE_CANCELLED;
+                        break;
+                    }
+                    state = pCtx->frameCount ? _STATE_AFTER_VALUE : _STATE_DONE;
+                    break;
+                }
+                if( pCtx->frameCount == 0 ) { // Root Value
+                    *pElement = value;
+                    state = _STATE_DONE;
+                    break;
+                }
+
+                JsonFrame *pFrame = &(pCtx->pFrames[pCtx->frameCount - 1]);
+                int pushed;
+                if( pFrame->type == TYPE_OBJECT ) {
+                    ObjectNode member = { .element = value, .key = pFrame->key, .keyLength = pFrame->keyLength, .keyHash = pFrame->keyHash, };
+                    pushed = _pushStack( pCtx, &member, sizeof(ObjectNode) );
+                    if( pushed ) { pFrame->key = (char *)0; }
+                }
+                else {
+                    pushed = _pushStack( pCtx, &value, sizeof(Element) );
+                }
+                if( !pushed ) {
+                    _releaseElement( pCtx, &value );
+                    ptrEnd = pCurrChar;
+                    ret = JPE_OUT_OF_MEMORY;
+                    break;
+                }
+                state = _STATE_AFTER_VALUE;
+            }
+            break;
+
+            case _STATE_CONTAINER_START:
+            {
+                // Check Empty Object / Array
+                JsonFrame *pFrame = &(pCtx->pFrames[pCtx->frameCount - 1]);
+                pCurrChar = _skipSpace( pCurrChar, pInputEnd );
+                if( pCurrChar == pInputEnd && partial ) { goto suspend; }
+                if( _peekChar(pCurrChar, pInputEnd) == ((pFrame->type == TYPE_OBJECT) ? '}' : ']') ) {
+                    if( pCtx->pLazyDocument ) { _closeLazyContainer( pCtx, pCurrChar ); }
+                    pCurrChar++;
+                    _closeFrame( pCtx, &value ); // no allocation
+                    state = _STATE_VALUE_DONE;
+                }
+                else {
+                    state = (pFrame->type == TYPE_OBJECT) ? _STATE_OBJECT_KEY : _STATE_VALUE;
+                }
+            }
+            break;
+
+            case _STATE_AFTER_VALUE:
+            {
+                // Check "," or "}" / "]"
+                JsonFrame *pFrame = &(pCtx->pFrames[pCtx->frameCount - 1]);
+                pCurrChar = _skipSpace( pCurrChar, pInputEnd );
+                if( pCurrChar == pInputEnd && partial ) { goto suspend; }
+                char token = _peekChar(pCurrChar, pInputEnd);
+                if( token == ',' ) {
+                    pCurrChar++;
+                    state = (pFrame->type == TYPE_OBJECT) ? _STATE_OBJECT_KEY : _STATE_VALUE;
+                }
+                else if( token == ((pFrame->type == TYPE_OBJECT) ? '}' : ']') ) {
+                    // Parsing Done
+                    if( pCtx->pLazyDocument ) { _closeLazyContainer( pCtx, pCurrChar ); }
+                    pCurrChar++;
+                    ret = _closeFrame( pCtx, &value );
+                    ptrEnd = pCurrChar;
+                    state = _STATE_VALUE_DONE;
+                }
+                else {
+                    ptrEnd = pCurrChar;
+                    wrappingFrames = pCtx->frameCount - 1;
+                    if( pCurrChar == pInputEnd ) { ret = JPE_SYNTAX_ERROR_END; }
+                    else { ret = (pFrame->type == TYPE_OBJECT) ? JPE_SYNTAX_ERROR_OBJECT_COMMA : JPE_SYNTAX_ERROR_ARRAY_COMMA; }
+                }
+            }
+            break;
+
+            case _STATE_OBJECT_KEY:
+            {
+                // Get Key
+                JsonFrame *pFrame = &(pCtx->pFrames[pCtx->frameCount - 1]);
+                size_t keyLength = 0;
+                pCurrChar = _skipSpace( pCurrChar, pInputEnd );
+                if( partial && (pCurrChar == pInputEnd || !_isTokenComplete( pCtx, pCurrChar )) ) { goto suspend; }
+                if( pFrame->select != _SELECT_ALL ) {
+                    // Projection: a key without escapes is matched as it is, and only decoded if its member is kept
+                    const char *pKeyEnd = (_peekChar(pCurrChar, pInputEnd) == '"') ? _skipString( pCurrChar, pInputEnd ) : (const char *)0;
+                    if( pKeyEnd && !memchr( pCurrChar + 1, '\\', (size_t)(pKeyEnd - pCurrChar - 2) ) ) {
+                        pFrame->next = _selectMember( pCtx, pFrame->select, pCurrChar + 1, (size_t)(pKeyEnd - pCurrChar - 2) );
+                        if( pFrame->next == _SELECT_SKIP ) {
+                            pCurrChar = pKeyEnd;
+                            state = _STATE_OBJECT_COLON;
+                            break;
+                        }
+                    }
+                    else {
+                        pFrame->next = _SELECT_SKIP; // (decided once it is decoded)
+                    }
+                }
+                ret = _getString( pCtx, &(pFrame->key), &keyLength, &(pFrame->keyHash), pCurrChar, &ptrEnd );
+                wrappingFrames = pCtx->frameCount - 1;
+                if( ret != JPE_NO_ERROR ) {
+                    pFrame->key = (char *)0;
+                    // String Parse Error -> No String for Key
+                    if( ret != JPE_OUT_OF_MEMORY ) { ret = JPE_SYNTAX_ERROR_OBJECT_KEY; }
+                    break;
+                }
+                if( pFrame->select != _SELECT_ALL && pFrame->next == _SELECT_SKIP ) {
+                    pFrame->next = _selectMember( pCtx, pFrame->select, pFrame->key, keyLength );
+                    if( pFrame->next == _SELECT_SKIP ) {
+                        _freeMemory( pCtx, pFrame->key );
+                        pFrame->key = (char *)0;
+                        pCurrChar = ptrEnd;
+                        state = _STATE_OBJECT_COLON;
+                        break;
+                    }
+                }
+                _countKey( pCtx, keyLength );
+                if( pCtx->pHandler ) {
+                    const char *key = pFrame->key;
+                    pFrame->key = (char *)0; // borrowed
+                    if( pCtx->pHandler->key && pCtx->pHandler->key( pCtx->pUserData, key, keyLength ) ) {
+                        ret = JPE_CANCELLED;
+                        break;
+                    }
+                }
+                pFrame->keyLength = (uint32_t)keyLength;
+                pCurrChar = ptrEnd;
+                state = _STATE_OBJECT_COLON;
+            }
+            break;
+
+            case _STATE_OBJECT_COLON:
+            {
+                pCurrChar = _skipSpace( pCurrChar, pInputEnd );
+                if( pCurrChar == pInputEnd && partial ) { goto suspend; }
+                if( _peekChar(pCurrChar, pInputEnd) != ':' ) {
+                    ptrEnd = pCurrChar;
+                    wrappingFrames = pCtx->frameCount - 1;
+                    ret = (pCurrChar == pInputEnd) ? JPE_SYNTAX_ERROR_END : JPE_SYNTAX_ERROR_OBJECT_COLON;
+                    break;
+                }
+                pCurrChar++;
+                state = _STATE_VALUE;
+            }
+            break;
+
+            default: break;
+        }
+    }
+
+    if( ret != JPE_NO_ERROR ) {
+        // Errors inside containers are reported by the outermost one
+        if( wrappingFrames > 0 && ret != JPE_SYNTAX_ERROR_END && ret > JPE_NO_ERROR ) {
+            ret = (pCtx->pFrames[0].type == TYPE_OBJECT) ? JPE_SYNTAX_ERROR_OBJECT : JPE_SYNTAX_ERROR_ARRAY;
+        }
+        _releaseFrames( pCtx );
+    }
+
+    *pState = state;
+    *ppEnd = (ret == JPE_NO_ERROR) ? pCurrChar : ptrEnd;
+    return ret;
+
+suspend: // (pCurrChar: the first byte that was not consumed)
+    *pState = state;
+    *ppEnd = pCurrChar;
+    return JPE_NO_ERROR;
+}
+
+JsonParsingError parseValue(JsonParserContext *pCtx, const char *pCurrChar, const char **ppEnd, Element *pElement)
+{
+    _ParserState state = _STATE_VALUE;
+    return _runParser( pCtx, &state, pCurrChar, ppEnd, pElement );
+}
+
+//
+// Two-Stage Parsing (JSON_PARSE_TWO_STAGE)
+// ** Stage 1 classifies 64 bytes at a time into bit masks: quotes not escaped by a backslash delimit strings
+//    (prefix XOR of the quote bits), and outside of strings it records the positions of brackets, ':' and ','
+//    and of the first byte of every other token (after a whitespace or one of those).
+// ** Stage 2 walks the positions instead of the bytes: whitespace is never looked at again.
+// ** Any error in either stage returns JPE_SYNTAX_ERROR and the caller parses again with the engine,
+//    which reports it exactly as usual (nodes allocated in an arena by the failed attempt stay there).
+//
+#define _STRUCTURAL_BLOCK 64
+
+// Bit masks of one block (bit i: byte i)
+typedef struct
+{
+    uint64_t quote;     // '"'
+    uint64_t backslash; // '\\'
+    uint64_t op;        // '{' '}' '[' ']' ':' ','
+    uint64_t space;     // JSON whitespace
+} _BlockMasks;
+
+static void _classifyBlock(const char *pBlock, _BlockMasks *pMasks)
+{
+#if defined(__AVX2__) || defined(__SSE2__)
+    pMasks->quote = pMasks->backslash = pMasks->op = pMasks->space = 0;
+    for( int i = 0; i < _STRUCTURAL_BLOCK; i += _SCAN_BLOCK ) {
+        _ScanBlock block = _loadBlock( pBlock + i );
+        _ScanBlock folded = _orBlock( block, _set1Block(0x20) ); // '[' -> '{', ']' -> '}'
+        _ScanBlock op = _orBlock( _orBlock( _cmpeqBlock( folded, _set1Block('{') ), _cmpeqBlock( folded, _set1Block('}') ) ),
+                                  _orBlock( _cmpeqBlock( block, _set1Block(':') ), _cmpeqBlock( block, _set1Block(',') ) ) );
+        pMasks->quote     |= (uint64_t)_maskBlock( _cmpeqBlock( block, _set1Block('"') ) ) << i;
+        pMasks->backslash |= (uint64_t)_maskBlock( _cmpeqBlock( block, _set1Block('\\') ) ) << i;
+        pMasks->op        |= (uint64_t)_maskBlock( op ) << i;
+        pMasks->space     |= (uint64_t)(~_nonSpaceMask( block ) & _FULL_MASK) << i;
+    }
+#else
+    pMasks->quote = pMasks->backslash = pMasks->op = pMasks->space = 0;
+    for( int i = 0; i < _STRUCTURAL_BLOCK; i++ ) {
+        uint64_t bit = 1ull << i;
+        switch( pBlock[i] ) {
+            case '"':  pMasks->quote |= bit; break;
+            case '\\': pMasks->backslash |= bit; break;
+            case '{': case '}': case '[': case ']': case ':': case ',': pMasks->op |= bit; break;
+            case ' ': case '\t': case '\n': case '\r': pMasks->space |= bit; break;
+            default: break;
+        }
+    }
+#endif
+}
+
+// Bytes escaped by a backslash (the byte after an odd-length run of backslashes)
+// ** *pPrevEscaped: the previous block ended with an odd-length run (its first byte is escaped)
+static inline uint64_t _escapedMask(uint64_t backslash, uint64_t *pPrevEscaped)
+{
+    const uint64_t evenBits = 0x5555555555555555ull;
+    uint64_t startEdges = backslash & ~(backslash << 1);
+    uint64_t evenStartMask = evenBits ^ *pPrevEscaped;
+    uint64_t evenStarts = startEdges & evenStartMask;
+    uint64_t oddStarts = startEdges & ~evenStartMask;
+    uint64_t evenCarries = backslash + evenStarts;
+    uint64_t oddCarries = backslash + oddStarts;
+    uint64_t endsOdd = (oddCarries < backslash); // the run starting at an odd bit goes past this block
+    oddCarries |= *pPrevEscaped;
+    *pPrevEscaped = endsOdd;
+    return ((evenCarries & ~backslash) & ~evenBits) | ((oddCarries & ~backslash) & evenBits);
+}
+
+// Bit i: XOR of bits 0 .. i
+static inline uint64_t _prefixXor(uint64_t bits)
+{
+#if defined(__PCLMUL__)
+    return (uint64_t)_mm_cvtsi128_si64( _mm_clmulepi64_si128( _mm_set_epi64x( 0, (long long)bits ), _mm_set1_epi8( (char)0xFF ), 0 ) );
+#else
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+#endif
+}
+
+// Stage 1: positions of the structural bytes of data[0 .. length-1] (length <= UINT32_MAX)
+static JsonParsingError _buildStructuralIndex(const JsonAllocator *pAllocator, const char *data, size_t length, uint32_t **ppIndex, size_t *pIndexCount)
+{
+    uint64_t prevEscaped = 0;  // the next byte is escaped
+    uint64_t prevInString = 0; // all ones: the next byte is in a string
+    uint64_t prevSeparator = 1; // the next byte follows whitespace or an operator (or starts the input)
+    uint32_t *pIndex = (uint32_t *)0;
+    size_t count = 0, capacity = 0;
+
+    for( size_t offset = 0; offset < length; offset += _STRUCTURAL_BLOCK ) {
+        char tail[_STRUCTURAL_BLOCK];
+        const char *pBlock = data + offset;
+        if( length - offset < _STRUCTURAL_BLOCK ) { // pad the last block with spaces
+            memset( tail, ' ', _STRUCTURAL_BLOCK );
+            memcpy( tail, pBlock, length - offset );
+            pBlock = tail;
+        }
+
+        if( capacity - count < _STRUCTURAL_BLOCK ) {
+            size_t newCapacity = capacity ? capacity * 2 : (length / 8 + _STRUCTURAL_BLOCK);
+            uint32_t *pNewIndex = (uint32_t *)_reallocWith( pAllocator, pIndex, newCapacity * sizeof(uint32_t) );
+            if( !pNewIndex ) {
+                _freeWith( pAllocator, pIndex );
+                return JPE_OUT_OF_MEMORY;
+            }
+            pIndex = pNewIndex;
+            capacity = newCapacity;
+        }
+
+        _BlockMasks masks;
+        _classifyBlock( pBlock, &masks );
+
+        uint64_t quote = masks.quote & ~_escapedMask( masks.backslash, &prevEscaped );
+        uint64_t inString = _prefixXor( quote ) ^ prevInString; // opening quote .. before the closing quote
+        prevInString = (uint64_t)((int64_t)inString >> 63);
+
+        uint64_t op = masks.op & ~inString;
+        uint64_t separator = masks.space | op;
+        uint64_t tokenStart = ~(separator | inString | quote) & ((separator << 1) | prevSeparator);
+        prevSeparator = separator >> 63;
+
+        // Extract positions 4 at a time (writing up to 3 past the last one: there is room for a whole block)
+        uint64_t structural = op | (quote & inString) | tokenStart;
+        uint32_t *pOut = pIndex + count;
+        count += (size_t)__builtin_popcountll( structural );
+        while( structural ) {
+            pOut[0] = (uint32_t)offset + (uint32_t)__builtin_ctzll( structural ); structural &= structural - 1;
+            pOut[1] = (uint32_t)offset + (uint32_t)__builtin_ctzll( structural | (1ull << 63) ); structural &= structural - 1;
+            pOut[2] = (uint32_t)offset + (uint32_t)__builtin_ctzll( structural | (1ull << 63) ); structural &= structural - 1;
+            pOut[3] = (uint32_t)offset + (uint32_t)__builtin_ctzll( structural | (1ull << 63) ); structural &= structural - 1;
+            pOut += 4;
+        }
+    }
+
+    if( prevInString ) { // unterminated string
+        _freeWith( pAllocator, pIndex );
+        return JPE_SYNTAX_ERROR;
+    }
+    *ppIndex = pIndex;
+    *pIndexCount = count;
+    return JPE_NO_ERROR;
+}
+
+// Stage 2: the root value from the structural index
+static JsonParsingError _walkStructuralIndex(JsonParserContext *pCtx, const char *data, const uint32_t *pIndex, size_t indexCount, const char **ppEnd, Element *pElement)
+{
+    const char *pInputEnd = pCtx->pInputEnd;
+    const uint32_t *pIndexEnd = pIndex + indexCount;
+    const char *pCurrChar = data;
+    const char *ptrEnd = (const char *)0;
+    JsonParsingError ret = JPE_NO_ERROR;
+    Element value = { .type = TYPE_NULL, };
+    _ParserState state = _STATE_VALUE;
+
+// A token ends at the next structural byte or a whitespace (the next non-whitespace is structural)
+#define _endsToken(p) ( (p) == pInputEnd || _isSpace(*(p)) || (pIndex < pIndexEnd && (p) == data + *pIndex) )
+
+    while( state != _STATE_DONE && ret == JPE_NO_ERROR )
+    {
+        const char *pToken = (pIndex < pIndexEnd) ? data + *pIndex : (const char *)0;
+        switch( state )
+        {
+            case _STATE_VALUE:
+            {
+                if( !pToken ) { ret = JPE_SYNTAX_ERROR; break; }
+                pIndex++;
+                if( *pToken == '{' || *pToken == '[' ) {
+                    if( pCtx->frameCount >= pCtx->maxDepth || !_pushFrame( pCtx, (*pToken == '{') ? TYPE_OBJECT : TYPE_ARRAY ) ) {
+                        ret = JPE_SYNTAX_ERROR;
+                        break;
+                    }
+                    state = _STATE_CONTAINER_START;
+                    break;
+                }
+                ret = _parseScalar( pCtx, pToken, &ptrEnd, &value );
+                if( ret == JPE_NO_ERROR && !_endsToken(ptrEnd) ) {
+                    _releaseElement( pCtx, &value );
+                    ret = JPE_SYNTAX_ERROR;
+                }
+                pCurrChar = ptrEnd;
+                state = _STATE_VALUE_DONE;
+            }
+            break;
+
+            case _STATE_VALUE_DONE:
+            {
+                if( pCtx->frameCount == 0 ) { // Root Value
+                    *pElement = value;
+                    state = _STATE_DONE;
+                    break;
+                }
+
+                JsonFrame *pFrame = &(pCtx->pFrames[pCtx->frameCount - 1]);
+                int pushed;
+                if( pFrame->type == TYPE_OBJECT ) {
+                    ObjectNode member = { .element = value, .key = pFrame->key, .keyLength = pFrame->keyLength, .keyHash = pFrame->keyHash, };
+                    pushed = _pushStack( pCtx, &member, sizeof(ObjectNode) );
+                    if( pushed ) { pFrame->key = (char *)0; }
+                }
+                else {
+                    pushed = _pushStack( pCtx, &value, sizeof(Element) );
+                }
+                if( !pushed ) {
+                    _releaseElement( pCtx, &value );
+                    ret = JPE_OUT_OF_MEMORY;
+                    break;
+                }
+                state = _STATE_AFTER_VALUE;
+            }
+            break;
+
+            case _STATE_CONTAINER_START:
+            case _STATE_AFTER_VALUE:
+            {
+                JsonFrame *pFrame = &(pCtx->pFrames[pCtx->frameCount - 1]);
+                char closing = (pFrame->type == TYPE_OBJECT) ? '}' : ']';
+                if( pToken && *pToken == closing ) {
+                    pIndex++;
+                    pCurrChar = pToken + 1;
+                    ret = _closeFrame( pCtx, &value );
+                    state = _STATE_VALUE_DONE;
+                }
+                else if( state == _STATE_AFTER_VALUE && !(pToken && *pToken == ',') ) {
+                    ret = JPE_SYNTAX_ERROR;
+                }
+                else {
+                    if( state == _STATE_AFTER_VALUE ) { pIndex++; }
+                    state = (pFrame->type == TYPE_OBJECT) ? _STATE_OBJECT_KEY : _STATE_VALUE;
+                }
+            }
+            break;
+
+            case _STATE_OBJECT_KEY:
+            {
+                JsonFrame *pFrame = &(pCtx->pFrames[pCtx->frameCount - 1]);
+                size_t keyLength = 0;
+                if( !pToken || *pToken != '"' ) { ret = JPE_SYNTAX_ERROR; break; }
+                pIndex++;
+                ret = _getString( pCtx, &(pFrame->key), &keyLength, &(pFrame->keyHash), pToken, &ptrEnd );
+                if( ret != JPE_NO_ERROR ) {
+                    pFrame->key = (char *)0;
+                    break;
+                }
+                _countKey( pCtx, keyLength );
+                pFrame->keyLength = (uint32_t)keyLength;
+                if( !_endsToken(ptrEnd) || pIndex == pIndexEnd || data[*pIndex] != ':' ) { // (the key is released with the frame)
+                    ret = JPE_SYNTAX_ERROR;
+                    break;
+                }
+                pIndex++;
+                state = _STATE_VALUE;
+            }
+            break;
+
+            default: break;
+        }
+    }
+#undef _endsToken
+
+    if( ret != JPE_NO_ERROR ) {
+        _releaseFrames( pCtx );
+    }
+    *ppEnd = pCurrChar;
+    return ret;
+}
+
+static JsonParsingError _parseTwoStage(JsonParserContext *pCtx, const char *data, size_t length, const char **ppEnd, Element *pElement)
+{
+    uint32_t *pIndex = (uint32_t *)0;
+    size_t indexCount = 0;
+    if( length > UINT32_MAX ) { return JPE_SYNTAX_ERROR; }
+
+    uint64_t start = pCtx->pStats ? _nanoseconds() : 0;
+    JsonParsingError ret = _buildStructuralIndex( pCtx->pAllocator, data, length, &pIndex, &indexCount );
+    if( pCtx->pStats ) { pCtx->pStats->indexNanoseconds += _nanoseconds() - start; }
+    if( ret == JPE_NO_ERROR ) {
+        ret = _walkStructuralIndex( pCtx, data, pIndex, indexCount, ppEnd, pElement );
+    }
+    _freeWith( pCtx->pAllocator, pIndex );
+    return ret;
+}
+
+//
+// Parallel Root Array
+// ** A quote-aware pre-scan (stage 1 masks, see Two-Stage Parsing) finds ',' between elements of the root array
+//    about a chunk apart: the nesting depth of a block is counted with popcounts, and only blocks past a split target
+//    are walked bit by bit.
+// ** Workers take chunks from a shared counter and parse their elements with the engine (one context and arena each).
+//    A chunk has to end exactly at its split ',': otherwise the pre-scan was misled by an invalid document
+//    and it is parsed again from the start, serially.
+// ** Chunks are spliced in order; lines / columns of each chunk are counted by its worker and summed up.
+//
+#ifndef JSON_PARALLEL_CHUNK_SIZE
+#define JSON_PARALLEL_CHUNK_SIZE (1024 * 1024) // minimum bytes of a chunk
+#endif
+#define _JSON_CHUNKS_PER_THREAD 4 // so that a slow chunk does not keep the other threads waiting
+
+// Bit masks of one block for the nesting depth (bit i: byte i)
+typedef struct
+{
+    uint64_t quote;     // '"'
+    uint64_t backslash; // '\\'
+    uint64_t open;      // '{' '['
+    uint64_t close;     // '}' ']'
+    uint64_t comma;     // ','
+} _NestingMasks;
+
+static void _classifyNesting(const char *pBlock, _NestingMasks *pMasks)
+{
+    pMasks->quote = pMasks->backslash = pMasks->open = pMasks->close = pMasks->comma = 0;
+#if defined(__AVX2__) || defined(__SSE2__)
+    for( int i = 0; i < _STRUCTURAL_BLOCK; i += _SCAN_BLOCK ) {
+        _ScanBlock block = _loadBlock( pBlock + i );
+        _ScanBlock folded = _orBlock( block, _set1Block(0x20) ); // '[' -> '{', ']' -> '}'
+        pMasks->quote     |= (uint64_t)_maskBlock( _cmpeqBlock( block, _set1Block('"') ) ) << i;
+        pMasks->backslash |= (uint64_t)_maskBlock( _cmpeqBlock( block, _set1Block('\\') ) ) << i;
+        pMasks->open      |= (uint64_t)_maskBlock( _cmpeqBlock( folded, _set1Block('{') ) ) << i;
+        pMasks->close     |= (uint64_t)_maskBlock( _cmpeqBlock( folded, _set1Block('}') ) ) << i;
+        pMasks->comma     |= (uint64_t)_maskBlock( _cmpeqBlock( block, _set1Block(',') ) ) << i;
+    }
+#else
+    for( int i = 0; i < _STRUCTURAL_BLOCK; i++ ) {
+        uint64_t bit = 1ull << i;
+        switch( pBlock[i] ) {
+            case '"':  pMasks->quote |= bit; break;
+            case '\\': pMasks->backslash |= bit; break;
+            case '{': case '[': pMasks->open |= bit; break;
+            case '}': case ']': pMasks->close |= bit; break;
+            case ',':  pMasks->comma |= bit; break;
+            default: break;
+        }
+    }
+#endif
+}
+
+// Split points of the root array (data starts with its '[' after whitespace): ',' at depth 1, at least chunkSize bytes apart
+// ** Returns the number of split points stored in ppSplits (at most maxSplits)
+static size_t _splitRootArray(const char *data, size_t length, size_t chunkSize, const char **ppSplits, size_t maxSplits)
+{
+    uint64_t prevEscaped = 0;  // the next byte is escaped
+    uint64_t prevInString = 0; // all ones: the next byte is in a string
+    int64_t depth = 0;         // the root array is depth 1
+    size_t target = chunkSize; // the next split point is the first ',' at depth 1 from here
+    size_t count = 0;
+
+    for( size_t offset = 0; offset < length; offset += _STRUCTURAL_BLOCK ) {
+        char tail[_STRUCTURAL_BLOCK];
+        const char *pBlock = data + offset;
+        if( length - offset < _STRUCTURAL_BLOCK ) { // pad the last block with spaces
+            memset( tail, ' ', _STRUCTURAL_BLOCK );
+            memcpy( tail, pBlock, length - offset );
+            pBlock = tail;
+        }
+
+        _NestingMasks masks;
+        _classifyNesting( pBlock, &masks );
+
+        uint64_t quote = masks.quote & ~_escapedMask( masks.backslash, &prevEscaped );
+        uint64_t inString = _prefixXor( quote ) ^ prevInString;
+        prevInString = (uint64_t)((int64_t)inString >> 63);
+
+        uint64_t open = masks.open & ~inString;
+        uint64_t close = masks.close & ~inString;
+        if( offset + _STRUCTURAL_BLOCK <= target ) { // no split point in this block
+            depth += __builtin_popcountll( open ) - __builtin_popcountll( close );
+            continue;
+        }
+
+        uint64_t structural = open | close | (masks.comma & ~inString);
+        while( structural ) {
+            int i = __builtin_ctzll( structural );
+            uint64_t bit = 1ull << i;
+            structural &= structural - 1;
+            if( open & bit ) { depth++; }
+            else if( close & bit ) {
+                if( --depth <= 0 ) { return count; } // the end of the root array
+            }
+            else if( depth == 1 && offset + i >= target ) {
+                ppSplits[count++] = data + offset + i;
+                if( count == maxSplits ) { return count; }
+                target = offset + i + chunkSize;
+            }
+        }
+    }
+    return count;
+}
+
+// One past the closing quote of the string at pCurrChar, `NULL` if it is not terminated (nothing is decoded)
+static const char *_skipString(const char *pCurrChar, const char *pInputEnd)
+{
+    const char *pQuote = pCurrChar;
+    for( ;; ) {
+        pQuote = (const char *)memchr( pQuote + 1, '"', (size_t)(pInputEnd - pQuote - 1) );
+        if( !pQuote ) { return (const char *)0; }
+
+        // Escaped by an odd-length run of backslashes?
+        const char *pBackslash = pQuote;
+        while( pBackslash - 1 > pCurrChar && pBackslash[-1] == '\\' ) { pBackslash--; }
+        if( ((pQuote - pBackslash) & 1) == 0 ) { return pQuote + 1; }
+    }
+}
+
+// Projection: one past the value at pCurrChar, without making it (containers are matched with the nesting masks)
+// ** Only the end is looked for: unterminated strings / containers are JPE_SYNTAX_ERROR_END (at the end of the input),
+//    a byte that can not start a value is JPE_SYNTAX_ERROR (at it); nothing else is checked.
+static const char *_skipValue(const char *pCurrChar, const char *pInputEnd, JsonParsingError *pError)
+{
+    if( *pCurrChar == '"' ) {
+        const char *pEnd = _skipString( pCurrChar, pInputEnd );
+        if( !pEnd ) { *pError = JPE_SYNTAX_ERROR_END; return pInputEnd; }
+        return pEnd;
+    }
+    if( *pCurrChar != '{' && *pCurrChar != '[' ) {
+        const char *pEnd = pCurrChar;
+        while( pEnd < pInputEnd && _isLiteralChar(*pEnd) ) { pEnd++; }
+        if( pEnd == pCurrChar ) { *pError = JPE_SYNTAX_ERROR; }
+        return pEnd;
+    }
+
+    uint64_t prevEscaped = 0;
+    uint64_t prevInString = 0;
+    int64_t depth = 0;
+    size_t length = (size_t)(pInputEnd - pCurrChar);
+    for( size_t offset = 0; offset < length; offset += _STRUCTURAL_BLOCK ) {
+        char tail[_STRUCTURAL_BLOCK];
+        const char *pBlock = pCurrChar + offset;
+        if( length - offset < _STRUCTURAL_BLOCK ) { // pad the last block with spaces
+            memset( tail, ' ', _STRUCTURAL_BLOCK );
+            memcpy( tail, pBlock, length - offset );
+            pBlock = tail;
+        }
+
+        _NestingMasks masks;
+        _classifyNesting( pBlock, &masks );
+
+        uint64_t quote = masks.quote & ~_escapedMask( masks.backslash, &prevEscaped );
+        uint64_t inString = _prefixXor( quote ) ^ prevInString;
+        prevInString = (uint64_t)((int64_t)inString >> 63);
+
+        uint64_t open = masks.open & ~inString;
+        uint64_t close = masks.close & ~inString;
+        if( depth > __builtin_popcountll( close ) ) { // it does not end in this block
+            depth += __builtin_popcountll( open ) - __builtin_popcountll( close );
+            continue;
+        }
+
+        uint64_t brackets = open | close;
+        while( brackets ) {
+            int i = __builtin_ctzll( brackets );
+            brackets &= brackets - 1;
+            if( open & (1ull << i) ) { depth++; }
+            else if( --depth == 0 ) { return pCurrChar + offset + i + 1; }
+        }
+    }
+    *pError = JPE_SYNTAX_ERROR_END;
+    return pInputEnd;
+}
+
+typedef struct
+{
+    const char      *pFrom;     // lines / columns are counted from here (the first chunk: the start of the input)
+    const char      *begin;     // its first element (after the split ',')
+    const char      *end;       // its split ',' (the last chunk: the end of the input)
+    Element         *items;     // its elements (moved into the root array)
+    size_t           count;
+    size_t           capacity;
+    JsonParsingError error;
+    const char      *pStop;     // the error, or one past the ']' of the root array
+    int              closed;    // the root array ended in this chunk
+    int              misplit;   // an element ran past the split ',' (the pre-scan was misled)
+    size_t           lines;     // newlines in [pFrom, end]
+    size_t           columns;   //     columns after the last one (or in all of it if there is none)
+} _ArrayChunk;
+
+typedef struct
+{
+    _ArrayChunk            *pChunks;
+    size_t                  chunkCount;
+    const JsonParseOptions *pOptions;
+    const char             *pInputEnd;
+    size_t                  maxDepth;  // of the document (the root array is one level)
+#if _HAVE_PTHREAD_
+    atomic_size_t           nextChunk;
+#else
+    size_t                  nextChunk;
+#endif
+} _ParallelArrayJob;
+
+typedef struct
+{
+    _ParallelArrayJob *pJob;
+    JsonArena          arena; // the caller's arena is not thread-safe: merged into it at the end
+    JsonParseStats     stats; // added to the caller's at the end
+} _ParallelArrayWorker;
+
+// Parse the elements of one chunk as the engine does them inside the root array
+static void _parseArrayChunk(JsonParserContext *pCtx, _ArrayChunk *pChunk, int isLast)
+{
+    const char *pInputEnd = pCtx->pInputEnd;
+    const char *pCurrChar = pChunk->begin;
+
+    for( ;; ) {
+        Element value;
+        const char *pEnd = (const char *)0;
+        JsonParsingError ret = parseValue( pCtx, pCurrChar, &pEnd, &value );
+        if( ret == JPE_NO_ERROR && pChunk->count == pChunk->capacity ) {
+            size_t newCapacity = pChunk->capacity ? pChunk->capacity * 2 : 256;
+            Element *pNewItems = (Element *)_reallocWith( pCtx->pAllocator, pChunk->items, newCapacity * sizeof(Element) );
+            if( !pNewItems ) {
+                _releaseElement( pCtx, &value );
+                ret = JPE_OUT_OF_MEMORY;
+            }
+            else {
+                pChunk->items = pNewItems;
+                pChunk->capacity = newCapacity;
+            }
+        }
+        if( ret != JPE_NO_ERROR ) {
+            // Wrapped by the root array
+            if( ret > JPE_NO_ERROR && ret != JPE_SYNTAX_ERROR_END ) { ret = JPE_SYNTAX_ERROR_ARRAY; }
+            pChunk->error = ret;
+            pChunk->pStop = pEnd;
+            return;
+        }
+        pChunk->items[pChunk->count++] = value;
+
+        // Check "," or "]"
+        pCurrChar = _skipSpace( pEnd, pInputEnd );
+        if( !isLast && pCurrChar >= pChunk->end ) {
+            if( pCurrChar == pChunk->end ) { break; }
+            pChunk->misplit = 1;
+            return;
+        }
+        char token = _peekChar(pCurrChar, pInputEnd);
+        if( token == ',' ) {
+            pCurrChar++;
+        }
+        else if( token == ']' ) {
+            pChunk->closed = 1;
+            pChunk->pStop = pCurrChar + 1;
+            return;
+        }
+        else {
+            pChunk->error = (pCurrChar == pInputEnd) ? JPE_SYNTAX_ERROR_END : JPE_SYNTAX_ERROR_ARRAY_COMMA;
+            pChunk->pStop = pCurrChar;
+            return;
+        }
+    }
+
+    _countLocation( &(pChunk->lines), &(pChunk->columns), pChunk->pFrom, pChunk->end + 1 );
+}
+
+static void *_parallelArrayWorker(void *pArg)
+{
+    _ParallelArrayWorker *pWorker = (_ParallelArrayWorker *)pArg;
+    _ParallelArrayJob *pJob = pWorker->pJob;
+    JsonParseOptions options = *(pJob->pOptions);
+    options.pArena = options.pArena ? &(pWorker->arena) : (JsonArena *)0;
+    options.pStats = options.pStats ? &(pWorker->stats) : (JsonParseStats *)0;
+
+    JsonParserContext ctx = { .pArena = (JsonArena *)0, };
+    _setupOptions( &ctx, &options ); // (checked by parseJsonArrayParallel())
+    ctx.pInputEnd = pJob->pInputEnd;
+    ctx.maxDepth = pJob->maxDepth - 1; // inside the root array
+    uint64_t start = ctx.pStats ? _nanoseconds() : 0;
+
+    for( ;; ) {
+    #if _HAVE_PTHREAD_
+        size_t index = atomic_fetch_add( &(pJob->nextChunk), 1 );
+    #else
+        size_t index = pJob->nextChunk++;
+    #endif
+        if( index >= pJob->chunkCount ) { break; }
+        _parseArrayChunk( &ctx, &(pJob->pChunks[index]), index + 1 == pJob->chunkCount );
+    }
+
+    if( ctx.pStats ) { ctx.pStats->parseNanoseconds = _nanoseconds() - start; }
+    _releaseContext( &ctx );
+    return (void *)0;
+}
+
+// Parse the chunks of the root array; returns 0 if the document has to be parsed serially
+static int _parseArrayChunks(JsonParserContext *pCtx, Element *pOutElement, const char *data, size_t length,
+                             _ParallelArrayJob *pJob, unsigned int threadCount, JsonParsingError *pError, JsonErrorInfo* pOutErrorInfo)
+{
+    const char *pInputEnd = data + length;
+    _ParallelArrayWorker *pWorkers = (_ParallelArrayWorker *)_callocWith( pCtx->pAllocator, threadCount * sizeof(_ParallelArrayWorker) );
+    if( !pWorkers ) { return 0; }
+    for( unsigned int i = 0; i < threadCount; i++ ) {
+        pWorkers[i].pJob = pJob;
+        if( pCtx->pArena ) { initJsonArenaEx( &(pWorkers[i].arena), pCtx->pArena->chunkSize, pCtx->pArena->pAllocator ); }
+        else { initJsonArena( &(pWorkers[i].arena), 0 ); }
+    }
+    _runThreads( pCtx->pAllocator, _parallelArrayWorker, pWorkers, sizeof(_ParallelArrayWorker), threadCount );
+    JsonParseStats stats = { 0, };
+    for( unsigned int i = 0; i < threadCount; i++ ) {
+        if( pCtx->pArena ) { _mergeJsonArena( pCtx->pArena, &(pWorkers[i].arena) ); }
+        _mergeParseStats( &stats, &(pWorkers[i].stats) );
+    }
+    _freeWith( pCtx->pAllocator, pWorkers );
+
+    // The chunks up to the end of the root array (or the first error), in order
+    JsonParsingError ret = JPE_NO_ERROR;
+    size_t line = 1, column = 1, total = 0, last = 0;
+    for( ; last < pJob->chunkCount; last++ ) {
+        _ArrayChunk *pChunk = &(pJob->pChunks[last]);
+        if( pChunk->misplit ) { return 0; }
+        total += pChunk->count;
+        if( pChunk->error != JPE_NO_ERROR || pChunk->closed ) { break; }
+        if( pChunk->lines ) {
+            line += pChunk->lines;
+            column = pChunk->columns;
+        }
+        else {
+            column += pChunk->columns;
+        }
+    }
+
+    _ArrayChunk *pLast = &(pJob->pChunks[last]);
+    const char *pEnd = pLast->pStop;
+    ret = pLast->error;
+    if( ret == JPE_NO_ERROR ) {
+        const char *pCurrChar = _skipSpace( pEnd, pInputEnd );
+        if( pCurrChar != pInputEnd ) {
+            pEnd = pCurrChar;
+            ret = JPE_SYNTAX_ERROR;
+        }
+    }
+    if( pCtx->pStats ) {
+        // Values inside the root array (and of chunks past an error, they were parsed too)
+        stats.arrays++;
+        stats.maxDepth++;
+        stats.bytes = (ret == JPE_NO_ERROR || !pEnd) ? length : (size_t)(pEnd - data);
+        _mergeParseStats( pCtx->pStats, &stats );
+    }
+
+    // Splice the elements
+    Element *pItems = (Element *)0;
+    if( ret == JPE_NO_ERROR ) {
+        pItems = (total <= UINT32_MAX) ? (Element *)_allocMemory( pCtx, total * sizeof(Element) ) : (Element *)0;
+        if( !pItems ) { ret = JPE_OUT_OF_MEMORY; }
+    }
+    size_t copied = 0;
+    for( size_t i = 0; i < pJob->chunkCount; i++ ) {
+        _ArrayChunk *pChunk = &(pJob->pChunks[i]);
+        if( pItems && i <= last ) {
+            memcpy( pItems + copied, pChunk->items, pChunk->count * sizeof(Element) );
+            copied += pChunk->count;
+        }
+        else {
+            for( size_t j = 0; j < pChunk->count; j++ ) {
+                _releaseElement( pCtx, &(pChunk->items[j]) );
+            }
+        }
+        _freeWith( pCtx->pAllocator, pChunk->items );
+        pChunk->items = (Element *)0;
+        pChunk->count = 0;
+    }
+    if( pItems ) {
+        pOutElement->type = TYPE_ARRAY;
+        pOutElement->length = (uint32_t)total;
+        pOutElement->arrayValue = pItems;
+    }
+
+    if( pOutErrorInfo ) {
+        pOutErrorInfo->error = ret;
+        _locate( pOutErrorInfo, line, column, pLast->pFrom, pEnd, pInputEnd );
+        pOutErrorInfo->position = (size_t)(pEnd - data);
+    }
+    *pError = ret;
+    return 1;
+}
+
+JsonParsingError parseJsonArrayParallel(Element *pOutElement, const char *data, size_t length, const JsonParseOptions *pOptions, unsigned int threadCount, JsonErrorInfo* pOutErrorInfo)
+{
+    JsonParseOptions defaultOptions = { 0, };
+    if( !pOptions ) { pOptions = &defaultOptions; }
+
+    _resetParseStats( pOptions );
+    JsonParserContext ctx = { .pArena = (JsonArena *)0, };
+    if( !_setupOptions( &ctx, pOptions ) ) { return _errorWithoutLocation( pOutErrorInfo, JPE_INVALID_ARGUMENT ); }
+
+    // Serial: small documents, other root values, a shared key pool (not thread-safe) and projections
+    threadCount = _threadCount( threadCount );
+    size_t chunkSize = length / ((size_t)threadCount * _JSON_CHUNKS_PER_THREAD);
+    if( chunkSize < JSON_PARALLEL_CHUNK_SIZE ) { chunkSize = JSON_PARALLEL_CHUNK_SIZE; }
+    size_t maxDepth = pOptions->maxDepth ? pOptions->maxDepth : JSON_DEFAULT_MAX_DEPTH;
+    const char *pRoot = (pOutElement && data) ? _skipSpace( data, data + length ) : (const char *)0;
+    if( threadCount < 2 || length / 2 < chunkSize || !pRoot || _peekChar(pRoot, data + length) != '[' ||
+        maxDepth < 2 || pOptions->pKeyPool || ctx.ppPaths ) {
+        return _parseJson( &ctx, pOutElement, data, length, pOutErrorInfo );
+    }
+
+    JsonParseStats *pStats = ctx.pStats;
+    uint64_t start = pStats ? _nanoseconds() : 0;
+    size_t maxSplits = length / chunkSize; // (they are at least chunkSize bytes apart)
+    const char **ppSplits = (const char **)_mallocWith( ctx.pAllocator, maxSplits * sizeof(const char *) );
+    size_t splitCount = ppSplits ? _splitRootArray( data, length, chunkSize, ppSplits, maxSplits ) : 0;
+    if( pStats ) { pStats->indexNanoseconds = _nanoseconds() - start; }
+    _ArrayChunk *pChunks = splitCount ? (_ArrayChunk *)_callocWith( ctx.pAllocator, (splitCount + 1) * sizeof(_ArrayChunk) ) : (_ArrayChunk *)0;
+    JsonParsingError ret = JPE_NO_ERROR;
+    int done = 0;
+    if( pChunks ) {
+        for( size_t i = 0; i <= splitCount; i++ ) {
+            pChunks[i].pFrom = i ? ppSplits[i - 1] + 1 : data;
+            pChunks[i].begin = i ? ppSplits[i - 1] + 1 : pRoot + 1;
+            pChunks[i].end = (i < splitCount) ? ppSplits[i] : data + length;
+        }
+
+        _ParallelArrayJob job = { .pChunks = pChunks, .chunkCount = splitCount + 1, .pOptions = pOptions,
+                                  .pInputEnd = data + length, .maxDepth = maxDepth, };
+        if( threadCount > job.chunkCount ) { threadCount = (unsigned int)job.chunkCount; }
+        done = _parseArrayChunks( &ctx, pOutElement, data, length, &job, threadCount, &ret, pOutErrorInfo );
+
+        for( size_t i = 0; i <= splitCount; i++ ) { // (misplit)
+            for( size_t j = 0; j < pChunks[i].count; j++ ) {
+                _releaseElement( &ctx, &(pChunks[i].items[j]) );
+            }
+            _freeWith( ctx.pAllocator, pChunks[i].items );
+        }
+    }
+    _freeWith( ctx.pAllocator, pChunks );
+    _freeWith( ctx.pAllocator, ppSplits );
+
+    if( !done ) { ret = _parseJson( &ctx, pOutElement, data, length, pOutErrorInfo ); }
+    if( pStats ) { pStats->totalNanoseconds = _nanoseconds() - start; }
+    return ret;
+}
+
+//
+// Push Parser
+// ** The engine runs over every chunk as it arrives and suspends at its end: only the token
+//    split by the chunk boundary (if any) is kept in pBuffer, and the next chunk is appended to it.
+//
+struct tagJsonPushParser
+{
+    JsonParserContext ctx;
+    _ParserState      state;
+    Element           root;           // _STATE_DONE: the document, until jsonParserFinish() hands it out
+
+    // Unconsumed Input
+    char             *pBuffer;
+    size_t            bufferSize;
+    size_t            bufferCapacity;
+
+    // Location of pBuffer[0] in the whole input
+    size_t            position;
+    size_t            line;
+    size_t            column;
+
+    JsonErrorInfo     result;         // the error (sticky), or the end of the root value
+    int               rootEndPending; // result is the end of the root value, but the byte after it is not counted yet
+    int               fed;            // any byte has been fed
+};
+
+JsonPushParser *createJsonPushParser(const JsonParseOptions *pOptions)
+{
+    JsonParseOptions defaultOptions = { 0, };
+    if( !pOptions ) { pOptions = &defaultOptions; }
+    if( pOptions->flags & JSON_PARSE_ZERO_COPY ) { return (JsonPushParser *)0; } // chunks do not outlive jsonParserFeed()
+    if( pOptions->ppPaths && pOptions->pathCount ) { return (JsonPushParser *)0; } // values are not skipped across chunks
+
+    _resetParseStats( pOptions );
+    JsonPushParser *pParser = (JsonPushParser *)_callocWith( pOptions->pAllocator, sizeof(JsonPushParser) );
+    if( !pParser ) { return (JsonPushParser *)0; }
+    if( !_setupOptions( &(pParser->ctx), pOptions ) ) {
+        _freeWith( pOptions->pAllocator, pParser );
+        return (JsonPushParser *)0;
+    }
+    if( pParser->ctx.maxDepth == 0 ) { pParser->ctx.maxDepth = JSON_DEFAULT_MAX_DEPTH; }
+    pParser->ctx.flags |= _JSON_PARSE_PARTIAL;
+    pParser->state = _STATE_VALUE;
+    pParser->line = 1;
+    pParser->column = 1;
+    pParser->result.line = 1;
+    pParser->result.column = 1;
+    return pParser;
+}
+
+// Run the engine over pInput (the unconsumed input, located at pParser->position) and keep what it could not consume
+static void _pushParserStep(JsonPushParser *pParser, const char *pInput, size_t length)
+{
+    JsonParserContext *pCtx = &(pParser->ctx);
+    JsonParsingError ret = JPE_NO_ERROR;
+    const char *pEnd = pInput;
+
+    pCtx->pInputEnd = pInput + length;
+    if( pParser->rootEndPending && (length || !(pCtx->flags & _JSON_PARSE_PARTIAL)) ) {
+        // The byte after the root value is here (or the input ended there)
+        size_t position = pParser->result.position;
+        _locate( &(pParser->result), pParser->result.line, pParser->result.column, pInput, pInput, pCtx->pInputEnd );
+        pParser->result.position = position;
+        pParser->rootEndPending = 0;
+    }
+    if( pParser->state != _STATE_DONE ) {
+        uint64_t start = pCtx->pStats ? _nanoseconds() : 0;
+        ret = _runParser( pCtx, &(pParser->state), pInput, &pEnd, &(pParser->root) );
+        if( pCtx->pStats ) {
+            uint64_t elapsed = _nanoseconds() - start;
+            pCtx->pStats->parseNanoseconds += elapsed;
+            pCtx->pStats->totalNanoseconds += elapsed;
+        }
+        if( ret == JPE_NO_ERROR && pParser->state == _STATE_DONE ) {
+            if( pEnd == pCtx->pInputEnd && (pCtx->flags & _JSON_PARSE_PARTIAL) ) {
+                pParser->result.line = pParser->line;
+                pParser->result.column = pParser->column;
+                _countLocation( &(pParser->result.line), &(pParser->result.column), pInput, pEnd );
+                pParser->rootEndPending = 1;
+            }
+            else {
+                _locate( &(pParser->result), pParser->line, pParser->column, pInput, pEnd, pCtx->pInputEnd );
+            }
+            pParser->result.position = pParser->position + (size_t)(pEnd - pInput);
+        }
+    }
+    if( ret == JPE_NO_ERROR && pParser->state == _STATE_DONE ) {
+        // Only spaces may follow the root value
+        pEnd = _skipSpace( pEnd, pCtx->pInputEnd );
+        if( pEnd != pCtx->pInputEnd ) { ret = JPE_SYNTAX_ERROR; }
+    }
+    if( ret != JPE_NO_ERROR ) {
+        pParser->result.error = ret;
+        _locate( &(pParser->result), pParser->line, pParser->column, pInput, pEnd, pCtx->pInputEnd );
+        pParser->result.position += pParser->position;
+        return;
+    }
+
+    // Keep the rest (it is at most one token)
+    size_t restSize = (size_t)(pCtx->pInputEnd - pEnd);
+    _countLocation( &(pParser->line), &(pParser->column), pInput, pEnd );
+    pParser->position += (size_t)(pEnd - pInput);
+    if( restSize > pParser->bufferCapacity ) {
+        size_t newCapacity = pParser->bufferCapacity ? pParser->bufferCapacity : 256;
+        while( newCapacity < restSize ) { newCapacity *= 2; }
+        char *pNewBuffer = (char *)_mallocWith( pCtx->pAllocator, newCapacity );
+        if( !pNewBuffer ) {
+            pParser->result.error = JPE_OUT_OF_MEMORY;
+            return;
+        }
+        memcpy( pNewBuffer, pEnd, restSize );
+        _freeWith( pCtx->pAllocator, pParser->pBuffer );
+        pParser->pBuffer = pNewBuffer;
+        pParser->bufferCapacity = newCapacity;
+    }
+    else if( restSize && pEnd != pParser->pBuffer ) {
+        memmove( pParser->pBuffer, pEnd, restSize );
+    }
+    pParser->bufferSize = restSize;
+}
+
+JsonParsingError jsonParserFeed(JsonPushParser *pParser, const char *chunk, size_t length, JsonErrorInfo* pOutErrorInfo)
+{
+    if( pParser->result.error == JPE_NO_ERROR && length ) {
+        pParser->fed = 1;
+        if( pParser->bufferSize == 0 ) {
+            _pushParserStep( pParser, chunk, length );
+        }
+        else { // complete the pending token
+            if( pParser->bufferCapacity - pParser->bufferSize < length ) {
+                size_t newCapacity = pParser->bufferCapacity * 2;
+                if( newCapacity - pParser->bufferSize < length ) { newCapacity = pParser->bufferSize + length; }
+                char *pNewBuffer = (char *)_reallocWith( pParser->ctx.pAllocator, pParser->pBuffer, newCapacity );
+                if( !pNewBuffer ) {
+                    pParser->result.error = JPE_OUT_OF_MEMORY;
+                    if( pOutErrorInfo ) { *pOutErrorInfo = pParser->result; }
+                    return JPE_OUT_OF_MEMORY;
+                }
+                pParser->pBuffer = pNewBuffer;
+                pParser->bufferCapacity = newCapacity;
+            }
+            memcpy( pParser->pBuffer + pParser->bufferSize, chunk, length );
+            _pushParserStep( pParser, pParser->pBuffer, pParser->bufferSize + length );
+        }
+        if( pParser->ctx.pStats ) {
+            pParser->ctx.pStats->bytes = (pParser->result.error != JPE_NO_ERROR) ? pParser->result.position : pParser->position + pParser->bufferSize;
+        }
+    }
+
+    if( pParser->result.error != JPE_NO_ERROR && pOutErrorInfo ) { *pOutErrorInfo = pParser->result; }
+    return pParser->result.error;
+}
+
+JsonParsingError jsonParserFinish(JsonPushParser *pParser, Element *pOutElement, JsonErrorInfo* pOutErrorInfo)
+{
+    if( pParser->result.error == JPE_NO_ERROR && pParser->fed ) {
+        // The end of the input: the pending token (if any) is complete, and so is everything else or it is an error
+        pParser->ctx.flags &= ~_JSON_PARSE_PARTIAL;
+        _pushParserStep( pParser, pParser->bufferSize ? pParser->pBuffer : "", pParser->bufferSize );
+        if( pParser->result.error != JPE_NO_ERROR && pParser->ctx.pStats ) { pParser->ctx.pStats->bytes = pParser->result.position; }
+        _countWorkingBytes( &(pParser->ctx) );
+        if( pParser->result.error == JPE_NO_ERROR && pOutElement ) {
+            *pOutElement = pParser->root;
+            pParser->root.type = TYPE_NULL;
+        }
+    }
+
+    if( pOutErrorInfo ) { *pOutErrorInfo = pParser->result; }
+    return pParser->result.error;
+}
+
+void releaseJsonPushParser(JsonPushParser *pParser)
+{
+    if( !pParser ) { return; }
+
+    JsonParserContext *pCtx = &(pParser->ctx);
+    _releaseFrames( pCtx );
+    if( pParser->state == _STATE_DONE ) { _releaseElement( pCtx, &(pParser->root) ); } // not handed out
+    pCtx->pStats = (JsonParseStats *)0; // (counted by jsonParserFinish(), and may be gone)
+    _releaseContext( pCtx );
+    _freeWith( pCtx->pAllocator, pParser->pBuffer );
+    _freeWith( pCtx->pAllocator, pParser );
+}
+
+//
+// Lazy Document
+// ** openJsonLazyDocument() runs the engine in the event mode without callbacks (and without number conversion),
+//    recording where every object / array opens and closes. The first accessor reading a container walks data from there
+//    (a nested container is skipped in one lookup, a scalar by scanning its token) and records where its items start;
+//    later ones index that record. Values are decoded only by materializeLazyValue().
+//
+static const JsonSaxHandler _lazyEvents = { 0, };
+
+JsonParsingError openJsonLazyDocument(JsonLazyDocument *pDocument, const char *data, size_t length, JsonErrorInfo* pOutErrorInfo)
+{
+    return openJsonLazyDocumentEx( pDocument, data, length, (const JsonAllocator *)0, pOutErrorInfo );
+}
+
+JsonParsingError openJsonLazyDocumentEx(JsonLazyDocument *pDocument, const char *data, size_t length, const JsonAllocator *pAllocator, JsonErrorInfo* pOutErrorInfo)
+{
+    pDocument->pAllocator = pAllocator;
+    pDocument->data = data;
+    pDocument->length = data ? length : 0;
+    pDocument->containers = (struct tagJsonLazyContainer *)0;
+    pDocument->containerCount = 0;
+    pDocument->containerCapacity = 0;
+
+    JsonParserContext ctx = { .flags = _JSON_PARSE_VALIDATE, .pHandler = &_lazyEvents, .pLazyDocument = pDocument, .pAllocator = pAllocator, };
+    Element rootElement; // values are not stored
+    JsonParsingError ret = _parseJson( &ctx, &rootElement, data, length, pOutErrorInfo );
+    if( ret != JPE_NO_ERROR ) {
+        closeJsonLazyDocument( pDocument );
+    }
+    return ret;
+}
+
+void closeJsonLazyDocument(JsonLazyDocument *pDocument)
+{
+    for( size_t i = 0; i < pDocument->containerCount; i++ ) {
+        _freeWith( pDocument->pAllocator, pDocument->containers[i].pItems );
+    }
+    _freeWith( pDocument->pAllocator, pDocument->containers );
+    pDocument->data = (const char *)0;
+    pDocument->length = 0;
+    pDocument->containers = (struct tagJsonLazyContainer *)0;
+    pDocument->containerCount = 0;
+    pDocument->containerCapacity = 0;
+}
+
+// The container opening at `offset`
+static struct tagJsonLazyContainer *_lazyContainer(const JsonLazyDocument *pDocument, size_t offset)
+{
+    size_t low = 0, high = pDocument->containerCount; // containers are sorted by `open`
+    while( low < high ) {
+        size_t mid = low + (high - low) / 2;
+        if( pDocument->containers[mid].open < offset ) { low = mid + 1; }
+        else { high = mid; }
+    }
+    return &(pDocument->containers[low]);
+}
+
+// Offset of the closing bracket of the container opening at `offset`
+static size_t _lazyContainerEnd(const JsonLazyDocument *pDocument, size_t offset)
+{
+    return _lazyContainer( pDocument, offset )->close;
+}
+
+// First byte after the (valid) value at pCurrChar
+static const char *_skipLazyValue(const JsonLazyDocument *pDocument, const char *pCurrChar)
+{
+    const char *pInputEnd = pDocument->data + pDocument->length;
+    if( *pCurrChar == '{' || *pCurrChar == '[' ) {
+        return pDocument->data + _lazyContainerEnd( pDocument, (size_t)(pCurrChar - pDocument->data) ) + 1;
+    }
+    if( *pCurrChar == '"' ) {
+        for( pCurrChar++; ; pCurrChar += 2 ) { // (skip escapes)
+            pCurrChar = _scanString( pCurrChar, pInputEnd );
+            if( *pCurrChar == '"' ) { return pCurrChar + 1; }
+        }
+    }
+    while( pCurrChar < pInputEnd && _isLiteralChar(*pCurrChar) ) { pCurrChar++; }
+    return pCurrChar;
+}
+
+// First member (its key) / element of the container at pCurrChar, `NULL` if it is empty
+static const char *_firstLazyItem(const JsonLazyDocument *pDocument, const char *pCurrChar)
+{
+    pCurrChar = _skipSpace( pCurrChar + 1, pDocument->data + pDocument->length );
+    return (*pCurrChar == '}' || *pCurrChar == ']') ? (const char *)0 : pCurrChar;
+}
+
+// Value of the member whose key is at pCurrChar
+static const char *_lazyMemberValue(const JsonLazyDocument *pDocument, const char *pCurrChar)
+{
+    const char *pInputEnd = pDocument->data + pDocument->length;
+    pCurrChar = _skipSpace( _skipLazyValue( pDocument, pCurrChar ), pInputEnd ); // ':'
+    return _skipSpace( pCurrChar + 1, pInputEnd );
+}
+
+// Member / element after the one at pCurrChar, `NULL` at the end of the container
+static const char *_nextLazyItem(const JsonLazyDocument *pDocument, const char *pCurrChar, int isObject)
+{
+    const char *pInputEnd = pDocument->data + pDocument->length;
+    if( isObject ) { pCurrChar = _lazyMemberValue( pDocument, pCurrChar ); }
+    pCurrChar = _skipSpace( _skipLazyValue( pDocument, pCurrChar ), pInputEnd );
+    return (*pCurrChar == ',') ? _skipSpace( pCurrChar + 1, pInputEnd ) : (const char *)0;
+}
+
+// The container at pValue with its items recorded, `NULL` if out of memory (the caller walks data instead)
+static const struct tagJsonLazyContainer *_indexLazyContainer(const JsonLazyValue *pValue, int isObject)
+{
+    const JsonLazyDocument *pDocument = pValue->pDocument;
+    struct tagJsonLazyContainer *pContainer = _lazyContainer( pDocument, pValue->offset );
+    if( pContainer->itemCount != SIZE_MAX ) { return pContainer; }
+
+    size_t count = 0;
+    const char *pFirst = _firstLazyItem( pDocument, pDocument->data + pValue->offset );
+    for( const char *pItem = pFirst; pItem; pItem = _nextLazyItem( pDocument, pItem, isObject ) ) {
+        count++;
+    }
+    if( count ) {
+        pContainer->pItems = (size_t *)_mallocWith( pDocument->pAllocator, count * sizeof(size_t) );
+        if( !pContainer->pItems ) { return (const struct tagJsonLazyContainer *)0; }
+
+        size_t i = 0;
+        for( const char *pItem = pFirst; pItem; pItem = _nextLazyItem( pDocument, pItem, isObject ) ) {
+            pContainer->pItems[i++] = (size_t)(pItem - pDocument->data);
+        }
+    }
+    pContainer->itemCount = count;
+    return pContainer;
+}
+
+JsonLazyValue getLazyRoot(const JsonLazyDocument *pDocument)
+{
+    JsonLazyValue root = { .pDocument = pDocument, .offset = 0, };
+    if( pDocument->length ) {
+        root.offset = (size_t)(_skipSpace( pDocument->data, pDocument->data + pDocument->length ) - pDocument->data);
+    }
+    return root;
+}
+
+ElementType getLazyType(const JsonLazyValue *pValue)
+{
+    const JsonLazyDocument *pDocument = pValue->pDocument;
+    if( pValue->offset >= pDocument->length ) { return TYPE_NULL; } // empty document
+
+    const char *pCurrChar = pDocument->data + pValue->offset;
+    switch( *pCurrChar )
+    {
+        case '{': return TYPE_OBJECT;
+        case '[': return TYPE_ARRAY;
+        case '"': return TYPE_STRING;
+        case 't':
+        case 'f': return TYPE_BOOLEAN;
+        case 'n': return TYPE_NULL;
+        default: break;
+    }
+
+    // Number: integer or double is decided as parseJsonString() does
+    JsonParserContext ctx = { .pInputEnd = pDocument->data + pDocument->length, .pAllocator = pDocument->pAllocator, };
+    Element number = { .type = TYPE_NULL, };
+    const char *pEnd = (const char *)0;
+    parseNumber( &ctx, pCurrChar, &pEnd, &number );
+    return number.type;
+}
+
+size_t getLazyLength(const JsonLazyValue *pValue)
+{
+    ElementType type = getLazyType( pValue );
+    if( type != TYPE_OBJECT && type != TYPE_ARRAY ) { return 0; }
+
+    const struct tagJsonLazyContainer *pContainer = _indexLazyContainer( pValue, type == TYPE_OBJECT );
+    if( pContainer ) { return pContainer->itemCount; }
+
+    size_t count = 0;
+    const JsonLazyDocument *pDocument = pValue->pDocument;
+    for( const char *pItem = _firstLazyItem( pDocument, pDocument->data + pValue->offset ); pItem; pItem = _nextLazyItem( pDocument, pItem, type == TYPE_OBJECT ) ) {
+        count++;
+    }
+    return count;
+}
+
+int getLazyArrayElement(const JsonLazyValue *pArray, size_t index, JsonLazyValue *pOutValue)
+{
+    if( getLazyType( pArray ) != TYPE_ARRAY ) { return 0; }
+
+    const JsonLazyDocument *pDocument = pArray->pDocument;
+    const struct tagJsonLazyContainer *pContainer = _indexLazyContainer( pArray, 0 );
+    const char *pItem = (const char *)0;
+    if( pContainer ) {
+        if( index < pContainer->itemCount ) { pItem = pDocument->data + pContainer->pItems[index]; }
+    }
+    else {
+        for( pItem = _firstLazyItem( pDocument, pDocument->data + pArray->offset ); pItem && index; index-- ) {
+            pItem = _nextLazyItem( pDocument, pItem, 0 );
+        }
+    }
+    if( !pItem ) { return 0; }
+
+    pOutValue->pDocument = pDocument;
+    pOutValue->offset = (size_t)(pItem - pDocument->data);
+    return 1;
+}
+
+int findLazyMember(const JsonLazyValue *pObject, const char *key, size_t keyLength, JsonLazyValue *pOutValue)
+{
+    if( getLazyType( pObject ) != TYPE_OBJECT ) { return 0; }
+
+    const JsonLazyDocument *pDocument = pObject->pDocument;
+    const char *pInputEnd = pDocument->data + pDocument->length;
+    JsonParserContext ctx = { .pInputEnd = pInputEnd, .pHandler = &_lazyEvents, .pAllocator = pDocument->pAllocator, }; // (borrowed keys)
+    const struct tagJsonLazyContainer *pContainer = _indexLazyContainer( pObject, 1 );
+    int found = 0;
+
+    const char *pItem = pContainer ? (pContainer->itemCount ? pDocument->data + pContainer->pItems[0] : (const char *)0)
+                                   : _firstLazyItem( pDocument, pDocument->data + pObject->offset );
+    for( size_t i = 1; pItem && !found; i++ ) {
+        const char *pRawKey = pItem + 1;
+        const char *pSpecial = _scanString( pRawKey, pInputEnd );
+        if( *pSpecial == '"' ) { // no escapes: compare in place
+            found = ((size_t)(pSpecial - pRawKey) == keyLength && !memcmp( pRawKey, key, keyLength ));
+        }
+        else {
+            char *decodedKey = (char *)0;
+            size_t decodedLength = 0;
+            const char *pEnd = (const char *)0;
+            if( _getString( &ctx, &decodedKey, &decodedLength, (uint32_t *)0, pItem, &pEnd ) == JPE_NO_ERROR ) {
+                found = (decodedLength == keyLength && !memcmp( decodedKey, key, keyLength ));
+            }
+        }
+        if( found ) {
+            pOutValue->pDocument = pDocument;
+            pOutValue->offset = (size_t)(_lazyMemberValue( pDocument, pItem ) - pDocument->data);
+        }
+        else if( pContainer ) {
+            pItem = (i < pContainer->itemCount) ? pDocument->data + pContainer->pItems[i] : (const char *)0;
+        }
+        else {
+            pItem = _nextLazyItem( pDocument, pItem, 1 );
+        }
+    }
+
+    _freeWith( ctx.pAllocator, ctx.pScratch );
+    return found;
+}
+
+JsonParsingError materializeLazyValue(const JsonLazyValue *pValue, Element *pOutElement, JsonArena *pArena)
+{
+    const JsonLazyDocument *pDocument = pValue->pDocument;
+    if( pValue->offset >= pDocument->length ) { // empty document
+        pOutElement->type = TYPE_NULL;
+        pOutElement->length = 0;
+        return JPE_NO_ERROR;
+    }
+
+    JsonParserContext ctx = { .pArena = pArena, .pInputEnd = pDocument->data + pDocument->length, .maxDepth = SIZE_MAX,
+                              .pAllocator = pDocument->pAllocator, };
+    const char *pEnd = (const char *)0;
+    JsonParsingError ret = parseValue( &ctx, pDocument->data + pValue->offset, &pEnd, pOutElement ); // (only JPE_OUT_OF_MEMORY)
+    _releaseContext( &ctx );
+    return ret;
+}
+
+JsonParsingError parseString(JsonParserContext *pCtx, const char *pCurrChar, const char **ppEnd, Element *pElement)
+{
+    char *stringValue = (char *)0; 
+    size_t length = 0;
+    JsonParsingError ret = _getString( pCtx, &stringValue, &length, (uint32_t *)0, pCurrChar, ppEnd );
+    if( ret == JPE_NO_ERROR ) {
+        pElement->type = TYPE_STRING;
+        pElement->length = (uint32_t)length;
+        pElement->stringValue = stringValue;
+    }
+    return ret;
+}
+
+//
+// Number Conversion
+// ** Up to 19 significant digits are accumulated exactly in a uint64_t; the decimal exponent is applied by
+//    Clinger's fast path (exact double arithmetic) or the Eisel-Lemire algorithm (128-bit powers of five).
+//    The few cases neither can round correctly (subnormals, exact halfway, longer significands) go to strtod().
+//
+#define _MAX_SIGNIFICANT_DIGITS 19
+#define _MAX_EXPONENT_DIGITS    100000 // far beyond the double range; keeps the exponent from overflowing
+
+static const double _exactPow10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Low 64 bits of a * b (high 64 bits to *pHigh)
+static inline uint64_t _mul128(uint64_t a, uint64_t b, uint64_t *pHigh)
+{
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 product = (unsigned __int128)a * b;
+    *pHigh = (uint64_t)(product >> 64);
+    return (uint64_t)product;
+#else
+    uint64_t aLo = (uint32_t)a, aHi = a >> 32;
+    uint64_t bLo = (uint32_t)b, bHi = b >> 32;
+    uint64_t lolo = aLo * bLo, lohi = aLo * bHi, hilo = aHi * bLo, hihi = aHi * bHi;
+    uint64_t middle = (lolo >> 32) + (uint32_t)lohi + (uint32_t)hilo;
+    *pHigh = hihi + (lohi >> 32) + (hilo >> 32) + (middle >> 32);
+    return (middle << 32) | (uint32_t)lolo;
+#endif
+}
+
+// (-1)^negative * w * 10^q, correctly rounded; returns 0 when it cannot decide
+static int _decimalToDouble(uint64_t w, int64_t q, int negative, double *pOut)
+{
+    if( w == 0 ) {
+        *pOut = negative ? -0.0 : 0.0;
+        return 1;
+    }
+
+#if FLT_EVAL_METHOD == 0
+    // Clinger: w and 10^|q| are both exact doubles, so one IEEE operation rounds correctly
+    if( w <= (1ull << 53) && q >= -22 && q <= 22 ) {
+        double value = (double)w;
+        value = q < 0 ? value / _exactPow10[-q] : value * _exactPow10[q];
+        *pOut = negative ? -value : value;
+        return 1;
+    }
+#endif
+
+    if( q < JSON_POW5_MIN_EXPONENT || q > JSON_POW5_MAX_EXPONENT ) { return 0; }
+
+    // Eisel-Lemire
+    const uint64_t *pPow5 = _pow5Table[q - JSON_POW5_MIN_EXPONENT];
+    int leadingZeros = __builtin_clzll(w);
+    w <<= leadingZeros;
+
+    uint64_t upper;
+    uint64_t lower = _mul128( w, pPow5[0], &upper );
+    if( (upper & 0x1FF) == 0x1FF && lower + w < lower ) {
+        // Truncated product may be off in the bits that matter: use the next 64 bits of 5^q
+        uint64_t productMiddle;
+        uint64_t productLow = _mul128( w, pPow5[1], &productMiddle );
+        lower += productMiddle;
+        if( lower < productMiddle ) { upper++; }
+        if( lower + 1 == 0 && (upper & 0x1FF) == 0x1FF && productLow + w < productLow ) { return 0; }
+    }
+
+    uint64_t upperBit = upper >> 63;
+    uint64_t mantissa = upper >> (upperBit + 9);
+    leadingZeros += (int)(1 ^ upperBit);
+
+    // Exactly halfway between two doubles: the rounding direction is unknown
+    if( lower == 0 && (upper & 0x1FF) == 0 && (mantissa & 3) == 1 ) { return 0; }
+
+    mantissa += mantissa & 1; // round to nearest, ties to even
+    mantissa >>= 1;
+    if( mantissa >= (1ull << 53) ) {
+        mantissa = (1ull << 52);
+        leadingZeros--;
+    }
+    mantissa &= ~(1ull << 52);
+
+    // floor(log2(10^q)) = (217706 * q) >> 16
+    int64_t exponent = ((217706 * q) >> 16) + 1024 + 63 - leadingZeros;
+    if( exponent < 1 || exponent > 2046 ) { return 0; } // subnormal or infinite
+
+    uint64_t bits = mantissa | ((uint64_t)exponent << 52) | ((uint64_t)negative << 63);
+    memcpy( pOut, &bits, sizeof(double) );
+    return 1;
+}
+
+// strtod() on a NUL-terminated copy of the token (the input may not be terminated),
+// with '.' replaced by the decimal point of LC_NUMERIC; a long copy comes from pAllocator
+static JsonParsingError _strtodToken(const JsonAllocator *pAllocator, const char *pStart, const char *pEnd, double *pOut)
+{
+    const char *decimalPoint = localeconv()->decimal_point;
+    char buffer[128];
+    size_t pointLength = strlen(decimalPoint);
+    size_t length = (size_t)(pEnd - pStart) + pointLength;
+    char *pCopy = length < sizeof(buffer) ? buffer : (char *)_mallocWith( pAllocator, length + 1 );
+    if( !pCopy ) { return JPE_OUT_OF_MEMORY; }
+
+    char *pDst = pCopy;
+    for( const char *pSrc = pStart; pSrc < pEnd; pSrc++ ) {
+        if( *pSrc == '.' ) {
+            memcpy( pDst, decimalPoint, pointLength );
+            pDst += pointLength;
+        }
+        else {
+            *pDst++ = *pSrc;
+        }
+    }
+    *pDst = '\0';
+
+    *pOut = strtod( pCopy, (char **)0 );
+    if( pCopy != buffer ) { _freeWith( pAllocator, pCopy ); }
+    return JPE_NO_ERROR;
+}
+
+JsonParsingError parseNumber(JsonParserContext *pCtx, const char *pCurrChar, const char **ppEnd, Element *pElement)
+{
+    // Check Octal, Hex, Decimal or Floating Point Number
+    const char *pInputEnd = pCtx->pInputEnd;
+    const char *pTmp = pCurrChar;
+
+    if( _peekChar(pTmp, pInputEnd) == '+' || _peekChar(pTmp, pInputEnd) == '-' ) { ++pTmp; }
+#if _ALLOW_LOOSEN_NUMBER_FORMAT_ // allow hex, octal, c-style floating point
+    char *ptrEnd = (char *)0;
+    if( !_isDigit(_peekChar(pTmp, pInputEnd)) || _peekChar(pTmp, pInputEnd) != '.' ) {
+        *ppEnd = pCurrChar;
+        return JPE_SYNTAX_ERROR;
+    }
+
+    if( pTmp[0] == '0' ) {
+        if( _peekChar(pTmp + 1, pInputEnd) == 'x' || _peekChar(pTmp + 1, pInputEnd) == 'X' || _isDigit(_peekChar(pTmp + 1, pInputEnd)) ) { // Hex or Octal
+            pElement->type = TYPE_INT_NUMBER;
+            pElement->iNumberValue = (int64_t)strtoll(pCurrChar, &ptrEnd, 0);
+        }
+    }
+
+    if( !ptrEnd ) {
+        double val = strtod( pCurrChar, &ptrEnd );
+        if( fabs( ceil(val) - val ) <= DBL_EPSILON ) {
+            pElement->type = TYPE_INT_NUMBER;
+            pElement->iNumberValue = (int64_t)val;
+        }
+        else {
+            pElement->type = TYPE_DBL_NUMBER;
+            pElement->dNumberValue = val;
+        }
+    }
+
+    if( !ptrEnd ) {
+        *ppEnd = pCurrChar;
+        return JPE_SYNTAX_ERROR;
+    }
+
+    *ppEnd = ptrEnd;
+    return JPE_NO_ERROR;
+#else
+    int negative = (*pCurrChar == '-');
+    if( !_isDigit(_peekChar(pTmp, pInputEnd)) ) {
+        *ppEnd = pCurrChar;
+        return JPE_SYNTAX_ERROR;
+    }
+    
+    if( pTmp[0] == '0' ) {
+        if( _peekChar(pTmp + 1, pInputEnd) == 'x' || _peekChar(pTmp + 1, pInputEnd) == 'X' || _isDigit(_peekChar(pTmp + 1, pInputEnd)) ) { // Hex or Octal
+            *ppEnd = pCurrChar;
+            return JPE_SYNTAX_ERROR;
+        }
+    }
+
+    // Significand (digits past the 19th only shift the exponent) and Exponent
+    uint64_t significand = 0;
+    int      digits      = 0;
+    int64_t  exponent    = 0;
+    int      truncated   = 0; // a non-zero digit was dropped
+    int      isDouble    = 0; // `.` or exponent present
+
+    for( ; _isDigit(_peekChar(pTmp, pInputEnd)); pTmp++ ) {
+        if( digits < _MAX_SIGNIFICANT_DIGITS ) {
+            significand = significand * 10 + (uint64_t)(*pTmp - '0');
+            digits += (significand != 0);
+        }
+        else {
+            exponent++;
+            truncated |= (*pTmp != '0');
+        }
+    }
+
+    if( _peekChar(pTmp, pInputEnd) == '.' ) { // NOTE: "1." is accepted as strtod() does
+        isDouble = 1;
+        for( pTmp++; _isDigit(_peekChar(pTmp, pInputEnd)); pTmp++ ) {
+            if( digits < _MAX_SIGNIFICANT_DIGITS ) {
+                significand = significand * 10 + (uint64_t)(*pTmp - '0');
+                digits += (significand != 0);
+                exponent--;
+            }
+            else {
+                truncated |= (*pTmp != '0');
+            }
+        }
+    }
+
+    if( _peekChar(pTmp, pInputEnd) == 'e' || _peekChar(pTmp, pInputEnd) == 'E' ) {
+        const char *pExp = pTmp + 1;
+        int expNegative = (_peekChar(pExp, pInputEnd) == '-');
+        if( _peekChar(pExp, pInputEnd) == '+' || _peekChar(pExp, pInputEnd) == '-' ) { pExp++; }
+        if( _isDigit(_peekChar(pExp, pInputEnd)) ) { // otherwise the number ends before 'e'
+            int64_t expValue = 0;
+            for( ; _isDigit(_peekChar(pExp, pInputEnd)); pExp++ ) {
+                if( expValue < _MAX_EXPONENT_DIGITS ) { expValue = expValue * 10 + (*pExp - '0'); }
+            }
+            exponent += expNegative ? -expValue : expValue;
+            isDouble = 1;
+            pTmp = pExp;
+        }
+    }
+
+    // Integer: exact int64_t unless it overflows (then it falls through to double)
+    if( !isDouble && exponent == 0 && significand <= (uint64_t)INT64_MAX + negative ) {
+        pElement->type = TYPE_INT_NUMBER;
+        pElement->iNumberValue = negative ? -(int64_t)(significand - 1) - 1 : (int64_t)significand;
+        *ppEnd = pTmp;
+        return JPE_NO_ERROR;
+    }
+
+    if( pCtx->flags & _JSON_PARSE_VALIDATE ) { // (the value is not used)
+        pElement->type = TYPE_DBL_NUMBER;
+        pElement->dNumberValue = 0.0;
+        *ppEnd = pTmp;
+        return JPE_NO_ERROR;
+    }
+
+    double val;
+    if( truncated || !_decimalToDouble( significand, exponent, negative, &val ) ) {
+        JsonParsingError err = _strtodToken( pCtx->pAllocator, pCurrChar, pTmp, &val );
+        if( err != JPE_NO_ERROR ) {
+            *ppEnd = pCurrChar;
+            return err;
+        }
+    }
+    pElement->type = TYPE_DBL_NUMBER;
+    pElement->dNumberValue = val;
+    *ppEnd = pTmp;
+    return JPE_NO_ERROR;
+#endif
+}
+
+JsonParsingError parseBoolean(JsonParserContext *pCtx, const char *pCurrChar, const char **ppEnd, Element *pElement)
+{
+    size_t remain = (size_t)(pCtx->pInputEnd - pCurrChar);
+    if( remain >= 4 && !memcmp( pCurrChar, "true", 4 ) ) {
+        pElement->type = TYPE_BOOLEAN;
+        pElement->iNumberValue = 1;
+        *ppEnd = pCurrChar + 4;
+        return JPE_NO_ERROR;
+    }
+    else if( remain >= 5 && !memcmp( pCurrChar, "false", 5 ) ) {
+        pElement->type = TYPE_BOOLEAN;
+        pElement->iNumberValue = 0;
+        *ppEnd = pCurrChar + 5;
+        return JPE_NO_ERROR;
+    }
+    
+    *ppEnd = pCurrChar;
+    return JPE_SYNTAX_ERROR;
+}
+
+JsonParsingError parseNull(JsonParserContext *pCtx, const char *pCurrChar, const char **ppEnd, Element *pElement)
+{
+    if( pCtx->pInputEnd - pCurrChar >= 4 && !memcmp( pCurrChar, "null", 4 ) ) {
+        pElement->type = TYPE_NULL;
+        pElement->iNumberValue = 0;
+        *ppEnd = pCurrChar + 4;
+        return JPE_NO_ERROR;
+    }
+    
+    *ppEnd = pCurrChar;
+    return JPE_SYNTAX_ERROR;
+}
+
+
+void resetElement(Element *pElement)
+{
+    resetElementEx( pElement, (const JsonAllocator *)0 );
+}
+
+void resetElementEx(Element *pElement, const JsonAllocator *pAllocator)
+{
+    switch( pElement->type )
+    {
+        // No Additional Allocation
+        case TYPE_NULL:
+        case TYPE_DBL_NUMBER:
+        case TYPE_INT_NUMBER:
+        case TYPE_BOOLEAN:
+            break;
+
+        // Release Once
+        case TYPE_STRING:
+        {
+            _freeWith(pAllocator, pElement->stringValue);
+        }
+        break;
+
+        case TYPE_OBJECT:
+        {
+            for( uint32_t i = 0; i < pElement->length; i++ ) {
+                resetElementEx( &(pElement->objectValue[i].element), pAllocator );
+                _freeWith(pAllocator, pElement->objectValue[i].key);
+            }
+            _freeWith(pAllocator, pElement->objectValue); // also releases the key index
+        }
+        break;
+
+        case TYPE_ARRAY:
+        {
+            for( uint32_t i = 0; i < pElement->length; i++ ) {
+                resetElementEx( &(pElement->arrayValue[i]), pAllocator );
+            }
+            _freeWith(pAllocator, pElement->arrayValue);
+        }
+        break;
+    }
+
+    pElement->type = 0;
+    pElement->length = 0;
+    pElement->iNumberValue = 0;
+}
+
+size_t getArrayLength(const Element *pElement)
+{
+    return ( pElement->type == TYPE_ARRAY ) ? pElement->length : 0;
+}
+
+const Element *getArrayElement(const Element *pElement, size_t index)
+{
+    if( pElement->type != TYPE_ARRAY || index >= pElement->length ) { return (const Element *)0; }
+    return &(pElement->arrayValue[index]);
+}
+
+const Element *findMember(const Element *pObject, const char *key, size_t keyLength)
+{
+    if( pObject->type != TYPE_OBJECT ) { return (const Element *)0; }
+
+    const ObjectNode *pMembers = pObject->objectValue;
+    size_t capacity = _objectIndexCapacity( pObject->length );
+
+    if( capacity ) {
+        // Hashed Lookup
+        const uint32_t *pSlots = (const uint32_t *)(pMembers + pObject->length);
+        uint32_t hash = _hashKey( key, keyLength );
+        size_t slot = hash & (capacity - 1);
+        while( pSlots[slot] ) {
+            const ObjectNode *pMember = &(pMembers[pSlots[slot] - 1]);
+            if( pMember->keyHash == hash && pMember->keyLength == keyLength && !memcmp( pMember->key, key, keyLength ) ) {
+                return &(pMember->element);
+            }
+            slot = (slot + 1) & (capacity - 1);
+        }
+    }
+    else {
+        // Small Object: Linear Search
+        for( uint32_t i = 0; i < pObject->length; i++ ) {
+            if( pMembers[i].keyLength == keyLength && !memcmp( pMembers[i].key, key, keyLength ) ) {
+                return &(pMembers[i].element);
+            }
+        }
+    }
+
+    return (const Element *)0;
+}
+
+//
+// Serializer
+// ** Output goes to a _JsonOutput: a growable malloc() buffer, the caller's buffer (filled up as snprintf() does,
+//    then the rest is only counted), or a bounded buffer flushed to a JsonSink.
+// ** Strings are copied in runs between the bytes that need an escape, found with _scanString().
+// ** Doubles: the shortest digits that read back as the same double (Grisu2, checked by reading them back),
+//    always with '.' or an exponent so that they parse as TYPE_DBL_NUMBER again. NaN and infinities are written as null.
+// ** Not recursive: the containers being written are frames on a heap stack.
+//
+typedef struct
+{
+    char  *pBuffer;
+    size_t size;     // bytes written
+    size_t capacity;
+    size_t dropped;  // bytes counted but not written (they did not fit in the caller's buffer)
+    int    growable; // pBuffer is realloc()'d (otherwise it is the caller's)
+    int    failed;   // out of memory (growable), or pSink failed
+    JsonSink pSink;  // pBuffer is passed on to it when full
+    void    *pSinkData;
+} _JsonOutput;
+
+static void _flushOutput(_JsonOutput *pOut)
+{
+    if( pOut->size && !pOut->failed && pOut->pSink( pOut->pSinkData, pOut->pBuffer, pOut->size ) != 0 ) {
+        pOut->failed = 1;
+    }
+    pOut->size = 0;
+}
+
+// Space for `size` more bytes, or `NULL` (then the output is full for good, the bytes go straight to pSink,
+// or they are cut to the caller's buffer by _writeBytes())
+static char *_growOutput(_JsonOutput *pOut, size_t size)
+{
+    if( pOut->pSink ) {
+        _flushOutput( pOut );
+        return (size <= pOut->capacity) ? pOut->pBuffer : (char *)0;
+    }
+    if( pOut->growable && !pOut->failed ) {
+        size_t newCapacity = pOut->capacity ? pOut->capacity * 2 : 256;
+        while( newCapacity - pOut->size < size ) { newCapacity *= 2; }
+        char *pNewBuffer = (char *)realloc( pOut->pBuffer, newCapacity );
+        if( pNewBuffer ) {
+            pOut->pBuffer = pNewBuffer;
+            pOut->capacity = newCapacity;
+            return pNewBuffer + pOut->size;
+        }
+        pOut->failed = 1;
+        pOut->capacity = pOut->size;
+    }
+    return (char *)0;
+}
+
+static inline char *_outputSpace(_JsonOutput *pOut, size_t size)
+{
+    if( size <= pOut->capacity - pOut->size ) { return pOut->pBuffer + pOut->size; }
+    return _growOutput( pOut, size );
+}
+
+static inline void _writeBytes(_JsonOutput *pOut, const char *pBytes, size_t size)
+{
+    char *pSpace = _outputSpace( pOut, size );
+    if( pSpace ) {
+        memcpy( pSpace, pBytes, size );
+        pOut->size += size;
+    }
+    else if( pOut->pSink ) { // (larger than the buffer)
+        if( !pOut->failed && pOut->pSink( pOut->pSinkData, pBytes, size ) != 0 ) { pOut->failed = 1; }
+    }
+    else { // the caller's buffer: its beginning is kept, the rest only counted
+        size_t room = pOut->capacity - pOut->size;
+        if( room ) { memcpy( pOut->pBuffer + pOut->size, pBytes, room ); }
+        pOut->size += room;
+        pOut->dropped += size - room;
+        pOut->capacity = pOut->size; // (full for good)
+    }
+}
+
+// '\n' and the indentation of `depth`
+static void _writeIndent(_JsonOutput *pOut, size_t depth)
+{
+    static const char spaces[] = "\n                                                                ";
+    size_t size = 1 + depth * JSON_WRITE_INDENT;
+    const char *pBytes = spaces;
+    while( size > sizeof(spaces) - 1 ) {
+        _writeBytes( pOut, pBytes, sizeof(spaces) - 1 );
+        size -= sizeof(spaces) - 1;
+        pBytes = spaces + 1; // no more '\n'
+    }
+    _writeBytes( pOut, pBytes, size );
+}
+
+static void _writeString(_JsonOutput *pOut, const char *str, size_t length)
+{
+    static const char hexDigits[] = "0123456789abcdef";
+    const char *pCurrChar = str;
+    const char *pStringEnd = str + length;
+
+    _writeBytes( pOut, "\"", 1 );
+    for( ;; ) {
+        const char *pRunEnd = _scanString( pCurrChar, pStringEnd );
+        if( pRunEnd > pCurrChar ) { _writeBytes( pOut, pCurrChar, (size_t)(pRunEnd - pCurrChar) ); }
+        if( pRunEnd == pStringEnd ) { break; }
+
+        char escape[6] = { '\\', 0, };
+        size_t escapeSize = 2;
+        switch( *pRunEnd ) {
+            case '"':  escape[1] = '"'; break;
+            case '\\': escape[1] = '\\'; break;
+            case '\b': escape[1] = 'b'; break;
+            case '\f': escape[1] = 'f'; break;
+            case '\n': escape[1] = 'n'; break;
+            case '\r': escape[1] = 'r'; break;
+            case '\t': escape[1] = 't'; break;
+            default: // other control characters
+                memcpy( escape + 1, "u00", 3 );
+                escape[4] = hexDigits[(unsigned char)*pRunEnd >> 4];
+                escape[5] = hexDigits[*pRunEnd & 0xF];
+                escapeSize = 6;
+                break;
+        }
+        _writeBytes( pOut, escape, escapeSize );
+        pCurrChar = pRunEnd + 1;
+    }
+    _writeBytes( pOut, "\"", 1 );
+}
+
+static const char _digitPairs[] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// Decimal digits of value (two at a time); returns the number of bytes written to pOut
+static size_t _formatUint64(char *pOut, uint64_t value)
+{
+    char buffer[20];
+    char *pDigits = buffer + sizeof(buffer);
+    while( value >= 100 ) {
+        pDigits -= 2;
+        memcpy( pDigits, _digitPairs + (value % 100) * 2, 2 );
+        value /= 100;
+    }
+    if( value >= 10 ) {
+        pDigits -= 2;
+        memcpy( pDigits, _digitPairs + value * 2, 2 );
+    }
+    else {
+        *--pDigits = (char)('0' + value);
+    }
+
+    size_t length = (size_t)(buffer + sizeof(buffer) - pDigits);
+    memcpy( pOut, pDigits, length );
+    return length;
+}
+
+static size_t _formatInt64(char *pOut, int64_t value)
+{
+    if( value < 0 ) {
+        *pOut = '-';
+        return 1 + _formatUint64( pOut + 1, 0 - (uint64_t)value );
+    }
+    return _formatUint64( pOut, (uint64_t)value );
+}
+
+// Grisu2 (Loitsch, "Printing Floating-Point Numbers Quickly and Accurately with Integers")
+// ** f * 2^e with a 64-bit f
+typedef struct
+{
+    uint64_t f;
+    int      e;
+} _DiyFp;
+
+static inline _DiyFp _multiplyDiyFp(_DiyFp a, _DiyFp b)
+{
+    uint64_t high;
+    uint64_t low = _mul128( a.f, b.f, &high );
+    _DiyFp product = { high + (low >> 63), a.e + b.e + 64 }; // rounded
+    return product;
+}
+
+static inline _DiyFp _normalizeDiyFp(_DiyFp x)
+{
+    int shift = __builtin_clzll( x.f );
+    x.f <<= shift;
+    x.e -= shift;
+    return x;
+}
+
+// 10^k, normalized and rounded to 64 bits (from the powers of five of parseNumber(): 10^k = 5^k * 2^k)
+static _DiyFp _cachedPow10(int k)
+{
+    const uint64_t *pPow5 = _pow5Table[k - JSON_POW5_MIN_EXPONENT];
+    _DiyFp power = { pPow5[0], (int)((217706 * (int64_t)k) >> 16) - 63 };
+    if( (pPow5[1] >> 63) && power.f != UINT64_MAX ) { power.f++; }
+    return power;
+}
+
+static const uint64_t _pow10Table[20] = {
+    1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull, 1000000000ull,
+    10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull, 100000000000000ull,
+    1000000000000000ull, 10000000000000000ull, 100000000000000000ull, 1000000000000000000ull, 10000000000000000000ull
+};
+
+// Move the last digit towards w while the digits stay in (m-, m+)
+static void _grisuRound(char *pDigits, int length, uint64_t delta, uint64_t rest, uint64_t tenKappa, uint64_t distance)
+{
+    while( rest < distance && delta - rest >= tenKappa &&
+           (rest + tenKappa < distance || distance - rest > rest + tenKappa - distance) ) {
+        pDigits[length - 1]--;
+        rest += tenKappa;
+    }
+}
+
+// Shortest digits of w within delta below high (w, high: scaled so that -60 <= e <= -32)
+static int _grisuDigits(_DiyFp w, _DiyFp high, uint64_t delta, char *pDigits, int *pK)
+{
+    int shift = -high.e;
+    uint64_t one = 1ull << shift;
+    uint64_t distance = high.f - w.f;
+    uint32_t integral = (uint32_t)(high.f >> shift);
+    uint64_t fraction = high.f & (one - 1);
+    int length = 0;
+
+    int kappa = 1;
+    while( kappa < 10 && integral >= _pow10Table[kappa] ) { kappa++; }
+
+    while( kappa > 0 ) {
+        uint32_t digit = (uint32_t)(integral / _pow10Table[kappa - 1]);
+        integral %= (uint32_t)_pow10Table[kappa - 1];
+        if( digit || length ) { pDigits[length++] = (char)('0' + digit); }
+        kappa--;
+
+        uint64_t rest = ((uint64_t)integral << shift) + fraction;
+        if( rest <= delta ) {
+            *pK += kappa;
+            _grisuRound( pDigits, length, delta, rest, _pow10Table[kappa] << shift, distance );
+            return length;
+        }
+    }
+
+    for( ;; ) {
+        fraction *= 10;
+        delta *= 10;
+        char digit = (char)(fraction >> shift);
+        if( digit || length ) { pDigits[length++] = (char)('0' + digit); }
+        fraction &= one - 1;
+        kappa--;
+        if( fraction < delta ) {
+            *pK += kappa;
+            _grisuRound( pDigits, length, delta, fraction, one, -kappa < 20 ? distance * _pow10Table[-kappa] : 0 );
+            return length;
+        }
+    }
+}
+
+// Digits of a positive finite double: value = digits * 10^(*pK); returns their count (0: out of the range of the table)
+static int _grisu2(double value, char *pDigits, int *pK)
+{
+    uint64_t bits;
+    memcpy( &bits, &value, sizeof(double) );
+    uint64_t fraction = bits & ((1ull << 52) - 1);
+    int biasedExponent = (int)((bits >> 52) & 0x7FF);
+    _DiyFp v = { fraction, -1074 };
+    if( biasedExponent ) {
+        v.f |= 1ull << 52;
+        v.e = biasedExponent - 1075;
+    }
+
+    // Halfway to the neighbors (the one below is closer at a power of two)
+    _DiyFp high = _normalizeDiyFp( (_DiyFp){ (v.f << 1) + 1, v.e - 1 } );
+    _DiyFp low = (fraction == 0 && biasedExponent > 1) ? (_DiyFp){ (v.f << 2) - 1, v.e - 2 } : (_DiyFp){ (v.f << 1) - 1, v.e - 1 };
+    low.f <<= low.e - high.e;
+    low.e = high.e;
+
+    // 10^k that brings the exponent of high into [-60, -32]
+    int k = (int)ceil( (-61 - high.e) * 0.30102999566398114 );
+    int scaledExponent = high.e + (int)((217706 * (int64_t)k) >> 16) + 1;
+    if( scaledExponent < -60 ) { k++; }
+    else if( scaledExponent > -32 ) { k--; }
+    if( k < JSON_POW5_MIN_EXPONENT || k > JSON_POW5_MAX_EXPONENT ) { return 0; }
+
+    _DiyFp power = _cachedPow10( k );
+    _DiyFp w = _multiplyDiyFp( _normalizeDiyFp( v ), power );
+    _DiyFp scaledHigh = _multiplyDiyFp( high, power );
+    _DiyFp scaledLow = _multiplyDiyFp( low, power );
+    scaledLow.f++; // (the errors of the products)
+    scaledHigh.f--;
+
+    *pK = -k;
+    return _grisuDigits( w, scaledHigh, scaledHigh.f - scaledLow.f, pDigits, pK );
+}
+
+// The digits read back as value
+static int _isRoundTrip(double value, const char *pDigits, int length, int K)
+{
+    uint64_t significand = 0;
+    for( int i = 0; i < length; i++ ) { significand = significand * 10 + (uint64_t)(pDigits[i] - '0'); }
+
+    double result;
+    if( length > 19 || !_decimalToDouble( significand, K, 0, &result ) ) {
+        char token[40];
+        memcpy( token, pDigits, (size_t)length );
+        size_t tokenLength = (size_t)length;
+        token[tokenLength++] = 'e';
+        tokenLength += _formatInt64( token + tokenLength, K );
+        if( _strtodToken( (const JsonAllocator *)0, token, token + tokenLength, &result ) != JPE_NO_ERROR ) { return 0; } // (fits the buffer)
+    }
+    return memcmp( &result, &value, sizeof(double) ) == 0;
+}
+
+// Shortest digits with printf() (subnormals, or in case Grisu2 did not read back)
+static int _printfDigits(double value, char *pDigits, int *pK)
+{
+    for( int precision = 1; precision <= 17; precision++ ) {
+        char text[40];
+        snprintf( text, sizeof(text), "%.*e", precision - 1, value ); // d[.ddd]e[+-]xx (the point may be of the locale)
+        int length = 0;
+        const char *pCurrChar = text;
+        for( ; *pCurrChar && *pCurrChar != 'e'; pCurrChar++ ) {
+            if( _isDigit(*pCurrChar) ) { pDigits[length++] = *pCurrChar; }
+        }
+        *pK = atoi( pCurrChar + 1 ) - (length - 1);
+        while( length > 1 && pDigits[length - 1] == '0' ) { // 1.50e+01 -> 15e0
+            length--;
+            (*pK)++;
+        }
+        if( _isRoundTrip( value, pDigits, length, *pK ) ) { return length; }
+    }
+    return 0; // (17 digits always read back)
+}
+
+static size_t _formatDouble(char *pOut, double value)
+{
+    if( isnan( value ) || isinf( value ) ) {
+        memcpy( pOut, "null", 4 );
+        return 4;
+    }
+
+    size_t size = 0;
+    if( signbit( value ) ) {
+        pOut[size++] = '-';
+        value = -value;
+    }
+    if( value == 0 ) {
+        memcpy( pOut + size, "0.0", 3 );
+        return size + 3;
+    }
+
+    char digits[32];
+    int K = 0;
+    int length = _grisu2( value, digits, &K );
+    if( length == 0 || !_isRoundTrip( value, digits, length, K ) ) {
+        length = _printfDigits( value, digits, &K );
+    }
+
+    // As JavaScript does, with ".0" for integers: 1234.0, 12.34, 0.001234, 1.234e-7, 1.234e+30
+    int point = length + K; // position of the decimal point in the digits
+    char *pCurrChar = pOut + size;
+    if( K >= 0 && point <= 21 ) {
+        memcpy( pCurrChar, digits, (size_t)length );
+        memset( pCurrChar + length, '0', (size_t)K );
+        pCurrChar += point;
+        memcpy( pCurrChar, ".0", 2 );
+        pCurrChar += 2;
+    }
+    else if( point > 0 && point <= 21 ) {
+        memcpy( pCurrChar, digits, (size_t)point );
+        pCurrChar[point] = '.';
+        memcpy( pCurrChar + point + 1, digits + point, (size_t)(length - point) );
+        pCurrChar += length + 1;
+    }
+    else if( point > -6 && point <= 0 ) {
+        memcpy( pCurrChar, "0.", 2 );
+        memset( pCurrChar + 2, '0', (size_t)-point );
+        memcpy( pCurrChar + 2 - point, digits, (size_t)length );
+        pCurrChar += 2 - point + length;
+    }
+    else {
+        *pCurrChar++ = digits[0];
+        if( length > 1 ) {
+            *pCurrChar++ = '.';
+            memcpy( pCurrChar, digits + 1, (size_t)(length - 1) );
+            pCurrChar += length - 1;
+        }
+        *pCurrChar++ = 'e';
+        if( point - 1 > 0 ) { *pCurrChar++ = '+'; }
+        pCurrChar += _formatInt64( pCurrChar, point - 1 );
+    }
+    return size + (size_t)(pCurrChar - (pOut + size));
+}
+
+static void _writeScalar(_JsonOutput *pOut, const Element *pElement)
+{
+    char text[40];
+    switch( pElement->type ) {
+        case TYPE_STRING:
+            _writeString( pOut, pElement->stringValue, pElement->length );
+            break;
+        case TYPE_INT_NUMBER:
+            _writeBytes( pOut, text, _formatInt64( text, pElement->iNumberValue ) );
+            break;
+        case TYPE_DBL_NUMBER:
+            _writeBytes( pOut, text, _formatDouble( text, pElement->dNumberValue ) );
+            break;
+        case TYPE_BOOLEAN:
+            if( pElement->iNumberValue ) { _writeBytes( pOut, "true", 4 ); }
+            else { _writeBytes( pOut, "false", 5 ); }
+            break;
+        default:
+            _writeBytes( pOut, "null", 4 );
+            break;
+    }
+}
+
+typedef struct
+{
+    const Element *pContainer;
+    uint32_t       next;       // index of the next member / element
+} _WriteFrame;
+
+static void _writeElement(_JsonOutput *pOut, const Element *pElement, uint32_t flags)
+{
+    int pretty = (flags & JSON_WRITE_PRETTY) != 0;
+    _WriteFrame *pFrames = (_WriteFrame *)0;
+    size_t frameCount = 0, frameCapacity = 0;
+
+    while( pElement ) {
+        // Value
+        if( (pElement->type == TYPE_OBJECT || pElement->type == TYPE_ARRAY) && pElement->length ) {
+            if( frameCount == frameCapacity ) {
+                size_t newCapacity = frameCapacity ? frameCapacity * 2 : 32;
+                _WriteFrame *pNewFrames = (_WriteFrame *)realloc( pFrames, newCapacity * sizeof(_WriteFrame) );
+                if( !pNewFrames ) {
+                    pOut->failed = 1;
+                    break;
+                }
+                pFrames = pNewFrames;
+                frameCapacity = newCapacity;
+            }
+            pFrames[frameCount].pContainer = pElement;
+            pFrames[frameCount].next = 0;
+            frameCount++;
+            _writeBytes( pOut, (pElement->type == TYPE_OBJECT) ? "{" : "[", 1 );
+        }
+        else if( pElement->type == TYPE_OBJECT ) {
+            _writeBytes( pOut, "{}", 2 );
+        }
+        else if( pElement->type == TYPE_ARRAY ) {
+            _writeBytes( pOut, "[]", 2 );
+        }
+        else {
+            _writeScalar( pOut, pElement );
+        }
+
+        // Next member / element (closing the containers that are done)
+        pElement = (const Element *)0;
+        while( frameCount && !pElement ) {
+            _WriteFrame *pFrame = &(pFrames[frameCount - 1]);
+            const Element *pContainer = pFrame->pContainer;
+            if( pFrame->next == pContainer->length ) {
+                frameCount--;
+                if( pretty ) { _writeIndent( pOut, frameCount ); }
+                _writeBytes( pOut, (pContainer->type == TYPE_OBJECT) ? "}" : "]", 1 );
+                continue;
+            }
+
+            if( pFrame->next ) { _writeBytes( pOut, ",", 1 ); }
+            if( pretty ) { _writeIndent( pOut, frameCount ); }
+            if( pContainer->type == TYPE_OBJECT ) {
+                const ObjectNode *pMember = &(pContainer->objectValue[pFrame->next]);
+                _writeString( pOut, pMember->key, pMember->keyLength );
+                _writeBytes( pOut, ": ", pretty ? 2 : 1 );
+                pElement = &(pMember->element);
+            }
+            else {
+                pElement = &(pContainer->arrayValue[pFrame->next]);
+            }
+            pFrame->next++;
+        }
+    }
+    free( pFrames );
+}
+
+char *writeJson(const Element *pElement, uint32_t flags, size_t *pOutLength)
+{
+    _JsonOutput out = { .growable = 1, };
+    _writeElement( &out, pElement, flags );
+    _writeBytes( &out, "", 1 ); // '\0'
+    if( out.failed ) {
+        free( out.pBuffer );
+        return (char *)0;
+    }
+
+    if( pOutLength ) { *pOutLength = out.size - 1; }
+    return out.pBuffer;
+}
+
+size_t writeJsonBuffer(const Element *pElement, uint32_t flags, char *buffer, size_t bufferSize)
+{
+    _JsonOutput out = { .pBuffer = buffer, .capacity = bufferSize ? bufferSize - 1 : 0, }; // (room for '\0')
+    _writeElement( &out, pElement, flags );
+    if( bufferSize ) { buffer[out.size] = '\0'; }
+    return out.failed ? 0 : out.size + out.dropped;
+}
+
+//
+// Reformat (Minify / Pretty-Print)
+// ** A state machine over the bytes, resumable at any chunk boundary: it checks the grammar,
+//    drops whitespace and writes the tokens as they are (strings in runs found with _scanString()).
+// ** Numbers and literals are checked with parseNumber() once complete; only a token split by a chunk boundary is copied.
+// ** Memory: the output buffer, the open containers (one byte each) and a split token.
+//
+typedef enum
+{
+    _REFORMAT_VALUE,       // a value is expected (or the closing bracket, right after '[')
+    _REFORMAT_KEY,         // a key is expected (or '}', right after '{')
+    _REFORMAT_COLON,       // ':' is expected
+    _REFORMAT_AFTER_VALUE, // ',' or the closing bracket is expected
+    _REFORMAT_STRING,      // in a string
+    _REFORMAT_TOKEN,       // in a number or a literal
+    _REFORMAT_DONE         // only whitespace may follow
+} _ReformatState;
+
+struct tagJsonReformatter
+{
+    _JsonOutput      out;
+    uint32_t         flags;       // JSON_WRITE_*
+    _ReformatState   state;
+    int              afterOpen;   // a container was just opened: it may be empty
+    int              isKey;       // _REFORMAT_STRING: a key (':' follows)
+    int              escape;      // _REFORMAT_STRING: 1 after '\\', 2 ~ 5: after "\u" (hex digits left + 1)
+
+    // _REFORMAT_TOKEN split by a chunk boundary
+    char            *pToken;
+    size_t           tokenSize;
+    size_t           tokenCapacity;
+
+    // Open containers: '{' or '['
+    char            *pContainers;
+    size_t           depth;
+    size_t           containerCapacity;
+    size_t           maxDepth;
+
+    // Location of the next chunk in the whole input
+    int              counting;    // (not needed when the whole input is one chunk)
+    size_t           position;
+    size_t           line;
+    size_t           column;
+
+    JsonErrorInfo    result;      // the error (sticky)
+    size_t           errorBack;   // the error is this many bytes before where it was noticed (on the same line)
+
+    const JsonAllocator *pAllocator; // of the reformatter and its buffers
+};
+
+// Bytes at the start of the token the parser reads as a number or a literal (`0` if it reads none)
+static size_t _tokenValueLength(const char *pToken, size_t size)
+{
+    JsonParserContext ctx = { .flags = _JSON_PARSE_VALIDATE, .pInputEnd = pToken + size, };
+    Element value;
+    const char *pEnd = pToken;
+    return _parseScalar( &ctx, pToken, &pEnd, &value ) == JPE_NO_ERROR ? (size_t)(pEnd - pToken) : 0;
+}
+
+static int _appendToken(JsonReformatter *pReformatter, const char *pBytes, size_t size)
+{
+    if( pReformatter->tokenCapacity - pReformatter->tokenSize < size ) {
+        size_t newCapacity = pReformatter->tokenCapacity ? pReformatter->tokenCapacity * 2 : 64;
+        while( newCapacity - pReformatter->tokenSize < size ) { newCapacity *= 2; }
+        char *pNewToken = (char *)_reallocWith( pReformatter->pAllocator, pReformatter->pToken, newCapacity );
+        if( !pNewToken ) { return 0; }
+        pReformatter->pToken = pNewToken;
+        pReformatter->tokenCapacity = newCapacity;
+    }
+    memcpy( pReformatter->pToken + pReformatter->tokenSize, pBytes, size );
+    pReformatter->tokenSize += size;
+    return 1;
+}
+
+static inline _ReformatState _reformatAfterValue(const JsonReformatter *pReformatter)
+{
+    return pReformatter->depth ? _REFORMAT_AFTER_VALUE : _REFORMAT_DONE;
+}
+
+// Errors inside containers are reported by the outermost one, as _runParser() does
+// ** ownContainers: 1 for the keys, colons and commas of the current container (they are not inside it)
+static JsonParsingError _reformatError(const JsonReformatter *pReformatter, JsonParsingError error, size_t ownContainers)
+{
+    if( pReformatter->depth > ownContainers && error > JPE_NO_ERROR && error != JPE_SYNTAX_ERROR_END ) {
+        return (pReformatter->pContainers[0] == '{') ? JPE_SYNTAX_ERROR_OBJECT : JPE_SYNTAX_ERROR_ARRAY;
+    }
+    return error;
+}
+
+// An invalid string: a key is reported as JPE_SYNTAX_ERROR_OBJECT_KEY
+static inline JsonParsingError _reformatStringError(const JsonReformatter *pReformatter, JsonParsingError error)
+{
+    return pReformatter->isKey ? _reformatError( pReformatter, JPE_SYNTAX_ERROR_OBJECT_KEY, 1 ) : _reformatError( pReformatter, error, 0 );
+}
+
+// The whole token (number or literal) is read: write it, or return the error and its offset in the token
+static JsonParsingError _reformatToken(JsonReformatter *pReformatter, const char *pToken, size_t size, size_t *pErrorOffset)
+{
+    size_t valueLength = _tokenValueLength( pToken, size );
+    if( valueLength == size ) {
+        _writeBytes( &(pReformatter->out), pToken, size );
+        pReformatter->tokenSize = 0;
+        pReformatter->state = _reformatAfterValue( pReformatter );
+        return JPE_NO_ERROR;
+    }
+
+    *pErrorOffset = valueLength;
+    if( valueLength == 0 ) { return _reformatError( pReformatter, JPE_SYNTAX_ERROR, 0 ); }
+    // A value followed by more of the token (e.g. "true1"): what comes after the value is wrong
+    if( !pReformatter->depth ) { return JPE_SYNTAX_ERROR; }
+    char container = pReformatter->pContainers[pReformatter->depth - 1];
+    return _reformatError( pReformatter, (container == '{') ? JPE_SYNTAX_ERROR_OBJECT_COMMA : JPE_SYNTAX_ERROR_ARRAY_COMMA, 1 );
+}
+
+// Reformat [pCurrChar, pInputEnd); on error *ppError is where it was found
+static JsonParsingError _reformatChunk(JsonReformatter *pReformatter, const char *pCurrChar, const char *pInputEnd, const char **ppError)
+{
+    _JsonOutput *pOut = &(pReformatter->out);
+    int pretty = (pReformatter->flags & JSON_WRITE_PRETTY) != 0;
+
+    while( pCurrChar < pInputEnd ) {
+        switch( pReformatter->state ) {
+            case _REFORMAT_VALUE:
+            case _REFORMAT_KEY:
+            {
+                pCurrChar = _skipSpace( pCurrChar, pInputEnd );
+                if( pCurrChar == pInputEnd ) { break; }
+
+                char token = *pCurrChar;
+                char closing = (pReformatter->depth && pReformatter->pContainers[pReformatter->depth - 1] == '{') ? '}' : ']';
+                if( pReformatter->afterOpen && token == closing ) { // empty
+                    _writeBytes( pOut, pCurrChar++, 1 );
+                    pReformatter->afterOpen = 0;
+                    pReformatter->depth--;
+                    pReformatter->state = _reformatAfterValue( pReformatter );
+                    break;
+                }
+                if( pretty && (pReformatter->state == _REFORMAT_KEY || closing == ']') && pReformatter->depth ) { // (an object value follows its key)
+                    _writeIndent( pOut, pReformatter->depth );
+                }
+                pReformatter->afterOpen = 0;
+
+                if( pReformatter->state == _REFORMAT_KEY ) {
+                    if( token != '"' ) {
+                        *ppError = pCurrChar;
+                        return _reformatError( pReformatter, JPE_SYNTAX_ERROR_OBJECT_KEY, 1 );
+                    }
+                    _writeBytes( pOut, pCurrChar++, 1 );
+                    pReformatter->isKey = 1;
+                    pReformatter->state = _REFORMAT_STRING;
+                }
+                else if( token == '{' || token == '[' ) {
+                    if( pReformatter->depth >= pReformatter->maxDepth ) {
+                        *ppError = pCurrChar;
+                        return JPE_NESTING_TOO_DEEP;
+                    }
+                    if( pReformatter->depth == pReformatter->containerCapacity ) {
+                        size_t newCapacity = pReformatter->containerCapacity ? pReformatter->containerCapacity * 2 : 64;
+                        char *pNewContainers = (char *)_reallocWith( pReformatter->pAllocator, pReformatter->pContainers, newCapacity );
+                        if( !pNewContainers ) {
+                            *ppError = pCurrChar;
+                            return JPE_OUT_OF_MEMORY;
+                        }
+                        pReformatter->pContainers = pNewContainers;
+                        pReformatter->containerCapacity = newCapacity;
+                    }
+                    pReformatter->pContainers[pReformatter->depth++] = token;
+                    _writeBytes( pOut, pCurrChar++, 1 );
+                    pReformatter->afterOpen = 1;
+                    pReformatter->state = (token == '{') ? _REFORMAT_KEY : _REFORMAT_VALUE;
+                }
+                else if( token == '"' ) {
+                    _writeBytes( pOut, pCurrChar++, 1 );
+                    pReformatter->isKey = 0;
+                    pReformatter->state = _REFORMAT_STRING;
+                }
+                else if( _isLiteralChar(token) ) {
+                    pReformatter->tokenSize = 0;
+                    pReformatter->state = _REFORMAT_TOKEN;
+                }
+                else {
+                    *ppError = pCurrChar;
+                    return _reformatError( pReformatter, JPE_SYNTAX_ERROR, 0 );
+                }
+            }
+            break;
+
+            case _REFORMAT_STRING:
+            {
+                if( pReformatter->escape ) {
+                    char c = *pCurrChar;
+                    if( pReformatter->escape == 1 ) {
+                        switch( c ) {
+                            case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+                                pReformatter->escape = 0;
+                                break;
+                            case 'u':
+                                pReformatter->escape = 5;
+                                break;
+                            default:
+                                *ppError = pCurrChar;
+                                return _reformatStringError( pReformatter, JPE_SYNTAX_ERROR_STRING_ESCAPE );
+                        }
+                    }
+                    else {
+                        if( !_isHexDigit(c) ) { // (reported at the 'u')
+                            *ppError = pCurrChar;
+                            pReformatter->errorBack = (size_t)(6 - pReformatter->escape);
+                            return _reformatStringError( pReformatter, JPE_SYNTAX_ERROR_UNICODE_ESCAPE );
+                        }
+                        pReformatter->escape = (pReformatter->escape == 2) ? 0 : pReformatter->escape - 1;
+                    }
+                    _writeBytes( pOut, pCurrChar++, 1 );
+                    break;
+                }
+
+                const char *pRunEnd = _scanString( pCurrChar, pInputEnd );
+                if( pRunEnd > pCurrChar ) { _writeBytes( pOut, pCurrChar, (size_t)(pRunEnd - pCurrChar) ); }
+                pCurrChar = pRunEnd;
+                if( pCurrChar == pInputEnd ) { break; }
+
+                if( *pCurrChar == '"' ) {
+                    _writeBytes( pOut, pCurrChar++, 1 );
+                    pReformatter->state = pReformatter->isKey ? _REFORMAT_COLON : _reformatAfterValue( pReformatter );
+                }
+                else if( *pCurrChar == '\\' ) {
+                    _writeBytes( pOut, pCurrChar++, 1 );
+                    pReformatter->escape = 1;
+                }
+                else { // control character
+                    *ppError = pCurrChar;
+                    return _reformatStringError( pReformatter, JPE_SYNTAX_ERROR_STRING_CONTROL );
+                }
+            }
+            break;
+
+            case _REFORMAT_TOKEN:
+            {
+                const char *pStart = pCurrChar;
+                while( pCurrChar < pInputEnd && _isLiteralChar(*pCurrChar) ) { pCurrChar++; }
+                if( pCurrChar == pInputEnd ) { // (may go on in the next chunk)
+                    if( !_appendToken( pReformatter, pStart, (size_t)(pCurrChar - pStart) ) ) {
+                        *ppError = pStart;
+                        return JPE_OUT_OF_MEMORY;
+                    }
+                    break;
+                }
+
+                if( pReformatter->tokenSize ) {
+                    if( !_appendToken( pReformatter, pStart, (size_t)(pCurrChar - pStart) ) ) {
+                        *ppError = pStart;
+                        return JPE_OUT_OF_MEMORY;
+                    }
+                    pStart = pReformatter->pToken;
+                }
+                size_t size = pReformatter->tokenSize ? pReformatter->tokenSize : (size_t)(pCurrChar - pStart);
+                size_t errorOffset = 0;
+                JsonParsingError ret = _reformatToken( pReformatter, pStart, size, &errorOffset );
+                if( ret != JPE_NO_ERROR ) {
+                    *ppError = pCurrChar; // (the token may have begun in an earlier chunk)
+                    pReformatter->errorBack = size - errorOffset;
+                    return ret;
+                }
+            }
+            break;
+
+            case _REFORMAT_COLON:
+            {
+                pCurrChar = _skipSpace( pCurrChar, pInputEnd );
+                if( pCurrChar == pInputEnd ) { break; }
+                if( *pCurrChar != ':' ) {
+                    *ppError = pCurrChar;
+                    return _reformatError( pReformatter, JPE_SYNTAX_ERROR_OBJECT_COLON, 1 );
+                }
+                _writeBytes( pOut, ": ", pretty ? 2 : 1 );
+                pCurrChar++;
+                pReformatter->state = _REFORMAT_VALUE;
+            }
+            break;
+
+            case _REFORMAT_AFTER_VALUE:
+            {
+                pCurrChar = _skipSpace( pCurrChar, pInputEnd );
+                if( pCurrChar == pInputEnd ) { break; }
+
+                char container = pReformatter->pContainers[pReformatter->depth - 1];
+                if( *pCurrChar == ',' ) {
+                    _writeBytes( pOut, pCurrChar++, 1 );
+                    pReformatter->state = (container == '{') ? _REFORMAT_KEY : _REFORMAT_VALUE;
+                }
+                else if( *pCurrChar == ((container == '{') ? '}' : ']') ) {
+                    pReformatter->depth--;
+                    if( pretty ) { _writeIndent( pOut, pReformatter->depth ); }
+                    _writeBytes( pOut, pCurrChar++, 1 );
+                    pReformatter->state = _reformatAfterValue( pReformatter );
+                }
+                else {
+                    *ppError = pCurrChar;
+                    return _reformatError( pReformatter, (container == '{') ? JPE_SYNTAX_ERROR_OBJECT_COMMA : JPE_SYNTAX_ERROR_ARRAY_COMMA, 1 );
+                }
+            }
+            break;
+
+            case _REFORMAT_DONE:
+            {
+                pCurrChar = _skipSpace( pCurrChar, pInputEnd );
+                if( pCurrChar != pInputEnd ) {
+                    *ppError = pCurrChar;
+                    return JPE_SYNTAX_ERROR;
+                }
+            }
+            break;
+        }
+    }
+
+    if( pOut->failed ) {
+        *ppError = pInputEnd;
+        return JPE_IO_ERROR;
+    }
+    return JPE_NO_ERROR;
+}
+
+static JsonParsingError _reformatterResult(JsonReformatter *pReformatter, JsonErrorInfo* pOutErrorInfo)
+{
+    if( pOutErrorInfo ) { *pOutErrorInfo = pReformatter->result; }
+    return pReformatter->result.error;
+}
+
+JsonReformatter *createJsonReformatter(uint32_t flags, const JsonParseOptions *pOptions, JsonSink pSink, void *pSinkData)
+{
+    if( !pSink ) { return (JsonReformatter *)0; }
+
+    const JsonAllocator *pAllocator = pOptions ? pOptions->pAllocator : (const JsonAllocator *)0;
+    JsonReformatter *pReformatter = (JsonReformatter *)_callocWith( pAllocator, sizeof(JsonReformatter) );
+    char *pBuffer = (char *)_mallocWith( pAllocator, JSON_REFORMAT_BUFFER_SIZE );
+    if( !pReformatter || !pBuffer ) {
+        _freeWith( pAllocator, pReformatter );
+        _freeWith( pAllocator, pBuffer );
+        return (JsonReformatter *)0;
+    }
+
+    pReformatter->out.pBuffer = pBuffer;
+    pReformatter->out.capacity = JSON_REFORMAT_BUFFER_SIZE;
+    pReformatter->out.pSink = pSink;
+    pReformatter->out.pSinkData = pSinkData;
+    pReformatter->flags = flags;
+    pReformatter->state = _REFORMAT_VALUE;
+    pReformatter->counting = 1;
+    pReformatter->line = 1;
+    pReformatter->column = 1;
+    pReformatter->result.line = 1;
+    pReformatter->result.column = 1;
+    pReformatter->maxDepth = (pOptions && pOptions->maxDepth) ? pOptions->maxDepth : JSON_DEFAULT_MAX_DEPTH;
+    pReformatter->pAllocator = pAllocator;
+    return pReformatter;
+}
+
+JsonParsingError jsonReformatterFeed(JsonReformatter *pReformatter, const char *chunk, size_t length, JsonErrorInfo* pOutErrorInfo)
+{
+    if( pReformatter->result.error != JPE_NO_ERROR || !chunk || !length ) { return _reformatterResult( pReformatter, pOutErrorInfo ); }
+
+    const char *pError = (const char *)0;
+    JsonParsingError ret = _reformatChunk( pReformatter, chunk, chunk + length, &pError );
+    if( ret != JPE_NO_ERROR ) {
+        pReformatter->result.error = ret;
+        _locate( &(pReformatter->result), pReformatter->line, pReformatter->column, chunk, pError, chunk + length );
+        if( pReformatter->errorBack ) { // (counted up to pError, then back on the same line)
+            size_t line = pReformatter->line, column = pReformatter->column;
+            _countLocation( &line, &column, chunk, pError );
+            pReformatter->result.line = line;
+            pReformatter->result.column = column + 1 - pReformatter->errorBack;
+        }
+        pReformatter->result.position += pReformatter->position - pReformatter->errorBack;
+    }
+    else if( pReformatter->counting ) {
+        _countLocation( &(pReformatter->line), &(pReformatter->column), chunk, chunk + length );
+    }
+    pReformatter->position += length;
+    return _reformatterResult( pReformatter, pOutErrorInfo );
+}
+
+JsonParsingError jsonReformatterFinish(JsonReformatter *pReformatter, JsonErrorInfo* pOutErrorInfo)
+{
+    if( pReformatter->result.error == JPE_NO_ERROR ) {
+        JsonParsingError ret = JPE_NO_ERROR;
+        size_t errorBack = 0;
+        if( pReformatter->state == _REFORMAT_TOKEN ) { // ended by the end of the input
+            size_t errorOffset = 0;
+            ret = _reformatToken( pReformatter, pReformatter->pToken, pReformatter->tokenSize, &errorOffset );
+            if( ret != JPE_NO_ERROR ) { errorBack = pReformatter->tokenSize - errorOffset; }
+        }
+        if( ret == JPE_NO_ERROR ) {
+            if( pReformatter->state == _REFORMAT_STRING ) {
+                if( pReformatter->escape >= 2 ) { // "\u" with less than 4 hex digits (reported at the 'u')
+                    errorBack = (size_t)(6 - pReformatter->escape);
+                    ret = _reformatStringError( pReformatter, JPE_SYNTAX_ERROR_UNICODE_ESCAPE );
+                }
+                else {
+                    ret = _reformatStringError( pReformatter, JPE_SYNTAX_ERROR_END );
+                }
+            }
+            else if( pReformatter->state == _REFORMAT_KEY ) {
+                ret = _reformatError( pReformatter, JPE_SYNTAX_ERROR_OBJECT_KEY, 1 );
+            }
+            // Whitespace alone is an unfinished document (as the parser reports it); no input at all is not
+            else if( pReformatter->state != _REFORMAT_DONE && pReformatter->position ) {
+                ret = JPE_SYNTAX_ERROR_END;
+            }
+        }
+        _flushOutput( &(pReformatter->out) );
+        if( ret == JPE_NO_ERROR && pReformatter->out.failed ) { ret = JPE_IO_ERROR; }
+
+        // Location: the end of the input (or a token / escape just before it, on the same line)
+        pReformatter->result.error = ret;
+        pReformatter->result.line = pReformatter->line;
+        pReformatter->result.column = pReformatter->column + 1 - errorBack;
+        pReformatter->result.position = pReformatter->position - errorBack;
+    }
+    return _reformatterResult( pReformatter, pOutErrorInfo );
+}
+
+void releaseJsonReformatter(JsonReformatter *pReformatter)
+{
+    if( pReformatter ) {
+        const JsonAllocator *pAllocator = pReformatter->pAllocator;
+        _freeWith( pAllocator, pReformatter->out.pBuffer );
+        _freeWith( pAllocator, pReformatter->pToken );
+        _freeWith( pAllocator, pReformatter->pContainers );
+        _freeWith( pAllocator, pReformatter );
+    }
+}
+
+JsonParsingError reformatJson(const char *data, size_t length, uint32_t flags, const JsonParseOptions *pOptions, JsonSink pSink, void *pSinkData, JsonErrorInfo* pOutErrorInfo)
+{
+    JsonReformatter *pReformatter = createJsonReformatter( flags, pOptions, pSink, pSinkData );
+    if( !pReformatter ) { return _errorWithoutLocation( pOutErrorInfo, pSink ? JPE_OUT_OF_MEMORY : JPE_INVALID_ARGUMENT ); }
+
+    pReformatter->counting = 0; // (located from data instead)
+    JsonParsingError ret = jsonReformatterFeed( pReformatter, data, length, pOutErrorInfo );
+    if( ret == JPE_NO_ERROR ) {
+        ret = jsonReformatterFinish( pReformatter, pOutErrorInfo );
+        if( pOutErrorInfo && data ) { _errorLocation( pOutErrorInfo, data, data + pOutErrorInfo->position, data + length ); }
+    }
+    releaseJsonReformatter( pReformatter );
+    return ret;
+}
+
+// Read in JSON_REFORMAT_BUFFER_SIZE chunks: memory does not depend on the size of the file
+JsonParsingError reformatJsonFile(const char *path, uint32_t flags, const JsonParseOptions *pOptions, JsonSink pSink, void *pSinkData, JsonErrorInfo* pOutErrorInfo)
+{
+    FILE *fp = path ? fopen( path, "rb" ) : (FILE *)0;
+    if( !fp ) { return _errorWithoutLocation( pOutErrorInfo, JPE_IO_ERROR ); }
+
+    const JsonAllocator *pAllocator = pOptions ? pOptions->pAllocator : (const JsonAllocator *)0;
+    JsonReformatter *pReformatter = createJsonReformatter( flags, pOptions, pSink, pSinkData );
+    char *pChunk = (char *)_mallocWith( pAllocator, JSON_REFORMAT_BUFFER_SIZE );
+    JsonParsingError ret = (pReformatter && pChunk) ? JPE_NO_ERROR : _errorWithoutLocation( pOutErrorInfo, pSink ? JPE_OUT_OF_MEMORY : JPE_INVALID_ARGUMENT );
+    while( ret == JPE_NO_ERROR ) {
+        size_t readBytes = fread( pChunk, 1, JSON_REFORMAT_BUFFER_SIZE, fp );
+        if( readBytes == 0 ) {
+            ret = ferror( fp ) ? _errorWithoutLocation( pOutErrorInfo, JPE_IO_ERROR ) : jsonReformatterFinish( pReformatter, pOutErrorInfo );
+            break;
+        }
+        ret = jsonReformatterFeed( pReformatter, pChunk, readBytes, pOutErrorInfo );
+    }
+
+    fclose( fp );
+    _freeWith( pAllocator, pChunk );
+    releaseJsonReformatter( pReformatter );
+    return ret;
+}
+
+int jsonFileSink(void *pFile, const char *data, size_t length)
+{
+    return fwrite( data, 1, length, (FILE *)pFile ) == length ? 0 : -1;
+}
+
+int jsonFdSink(void *pFd, const char *data, size_t length)
+{
+#if _HAVE_MMAP_
+    while( length ) {
+        ssize_t written = write( *(int *)pFd, data, length );
+        if( written < 0 ) {
+            if( errno == EINTR ) { continue; }
+            return -1;
+        }
+        data += written;
+        length -= (size_t)written;
+    }
+    return 0;
+#else
+    (void)pFd;
+    (void)data;
+    (void)length;
+    return -1;
+#endif
+}
+
+//
+// Binary Snapshot
+// ** Image: a _SnapshotHeader, then records at 8-byte aligned offsets from the start of the image (no pointers).
+// ** A value is a 64-bit slot: its ElementType in the low 3 bits, _SNAPSHOT_BOXED, and a payload in the upper bits:
+//    - TYPE_NULL: 0, TYPE_BOOLEAN: 0 / 1
+//    - TYPE_INT_NUMBER: the value itself (60 bits), or boxed: the offset of 8 bytes holding it
+//    - TYPE_DBL_NUMBER: the bits of the double if their low 4 bits are 0 (in place), or boxed: the offset of 8 bytes
+//    - TYPE_STRING: the offset of a string record { uint32_t length; char bytes[length]; '\0' }
+//    - TYPE_ARRAY: the offset of { uint32_t length; uint32_t 0; uint64_t slots[length] }
+//    - TYPE_OBJECT: the offset of { uint32_t length; uint32_t 0; _SnapshotMember members[length]; key index },
+//      the key index being the one of findMember() (`member index + 1`, for JSON_OBJECT_INDEX_THRESHOLD members or more)
+// ** Keys are string records shared by equal keys. Containers are laid out breadth first.
+// ** Reading does not trust the image: every offset is checked against its length (a bad one reads as an empty value).
+//
+#define _SNAPSHOT_MAGIC      "JSNB"
+#define _SNAPSHOT_VERSION    1
+#define _SNAPSHOT_BYTE_ORDER 0x0102
+#define _SNAPSHOT_BOXED      0x8
+#define _SNAPSHOT_TAG_MASK   0xF
+#define _SNAPSHOT_INLINE_MIN (-((int64_t)1 << 59))
+#define _SNAPSHOT_INLINE_MAX (((int64_t)1 << 59) - 1)
+
+// Record sizes: fixed bytes + length * item bytes
+#define _SNAPSHOT_STRING_FIXED    (sizeof(uint32_t) + 1)
+#define _SNAPSHOT_CONTAINER_FIXED 8
+
+typedef struct
+{
+    char     magic[4];
+    uint16_t version;
+    uint16_t byteOrder; // _SNAPSHOT_BYTE_ORDER as written (numbers are in the byte order of the writer)
+    uint32_t length;    // bytes of the image
+    uint32_t reserved;
+    uint64_t root;      // slot of the root value
+} _SnapshotHeader;
+
+typedef struct
+{
+    uint32_t keyOffset; // string record
+    uint32_t keyHash;   // _hashKey()
+    uint64_t slot;
+} _SnapshotMember;
+
+typedef struct
+{
+    const Element *pElement; // TYPE_ARRAY or TYPE_OBJECT
+    uint32_t       offset;   // its record (slots still 0)
+} _SnapshotJob;
+
+typedef struct
+{
+    uint32_t offset; // string record, 0: empty entry
+    uint32_t hash;
+} _SnapshotKey;
 
-        default: break; // Token Error
-    }
+typedef struct
+{
+    _JsonOutput   out;         // the image (growable)
+    _SnapshotJob *pJobs;       // containers to fill, in layout order
+    size_t        jobCount;
+    size_t        jobCapacity;
+    _SnapshotKey *pKeys;       // open addressing table of the keys written so far
+    size_t        keyCount;
+    size_t        keyCapacity; // power of two
+} _SnapshotBuilder;
 
-    *ppEnd = pCurrChar;
-    return JPE_SYNTAX_ERROR;
+static inline uint32_t _loadU32(const char *pBytes)
+{
+    uint32_t value;
+    memcpy( &value, pBytes, sizeof(value) );
+    return value;
 }
 
-JsonParsingError parseObject(const char *pCurrChar, const char **ppEnd, Element *pElement)
+static inline uint64_t _loadU64(const char *pBytes)
 {
-    if( *pCurrChar != '{' ) { 
-        *ppEnd = pCurrChar;
-        return JPE_SYNTAX_ERROR;
-    }
-    pCurrChar++;
+    uint64_t value;
+    memcpy( &value, pBytes, sizeof(value) );
+    return value;
+}
 
-    const char *ptrEnd = (const char *)0;
-    ObjectNode *pHead = (ObjectNode *)0;
-    ObjectNode *pTail = (ObjectNode *)0;
-
-    // Check Empty Object
-    while( isspace(*pCurrChar) ) { pCurrChar++; }
-    if( *pCurrChar == '}' ) {
-        // Empty Object
-        *ppEnd = pCurrChar + 1;
-        pElement->type = TYPE_OBJECT;
-        pElement->objectValue = (ObjectNode *)0;
-        return JPE_NO_ERROR;
+// Offset of `size` zeroed bytes (8-byte aligned) at the end of the image, or 0 if out of memory or over 4 GiB
+static uint32_t _reserveSnapshot(_SnapshotBuilder *pBuilder, size_t size)
+{
+    size = (size + 7) & ~(size_t)7;
+    if( size > UINT32_MAX - pBuilder->out.size ) {
+        pBuilder->out.failed = 1;
+        return 0;
     }
+    char *pSpace = _outputSpace( &(pBuilder->out), size );
+    if( !pSpace ) { return 0; }
 
-    for(;;) 
-    {
-        // Get Key
-        char *keyString = (char *)0;
-        JsonParsingError ret = _getString(&keyString, pCurrChar, &ptrEnd);
-        if( ret != JPE_NO_ERROR ) {
-            if( ret == JPE_OUT_OF_MEMORY ) { return ret; }
-            // String Parse Error -> No String for Key
-            *ppEnd = ptrEnd;
-            return JPE_SYNTAX_ERROR_OBJECT_KEY;
-        }
+    uint32_t offset = (uint32_t)pBuilder->out.size;
+    memset( pSpace, 0, size );
+    pBuilder->out.size += size;
+    return offset;
+}
 
-        pCurrChar = ptrEnd;
-        while( isspace(*pCurrChar) ) { pCurrChar++; }
-        if( *pCurrChar != ':' ) {
-            free(keyString);
-            *ppEnd = pCurrChar;
-            return (*pCurrChar == '\0') ? JPE_SYNTAX_ERROR_END : JPE_SYNTAX_ERROR_OBJECT_COLON;
-        }
-        ++pCurrChar; 
-        while( isspace(*pCurrChar) ) { pCurrChar++; }
+static uint32_t _snapshotString(_SnapshotBuilder *pBuilder, const char *str, uint32_t length)
+{
+    uint32_t offset = _reserveSnapshot( pBuilder, _SNAPSHOT_STRING_FIXED + (size_t)length );
+    if( offset ) {
+        char *pRecord = pBuilder->out.pBuffer + offset;
+        memcpy( pRecord, &length, sizeof(length) );
+        if( length ) { memcpy( pRecord + sizeof(uint32_t), str, length ); } // ('\0' reserved)
+    }
+    return offset;
+}
 
-        // Allocate Element
-        ObjectNode *pNode = (ObjectNode *)calloc(1, sizeof(ObjectNode));
-        if( !pNode ) {
-            free(keyString);
-            if( pHead ) { // Release
-                Element e = { .type = TYPE_OBJECT, .objectValue = pHead };
-                resetElement( &e );
-            }
-            *ppEnd = pCurrChar;
-            return JPE_OUT_OF_MEMORY;
-        }
-        else {
-            pNode->key = keyString;
-            if( pTail ) {
-                pTail->next = pNode;
-                pTail = pNode;
-            }
-            else {
-                pHead = pNode;
-                pTail = pNode;
-            }
+// The string record of key: written once for equal keys
+static uint32_t _snapshotKey(_SnapshotBuilder *pBuilder, const char *key, uint32_t keyLength, uint32_t hash)
+{
+    if( pBuilder->keyCount * 2 >= pBuilder->keyCapacity ) {
+        size_t newCapacity = pBuilder->keyCapacity ? pBuilder->keyCapacity * 2 : 256;
+        _SnapshotKey *pNewKeys = (_SnapshotKey *)calloc( newCapacity, sizeof(_SnapshotKey) );
+        if( !pNewKeys ) {
+            pBuilder->out.failed = 1;
+            return 0;
         }
-        
-        // Parse Value Here!!
-        ret = parseValue( pCurrChar, &ptrEnd, &(pNode->element) );
-        if( ret != JPE_NO_ERROR ) {
-            if( pHead ) { // Release
-                Element e = { .type = TYPE_OBJECT, .objectValue = pHead };
-                resetElement( &e );
+        for( size_t i = 0; i < pBuilder->keyCapacity; i++ ) {
+            if( pBuilder->pKeys[i].offset ) {
+                size_t slot = pBuilder->pKeys[i].hash & (newCapacity - 1);
+                while( pNewKeys[slot].offset ) { slot = (slot + 1) & (newCapacity - 1); }
+                pNewKeys[slot] = pBuilder->pKeys[i];
             }
-            *ppEnd = ptrEnd;
-            return ret == JPE_SYNTAX_ERROR_END ? ret : JPE_SYNTAX_ERROR_OBJECT;
         }
-        pCurrChar = ptrEnd;
+        free( pBuilder->pKeys );
+        pBuilder->pKeys = pNewKeys;
+        pBuilder->keyCapacity = newCapacity;
+    }
 
-        // Check "," or "}"
-        while( isspace(*pCurrChar) ) { pCurrChar++; }
-        if( *pCurrChar == ',' ) {
-            pCurrChar++;
-            while( isspace(*pCurrChar) ) { pCurrChar++; }
-            continue;
-        }
-        else if( *pCurrChar == '}' ) {
-            // Parsing Done
-            pCurrChar++;
-            break;
-        }
-        else {
-            *ppEnd = pCurrChar; 
-            return (*pCurrChar == '\0') ? JPE_SYNTAX_ERROR_END : JPE_SYNTAX_ERROR_OBJECT_COMMA;
+    size_t slot = hash & (pBuilder->keyCapacity - 1);
+    while( pBuilder->pKeys[slot].offset ) {
+        const char *pRecord = pBuilder->out.pBuffer + pBuilder->pKeys[slot].offset;
+        if( pBuilder->pKeys[slot].hash == hash && _loadU32( pRecord ) == keyLength && !memcmp( pRecord + sizeof(uint32_t), key, keyLength ) ) {
+            return pBuilder->pKeys[slot].offset;
         }
+        slot = (slot + 1) & (pBuilder->keyCapacity - 1);
     }
 
-    pElement->type = TYPE_OBJECT;
-    pElement->objectValue = pHead;
-    *ppEnd = pCurrChar;
-
-    return JPE_NO_ERROR;
+    uint32_t offset = _snapshotString( pBuilder, key, keyLength );
+    if( offset ) {
+        pBuilder->pKeys[slot].offset = offset;
+        pBuilder->pKeys[slot].hash = hash;
+        pBuilder->keyCount++;
+    }
+    return offset;
 }
 
-JsonParsingError parseArray(const char *pCurrChar, const char **ppEnd, Element *pElement)
+static size_t _snapshotRecordBytes(const Element *pElement)
 {
-    if( *pCurrChar != '[' ) { 
-        *ppEnd = pCurrChar;
-        return JPE_SYNTAX_ERROR;
+    if( pElement->type == TYPE_ARRAY ) {
+        return _SNAPSHOT_CONTAINER_FIXED + (size_t)pElement->length * sizeof(uint64_t);
     }
-    pCurrChar++;
+    return _SNAPSHOT_CONTAINER_FIXED + (size_t)pElement->length * sizeof(_SnapshotMember) + _objectIndexBytes( pElement->length );
+}
 
-    const char *ptrEnd = (const char *)0;
-    ArrayNode *pHead = (ArrayNode *)0;
-    ArrayNode *pTail = (ArrayNode *)0;
-
-    // Check Empty Array
-    while( isspace(*pCurrChar) ) { pCurrChar++; }
-    if( *pCurrChar == ']' ) {
-        // Empty Array
-        *ppEnd = pCurrChar + 1;
-        pElement->type = TYPE_ARRAY;
-        pElement->arrayValue = (ArrayNode *)0;
-        return JPE_NO_ERROR;
-    }
+// Slot of pElement; containers get an empty record and are queued. Returns 0 if out of memory.
+static int _snapshotSlot(_SnapshotBuilder *pBuilder, const Element *pElement, uint64_t *pOutSlot)
+{
+    uint32_t offset = 0;
+    switch( pElement->type )
+    {
+        case TYPE_BOOLEAN:
+            *pOutSlot = ((uint64_t)(pElement->iNumberValue != 0) << 4) | TYPE_BOOLEAN;
+            return 1;
 
-    // Prasing Array
-    for(;;) {
-        // Allocate Element
-        ArrayNode *pNode = (ArrayNode *)calloc( 1, sizeof(ArrayNode) );
-        if( !pNode ) {
-            if( pHead ) { // Release
-                Element e = { .type = TYPE_ARRAY, .arrayValue = pHead };
-                resetElement(&e);
-            }
-            *ppEnd = pCurrChar;
-            return JPE_OUT_OF_MEMORY;
-        }
-        else { // Append Node
-            if( pTail ) {
-                pTail->next = pNode;
-                pTail = pNode;
+        case TYPE_INT_NUMBER:
+            if( pElement->iNumberValue >= _SNAPSHOT_INLINE_MIN && pElement->iNumberValue <= _SNAPSHOT_INLINE_MAX ) {
+                *pOutSlot = ((uint64_t)pElement->iNumberValue << 4) | TYPE_INT_NUMBER;
+                return 1;
             }
-            else {
-                pHead = pNode;
-                pTail = pNode;
+            offset = _reserveSnapshot( pBuilder, sizeof(int64_t) );
+            if( offset ) { memcpy( pBuilder->out.pBuffer + offset, &(pElement->iNumberValue), sizeof(int64_t) ); }
+            *pOutSlot = ((uint64_t)offset << 4) | _SNAPSHOT_BOXED | TYPE_INT_NUMBER;
+            break;
+
+        case TYPE_DBL_NUMBER:
+        {
+            uint64_t bits;
+            memcpy( &bits, &(pElement->dNumberValue), sizeof(bits) );
+            if( !(bits & _SNAPSHOT_TAG_MASK) ) {
+                *pOutSlot = bits | TYPE_DBL_NUMBER;
+                return 1;
             }
+            offset = _reserveSnapshot( pBuilder, sizeof(double) );
+            if( offset ) { memcpy( pBuilder->out.pBuffer + offset, &bits, sizeof(bits) ); }
+            *pOutSlot = ((uint64_t)offset << 4) | _SNAPSHOT_BOXED | TYPE_DBL_NUMBER;
         }
+        break;
 
-        // Parse Value Here!!
-        JsonParsingError ret = parseValue( pCurrChar, &ptrEnd, &(pNode->element) );
-        if( ret != JPE_NO_ERROR ) {
-            if( pHead ) { // Release
-                Element e = { .type = TYPE_ARRAY, .arrayValue = pHead };
-                resetElement(&e);
+        case TYPE_STRING:
+            offset = _snapshotString( pBuilder, pElement->stringValue, pElement->length );
+            *pOutSlot = ((uint64_t)offset << 4) | TYPE_STRING;
+            break;
+
+        case TYPE_ARRAY:
+        case TYPE_OBJECT:
+            if( pBuilder->jobCount == pBuilder->jobCapacity ) {
+                size_t newCapacity = pBuilder->jobCapacity ? pBuilder->jobCapacity * 2 : 64;
+                _SnapshotJob *pNewJobs = (_SnapshotJob *)realloc( pBuilder->pJobs, newCapacity * sizeof(_SnapshotJob) );
+                if( !pNewJobs ) { return 0; }
+                pBuilder->pJobs = pNewJobs;
+                pBuilder->jobCapacity = newCapacity;
             }
-            *ppEnd = ptrEnd;
-            return (ret == JPE_SYNTAX_ERROR_END) ? ret : JPE_SYNTAX_ERROR_ARRAY;
-        }
-        pCurrChar = ptrEnd;
+            offset = _reserveSnapshot( pBuilder, _snapshotRecordBytes( pElement ) );
+            if( offset ) {
+                memcpy( pBuilder->out.pBuffer + offset, &(pElement->length), sizeof(uint32_t) );
+                pBuilder->pJobs[pBuilder->jobCount].pElement = pElement;
+                pBuilder->pJobs[pBuilder->jobCount].offset = offset;
+                pBuilder->jobCount++;
+            }
+            *pOutSlot = ((uint64_t)offset << 4) | pElement->type;
+            break;
 
-        // Check "," or "]"
-        while( isspace(*pCurrChar) ) { pCurrChar++; }
-        if( *pCurrChar == ',' ) {
-            pCurrChar++;
-            while( isspace(*pCurrChar) ) { pCurrChar++; }
-            continue;
+        default:
+            *pOutSlot = TYPE_NULL;
+            return 1;
+    }
+    return offset != 0;
+}
+
+// Slots of the members / elements of a queued container
+static int _fillSnapshotRecord(_SnapshotBuilder *pBuilder, const _SnapshotJob *pJob)
+{
+    const Element *pElement = pJob->pElement;
+    uint64_t slot;
+
+    if( pElement->type == TYPE_ARRAY ) {
+        for( uint32_t i = 0; i < pElement->length; i++ ) {
+            if( !_snapshotSlot( pBuilder, &(pElement->arrayValue[i]), &slot ) ) { return 0; }
+            memcpy( pBuilder->out.pBuffer + pJob->offset + _SNAPSHOT_CONTAINER_FIXED + (size_t)i * sizeof(uint64_t), &slot, sizeof(slot) );
         }
-        else if( *pCurrChar == ']' ) {
-            // Parsing Done
-            pCurrChar++;
-            break;
+        return 1;
+    }
+
+    size_t capacity = _objectIndexCapacity( pElement->length );
+    uint32_t *pSlots = capacity ? (uint32_t *)calloc( capacity, sizeof(uint32_t) ) : (uint32_t *)0;
+    if( capacity && !pSlots ) { return 0; }
+
+    for( uint32_t i = 0; i < pElement->length; i++ ) {
+        const ObjectNode *pNode = &(pElement->objectValue[i]);
+        _SnapshotMember member;
+        member.keyHash = _hashKey( pNode->key, pNode->keyLength );
+        member.keyOffset = _snapshotKey( pBuilder, pNode->key, pNode->keyLength, member.keyHash );
+        if( !member.keyOffset || !_snapshotSlot( pBuilder, &(pNode->element), &(member.slot) ) ) {
+            free( pSlots );
+            return 0;
         }
-        else {
-            *ppEnd = pCurrChar;
-            return (*pCurrChar == '\0') ? JPE_SYNTAX_ERROR_END : JPE_SYNTAX_ERROR_ARRAY_COMMA;
+        memcpy( pBuilder->out.pBuffer + pJob->offset + _SNAPSHOT_CONTAINER_FIXED + (size_t)i * sizeof(_SnapshotMember), &member, sizeof(member) );
+
+        if( capacity ) {
+            size_t index = member.keyHash & (capacity - 1);
+            while( pSlots[index] ) { index = (index + 1) & (capacity - 1); }
+            pSlots[index] = i + 1;
         }
     }
+    if( capacity ) {
+        memcpy( pBuilder->out.pBuffer + pJob->offset + _SNAPSHOT_CONTAINER_FIXED + (size_t)pElement->length * sizeof(_SnapshotMember), pSlots, capacity * sizeof(uint32_t) );
+        free( pSlots );
+    }
+    return 1;
+}
 
-    pElement->type = TYPE_ARRAY;
-    pElement->arrayValue = pHead;
-    *ppEnd = pCurrChar;
+char *createJsonSnapshot(const Element *pElement, size_t *pOutLength)
+{
+    _SnapshotBuilder builder = { .out = { .growable = 1, }, };
+    _SnapshotHeader header = { .magic = _SNAPSHOT_MAGIC, .version = _SNAPSHOT_VERSION, .byteOrder = _SNAPSHOT_BYTE_ORDER, };
 
-    return JPE_NO_ERROR;
+    int ok = ( pElement && _reserveSnapshot( &builder, sizeof(_SnapshotHeader) ) == 0 && !builder.out.failed ); // (the header is at 0)
+    ok = ok && _snapshotSlot( &builder, pElement, &(header.root) );
+    for( size_t i = 0; ok && i < builder.jobCount; i++ ) { // (jobs are added while filling)
+        _SnapshotJob job = builder.pJobs[i];
+        ok = _fillSnapshotRecord( &builder, &job );
+    }
+    free( builder.pJobs );
+    free( builder.pKeys );
+
+    if( !ok || builder.out.failed ) {
+        free( builder.out.pBuffer );
+        return (char *)0;
+    }
+    header.length = (uint32_t)builder.out.size;
+    memcpy( builder.out.pBuffer, &header, sizeof(header) );
+    if( pOutLength ) { *pOutLength = builder.out.size; }
+    return builder.out.pBuffer;
 }
 
-JsonParsingError parseString(const char *pCurrChar, const char **ppEnd, Element *pElement)
+JsonParsingError saveJsonSnapshot(const Element *pElement, const char *path)
 {
-    char *stringValue = (char *)0; 
-    JsonParsingError ret = _getString( &stringValue, pCurrChar, ppEnd );
-    if( ret == JPE_NO_ERROR ) {
-        pElement->type = TYPE_STRING;
-        pElement->stringValue = stringValue;
+    size_t length;
+    char *pImage = createJsonSnapshot( pElement, &length );
+    if( !pImage ) { return pElement ? JPE_OUT_OF_MEMORY : JPE_INVALID_ARGUMENT; }
+
+    FILE *fp = path ? fopen( path, "wb" ) : (FILE *)0;
+    int written = fp && fwrite( pImage, 1, length, fp ) == length;
+    if( fp && fclose( fp ) != 0 ) { written = 0; }
+    free( pImage );
+    return written ? JPE_NO_ERROR : JPE_IO_ERROR;
+}
+
+// Checks the header only: O(1) whatever the size of the image
+static JsonParsingError _openSnapshot(JsonSnapshot *pSnapshot, const char *data, size_t length)
+{
+    _SnapshotHeader header;
+    if( length < sizeof(header) ) { return JPE_INVALID_SNAPSHOT; }
+    memcpy( &header, data, sizeof(header) );
+    if( memcmp( header.magic, _SNAPSHOT_MAGIC, sizeof(header.magic) ) != 0 || header.version != _SNAPSHOT_VERSION ||
+        header.byteOrder != _SNAPSHOT_BYTE_ORDER || header.length != length ) {
+        return JPE_INVALID_SNAPSHOT;
     }
-    return ret;
+
+    pSnapshot->data = data;
+    pSnapshot->length = length;
+    pSnapshot->root = header.root;
+    return JPE_NO_ERROR;
 }
 
-JsonParsingError parseNumber(const char *pCurrChar, const char **ppEnd, Element *pElement)
+JsonParsingError openJsonSnapshotBuffer(JsonSnapshot *pSnapshot, const char *data, size_t length)
 {
-    // Check Octal, Hex, Decimal or Floating Point Number
-    char *ptrEnd = (char *)0;
-    const char *pTmp = pCurrChar;
+    pSnapshot->owned = 0;
+    if( !data ) { return JPE_INVALID_ARGUMENT; }
+    return _openSnapshot( pSnapshot, data, length );
+}
 
-    if( *pTmp == '+' || *pTmp == '-' ) { ++pTmp; }
-#if _ALLOW_LOOSEN_NUMBER_FORMAT_ // allow hex, octal, c-style floating point
-    if( !isdigit(*pTmp) || *pTmp != '.' ) {
-        *ppEnd = pCurrChar;
-        return JPE_SYNTAX_ERROR;
-    }
+#if _HAVE_MMAP_
+JsonParsingError openJsonSnapshot(JsonSnapshot *pSnapshot, const char *path)
+{
+    pSnapshot->owned = 0;
+    int fd = path ? open( path, O_RDONLY ) : -1;
+    if( fd < 0 ) { return JPE_IO_ERROR; }
 
-    if( pTmp[0] == '0' ) {
-        if( pTmp[1] == 'x' || pTmp[1] == 'X' || isdigit(pTmp[1]) ) { // Hex or Octal
-            pElement->type = TYPE_INT_NUMBER;
-            pElement->iNumberValue = (int64_t)strtoll(pCurrChar, &ptrEnd, 0);
-        }
+    struct stat fileStat;
+    if( fstat( fd, &fileStat ) != 0 || !S_ISREG(fileStat.st_mode) || (uint64_t)fileStat.st_size > SIZE_MAX ) {
+        close( fd );
+        return JPE_IO_ERROR;
     }
-
-    if( !ptrEnd ) {
-        double val = strtod( pCurrChar, &ptrEnd );
-        if( fabs( ceil(val) - val ) <= DBL_EPSILON ) {
-            pElement->type = TYPE_INT_NUMBER;
-            pElement->iNumberValue = (int64_t)val;
-        }
-        else {
-            pElement->type = TYPE_DBL_NUMBER;
-            pElement->dNumberValue = val;
-        }
+    size_t fileSize = (size_t)fileStat.st_size;
+    if( fileSize < sizeof(_SnapshotHeader) ) { // (mmap() does not accept 0 bytes)
+        close( fd );
+        return JPE_INVALID_SNAPSHOT;
     }
 
-#else
-    if( !isdigit(*pTmp) ) {
-        *ppEnd = pCurrChar;
-        return JPE_SYNTAX_ERROR;
+    // Pages are read when an accessor first touches them
+    void *pData = mmap( (void *)0, fileSize, PROT_READ, MAP_PRIVATE, fd, 0 );
+    close( fd ); // the mapping stays valid
+    if( pData == MAP_FAILED ) { return JPE_IO_ERROR; }
+
+    JsonParsingError ret = _openSnapshot( pSnapshot, (const char *)pData, fileSize );
+    if( ret != JPE_NO_ERROR ) {
+        munmap( pData, fileSize );
+        return ret;
     }
-    
-    if( pTmp[0] == '0' ) {
-        // NOTE: strtod() function can parse hex string (e.g. 0x12)
-        if( pTmp[1] == 'x' || pTmp[1] == 'X' || isdigit(pTmp[1]) ) { // Hex or Octal
-            *ppEnd = pCurrChar;
-            return JPE_SYNTAX_ERROR;
-        }
+    pSnapshot->owned = 1;
+    return JPE_NO_ERROR;
+}
+#else
+// No mmap(): read the whole file into a buffer
+JsonParsingError openJsonSnapshot(JsonSnapshot *pSnapshot, const char *path)
+{
+    pSnapshot->owned = 0;
+    FILE *fp = path ? fopen( path, "rb" ) : (FILE *)0;
+    if( !fp ) { return JPE_IO_ERROR; }
+
+    long fileSize = ( fseek( fp, 0L, SEEK_END ) == 0 ) ? ftell( fp ) : -1L;
+    if( fileSize < 0 || fseek( fp, 0L, SEEK_SET ) != 0 ) {
+        fclose( fp );
+        return JPE_IO_ERROR;
     }
 
-    double val = strtod( pCurrChar, &ptrEnd );
-    if( fabs( ceil(val) - val ) <= DBL_EPSILON ) {
-        pElement->type = TYPE_INT_NUMBER;
-        pElement->iNumberValue = (int64_t)val;
+    char *pData = (char *)malloc( fileSize ? (size_t)fileSize : 1 );
+    if( !pData ) {
+        fclose( fp );
+        return JPE_OUT_OF_MEMORY;
     }
-    else {
-        pElement->type = TYPE_DBL_NUMBER;
-        pElement->dNumberValue = val;
+    size_t readBytes = fread( pData, 1, (size_t)fileSize, fp );
+    fclose( fp );
+
+    JsonParsingError ret = ( readBytes == (size_t)fileSize ) ? _openSnapshot( pSnapshot, pData, readBytes ) : JPE_IO_ERROR;
+    if( ret != JPE_NO_ERROR ) {
+        free( pData );
+        return ret;
     }
+    pSnapshot->owned = 1;
+    return JPE_NO_ERROR;
+}
 #endif
 
-    if( !ptrEnd ) {
-        *ppEnd = pCurrChar;
-        return JPE_SYNTAX_ERROR;
+void closeJsonSnapshot(JsonSnapshot *pSnapshot)
+{
+    if( pSnapshot->owned ) {
+    #if _HAVE_MMAP_
+        munmap( (void *)pSnapshot->data, pSnapshot->length );
+    #else
+        free( (void *)pSnapshot->data );
+    #endif
     }
+    pSnapshot->data = (const char *)0;
+    pSnapshot->length = 0;
+    pSnapshot->root = TYPE_NULL;
+    pSnapshot->owned = 0;
+}
 
-    *ppEnd = ptrEnd;
-    return JPE_NO_ERROR;
+JsonSnapshotValue getSnapshotRoot(const JsonSnapshot *pSnapshot)
+{
+    JsonSnapshotValue value = { pSnapshot, pSnapshot->root };
+    return value;
 }
 
-JsonParsingError parseBoolean(const char *pCurrChar, const char **ppEnd, Element *pElement)
+// The record of a slot, or `NULL` if it is not in the image
+static const char *_snapshotRecord(const JsonSnapshotValue *pValue, size_t fixedSize, size_t itemSize, uint32_t *pOutLength)
 {
-    if( *pCurrChar == 't' && !strncmp( pCurrChar, "true", 4 ) ) {
-        pElement->type = TYPE_BOOLEAN;
-        pElement->iNumberValue = 1;
-        *ppEnd = pCurrChar + 4;
-        return JPE_NO_ERROR;
-    }
-    else if( *pCurrChar == 'f' && !strncmp( pCurrChar, "false", 5 ) ) {
-        pElement->type = TYPE_BOOLEAN;
-        pElement->iNumberValue = 0;
-        *ppEnd = pCurrChar + 5;
-        return JPE_NO_ERROR;
-    }
-    
-    *ppEnd = pCurrChar;
-    return JPE_SYNTAX_ERROR;
+    uint64_t offset = pValue->slot >> 4;
+    const JsonSnapshot *pSnapshot = pValue->pSnapshot;
+    if( offset < sizeof(_SnapshotHeader) || offset > pSnapshot->length - fixedSize ) { return (const char *)0; }
+
+    const char *pRecord = pSnapshot->data + offset;
+    uint32_t length = _loadU32( pRecord );
+    if( (uint64_t)length * itemSize > pSnapshot->length - offset - fixedSize ) { return (const char *)0; }
+    *pOutLength = length;
+    return pRecord;
 }
 
-JsonParsingError parseNull(const char *pCurrChar, const char **ppEnd, Element *pElement)
+ElementType getSnapshotType(const JsonSnapshotValue *pValue)
 {
-    if( !strncmp( pCurrChar, "null", 4 ) ) {
-        pElement->type = TYPE_NULL;
-        pElement->iNumberValue = 0;
-        *ppEnd = pCurrChar + 4;
-        return JPE_NO_ERROR;
+    ElementType type = (ElementType)(pValue->slot & 0x7);
+    return (type <= TYPE_BOOLEAN) ? type : TYPE_NULL;
+}
+
+size_t getSnapshotLength(const JsonSnapshotValue *pValue)
+{
+    uint32_t length = 0;
+    switch( getSnapshotType( pValue ) )
+    {
+        case TYPE_STRING: _snapshotRecord( pValue, _SNAPSHOT_STRING_FIXED, 1, &length ); break;
+        case TYPE_ARRAY:  _snapshotRecord( pValue, _SNAPSHOT_CONTAINER_FIXED, sizeof(uint64_t), &length ); break;
+        case TYPE_OBJECT: _snapshotRecord( pValue, _SNAPSHOT_CONTAINER_FIXED, sizeof(_SnapshotMember), &length ); break;
+        default: break;
     }
-    
-    *ppEnd = pCurrChar;
-    return JPE_SYNTAX_ERROR;
+    return length;
 }
 
+int getSnapshotArrayElement(const JsonSnapshotValue *pArray, size_t index, JsonSnapshotValue *pOutValue)
+{
+    uint32_t length;
+    const char *pRecord = ( getSnapshotType( pArray ) == TYPE_ARRAY ) ? _snapshotRecord( pArray, _SNAPSHOT_CONTAINER_FIXED, sizeof(uint64_t), &length ) : (const char *)0;
+    if( !pRecord || index >= length ) { return 0; }
 
-void resetElement(Element *pElement)
+    pOutValue->pSnapshot = pArray->pSnapshot;
+    pOutValue->slot = _loadU64( pRecord + _SNAPSHOT_CONTAINER_FIXED + index * sizeof(uint64_t) );
+    return 1;
+}
+
+// Key of a member: checked against the image
+static const char *_snapshotKeyOf(const JsonSnapshot *pSnapshot, const _SnapshotMember *pMember, uint32_t *pOutLength)
 {
-    switch( pElement->type )
-    {
-        // No Additional Allocation
-        case TYPE_NULL:
-        case TYPE_DBL_NUMBER:
-        case TYPE_INT_NUMBER:
-        case TYPE_BOOLEAN:
-            break;
+    JsonSnapshotValue key = { pSnapshot, (uint64_t)pMember->keyOffset << 4 };
+    const char *pRecord = _snapshotRecord( &key, _SNAPSHOT_STRING_FIXED, 1, pOutLength );
+    return pRecord ? pRecord + sizeof(uint32_t) : (const char *)0;
+}
 
-        // Release Once
-        case TYPE_STRING:
-        {
-            free(pElement->stringValue);
-        }
-        break;
+int getSnapshotMember(const JsonSnapshotValue *pObject, size_t index, const char **pOutKey, size_t *pOutKeyLength, JsonSnapshotValue *pOutValue)
+{
+    uint32_t length, keyLength;
+    const char *pRecord = ( getSnapshotType( pObject ) == TYPE_OBJECT ) ? _snapshotRecord( pObject, _SNAPSHOT_CONTAINER_FIXED, sizeof(_SnapshotMember), &length ) : (const char *)0;
+    if( !pRecord || index >= length ) { return 0; }
 
-        case TYPE_OBJECT:
-        {
-            ObjectNode *pNode = pElement->objectValue;
-            while( pNode ) {
-                ObjectNode *pDelNode = pNode;
-                pNode = pNode->next;
+    _SnapshotMember member;
+    memcpy( &member, pRecord + _SNAPSHOT_CONTAINER_FIXED + index * sizeof(_SnapshotMember), sizeof(member) );
+    const char *key = _snapshotKeyOf( pObject->pSnapshot, &member, &keyLength );
+    if( !key ) { return 0; }
 
-                resetElement( &(pDelNode->element) );
-                free(pDelNode->key);
-                free(pDelNode);
-            }
-        }
-        break;
+    if( pOutKey ) { *pOutKey = key; }
+    if( pOutKeyLength ) { *pOutKeyLength = keyLength; }
+    pOutValue->pSnapshot = pObject->pSnapshot;
+    pOutValue->slot = member.slot;
+    return 1;
+}
 
-        case TYPE_ARRAY:
-        {
-            ArrayNode *pNode = pElement->arrayValue;
-            while( pNode ) {
-                ArrayNode *pDelNode = pNode;
-                pNode = pNode->next;
+int findSnapshotMember(const JsonSnapshotValue *pObject, const char *key, size_t keyLength, JsonSnapshotValue *pOutValue)
+{
+    uint32_t length, memberKeyLength;
+    const char *pRecord = ( getSnapshotType( pObject ) == TYPE_OBJECT ) ? _snapshotRecord( pObject, _SNAPSHOT_CONTAINER_FIXED, sizeof(_SnapshotMember), &length ) : (const char *)0;
+    if( !pRecord ) { return 0; }
 
-                resetElement( &(pDelNode->element) );
-                free(pDelNode);
+    const JsonSnapshot *pSnapshot = pObject->pSnapshot;
+    const char *pMembers = pRecord + _SNAPSHOT_CONTAINER_FIXED;
+    const char *pSlots = pMembers + (size_t)length * sizeof(_SnapshotMember);
+    size_t capacity = _objectIndexCapacity( length );
+    _SnapshotMember member;
+
+    if( capacity ) {
+        // Hashed Lookup
+        if( capacity * sizeof(uint32_t) > (size_t)(pSnapshot->data + pSnapshot->length - pSlots) ) { return 0; }
+        uint32_t hash = _hashKey( key, keyLength );
+        size_t slot = hash & (capacity - 1);
+        for( size_t probes = 0; probes < capacity; probes++ ) {
+            uint32_t index = _loadU32( pSlots + slot * sizeof(uint32_t) );
+            if( !index || index > length ) { break; }
+            memcpy( &member, pMembers + (size_t)(index - 1) * sizeof(_SnapshotMember), sizeof(member) );
+            if( member.keyHash == hash ) {
+                const char *memberKey = _snapshotKeyOf( pSnapshot, &member, &memberKeyLength );
+                if( memberKey && memberKeyLength == keyLength && !memcmp( memberKey, key, keyLength ) ) {
+                    pOutValue->pSnapshot = pSnapshot;
+                    pOutValue->slot = member.slot;
+                    return 1;
+                }
             }
+            slot = (slot + 1) & (capacity - 1);
         }
-        break;
     }
+    else {
+        // Small Object: Linear Search
+        for( uint32_t i = 0; i < length; i++ ) {
+            memcpy( &member, pMembers + (size_t)i * sizeof(_SnapshotMember), sizeof(member) );
+            const char *memberKey = _snapshotKeyOf( pSnapshot, &member, &memberKeyLength );
+            if( memberKey && memberKeyLength == keyLength && !memcmp( memberKey, key, keyLength ) ) {
+                pOutValue->pSnapshot = pSnapshot;
+                pOutValue->slot = member.slot;
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+const char *getSnapshotString(const JsonSnapshotValue *pValue, size_t *pOutLength)
+{
+    uint32_t length;
+    const char *pRecord = ( getSnapshotType( pValue ) == TYPE_STRING ) ? _snapshotRecord( pValue, _SNAPSHOT_STRING_FIXED, 1, &length ) : (const char *)0;
+    if( !pRecord ) { return (const char *)0; }
+    if( pOutLength ) { *pOutLength = length; }
+    return pRecord + sizeof(uint32_t);
+}
+
+// Boxed number: its 8 bytes, or `0` if they are not in the image
+static uint64_t _snapshotBoxed(const JsonSnapshotValue *pValue)
+{
+    uint64_t offset = pValue->slot >> 4;
+    if( offset < sizeof(_SnapshotHeader) || offset > pValue->pSnapshot->length - 8 ) { return 0; }
+    return _loadU64( pValue->pSnapshot->data + offset );
+}
+
+int64_t getSnapshotInt(const JsonSnapshotValue *pValue)
+{
+    switch( getSnapshotType( pValue ) )
+    {
+        case TYPE_BOOLEAN:
+            return (int64_t)(pValue->slot >> 4);
+        case TYPE_INT_NUMBER:
+            if( pValue->slot & _SNAPSHOT_BOXED ) { return (int64_t)_snapshotBoxed( pValue ); }
+            return (int64_t)(pValue->slot & ~(uint64_t)_SNAPSHOT_TAG_MASK) / 16; // (exact: arithmetic shift of the sign)
+        default:
+            return 0;
+    }
+}
 
-    pElement->type = 0;
-    pElement->iNumberValue = 0;
+double getSnapshotDouble(const JsonSnapshotValue *pValue)
+{
+    uint64_t bits;
+    double value;
+    switch( getSnapshotType( pValue ) )
+    {
+        case TYPE_DBL_NUMBER:
+            bits = ( pValue->slot & _SNAPSHOT_BOXED ) ? _snapshotBoxed( pValue ) : (pValue->slot & ~(uint64_t)_SNAPSHOT_TAG_MASK);
+            memcpy( &value, &bits, sizeof(value) );
+            return value;
+        case TYPE_INT_NUMBER:
+            return (double)getSnapshotInt( pValue );
+        default:
+            return 0.0;
+    }
 }
 
 void printElementSimple(const Element *pElement)
@@ -595,7 +5199,7 @@ void printElementSimple(const Element *pElement)
             break;
 
         case TYPE_STRING:
-            printf("'%s'", pElement->stringValue);
+            printf("'%.*s'", (int)pElement->length, pElement->stringValue);
             break;
 
         case TYPE_INT_NUMBER:
@@ -611,21 +5215,15 @@ void printElementSimple(const Element *pElement)
             break;
 
         case TYPE_OBJECT:
-            if( pElement->objectValue ) { 
-                int count = 0;
-                ObjectNode *pCurr = pElement->objectValue;
-                while( pCurr ) { ++count; pCurr = pCurr->next; }
-                printf("{ ...(%d) }", count ); 
+            if( pElement->length ) { 
+                printf("{ ...(%u) }", (unsigned int)pElement->length ); 
             }
             else { printf("{ }"); }
             break;
 
         case TYPE_ARRAY:
-            if( pElement->arrayValue ) {
-                int count = 0;
-                ArrayNode *pCurr = pElement->arrayValue;
-                while( pCurr ) { ++count; pCurr = pCurr->next; }
-                printf("[ ...(%d) ]", count ); 
+            if( pElement->length ) {
+                printf("[ ...(%u) ]", (unsigned int)pElement->length ); 
             }
             else { printf("[ ]");  }
             break;
@@ -641,7 +5239,7 @@ void printElementDepth1(const Element *pElement)
             break;
 
         case TYPE_STRING:
-            printf("'%s'\n", pElement->stringValue);
+            printf("'%.*s'\n", (int)pElement->length, pElement->stringValue);
             break;
 
         case TYPE_INT_NUMBER:
@@ -658,13 +5256,11 @@ void printElementDepth1(const Element *pElement)
 
         case TYPE_OBJECT:
         {
-            ObjectNode *pCurr = pElement->objectValue;
             printf("{");
-            while(pCurr) {
-                printf("%s:", pCurr->key);
-                printElementSimple(&(pCurr->element));
-                if(pCurr->next) { printf(", "); }
-                pCurr = pCurr->next;
+            for( uint32_t i = 0; i < pElement->length; i++ ) {
+                printf("%.*s:", (int)pElement->objectValue[i].keyLength, pElement->objectValue[i].key);
+                printElementSimple(&(pElement->objectValue[i].element));
+                if( i + 1 < pElement->length ) { printf(", "); }
             }
             printf("}\n");
         }
@@ -672,12 +5268,10 @@ void printElementDepth1(const Element *pElement)
 
         case TYPE_ARRAY:
         {
-            ArrayNode *pCurr = pElement->arrayValue;
             printf("[");
-            while(pCurr) {
-                printElementSimple(&(pCurr->element));
-                if(pCurr->next) { printf(", "); }
-                pCurr = pCurr->next;
+            for( uint32_t i = 0; i < pElement->length; i++ ) {
+                printElementSimple(&(pElement->arrayValue[i]));
+                if( i + 1 < pElement->length ) { printf(", "); }
             }
             printf("]\n");
         }
@@ -699,7 +5293,7 @@ static void _printElementDepthAllImpl(const Element *pElement, int padding)
             break;
 
         case TYPE_STRING:
-            printf("\"%s\"", pElement->stringValue);
+            printf("\"%.*s\"", (int)pElement->length, pElement->stringValue);
             break;
 
         case TYPE_INT_NUMBER:
@@ -716,15 +5310,13 @@ static void _printElementDepthAllImpl(const Element *pElement, int padding)
 
         case TYPE_OBJECT:
         {
-            ObjectNode *pCurr = pElement->objectValue;
             printf("{\n");
-            while(pCurr) {
+            for( uint32_t i = 0; i < pElement->length; i++ ) {
                 printPadding(padding + 4);
-                printf("\"%s\": ", pCurr->key);
-                _printElementDepthAllImpl(&(pCurr->element), padding + 4);
-                if(pCurr->next) { printf(", "); }
+                printf("\"%.*s\": ", (int)pElement->objectValue[i].keyLength, pElement->objectValue[i].key);
+                _printElementDepthAllImpl(&(pElement->objectValue[i].element), padding + 4);
+                if( i + 1 < pElement->length ) { printf(", "); }
                 printf("\n");
-                pCurr = pCurr->next;
             }
             printPadding(padding);
             printf("}");
@@ -733,14 +5325,12 @@ static void _printElementDepthAllImpl(const Element *pElement, int padding)
 
         case TYPE_ARRAY:
         {
-            ArrayNode *pCurr = pElement->arrayValue;
             printf("[\n");
-            while(pCurr) {
+            for( uint32_t i = 0; i < pElement->length; i++ ) {
                 printPadding(padding + 4);
-                _printElementDepthAllImpl(&(pCurr->element), padding + 4);
-                if(pCurr->next) { printf(", "); }
+                _printElementDepthAllImpl(&(pElement->arrayValue[i]), padding + 4);
+                if( i + 1 < pElement->length ) { printf(", "); }
                 printf("\n");
-                pCurr = pCurr->next;
             }
             printPadding(padding);
             printf("]");
@@ -764,43 +5354,66 @@ void printJsonErrorInfo(const JsonErrorInfo* pInfo, const char *jsonStr)
                 fprintf(stderr, "Critical Error: Out of memory...\n");
                 return;
 
+            case JPE_IO_ERROR:
+                fprintf(stderr, "Critical Error: Cannot read the file...\n");
+                return;
+
+            case JPE_INVALID_ARGUMENT:
+                fprintf(stderr, "Critical Error: Invalid parse options...\n");
+                return;
+
+            case JPE_INVALID_SNAPSHOT:
+                fprintf(stderr, "Critical Error: Not a snapshot image (or one of another version / byte order)...\n");
+                return;
+
+            case JPE_NESTING_TOO_DEEP:
+                fprintf(stderr, "Nesting of objects and arrays deeper than the limit at position %zu\n", pInfo->position);
+                break;
+
+            case JPE_CANCELLED:
+                fprintf(stderr, "Parsing stopped by a callback at position %zu\n", pInfo->position);
+                break;
+
             case JPE_NO_ERROR:
                 fprintf(stderr, "No Error...\n");
                 return;
             
             case JPE_SYNTAX_ERROR:
-                fprintf(stderr, "Unexpected token '%c' in JSON at position %d\n", jsonStr[pInfo->position], pInfo->position);
+                fprintf(stderr, "Unexpected token '%c' in JSON at position %zu\n", jsonStr[pInfo->position], pInfo->position);
                 break;
             case JPE_SYNTAX_ERROR_END:
                 fprintf(stderr, "Unexpected end of JSON input\n");
                 return;
             case JPE_SYNTAX_ERROR_STRING_ESCAPE:
-                fprintf(stderr, "Unexpected control character '%c' after '\\' at position %d\n", jsonStr[pInfo->position], pInfo->position);
+                fprintf(stderr, "Unexpected control character '%c' after '\\' at position %zu\n", jsonStr[pInfo->position], pInfo->position);
+                break;
+            case JPE_SYNTAX_ERROR_STRING_CONTROL:
+                fprintf(stderr, "Unexpected control character (0x%02X) in string at position %zu\n", (unsigned int)(unsigned char)jsonStr[pInfo->position], pInfo->position);
                 break;
             case JPE_SYNTAX_ERROR_UNICODE_ESCAPE:
-                fprintf(stderr, "Unexpected unicode 4 hex digits (+U%c%c%c%c) at position %d\n", jsonStr[pInfo->position + 1], jsonStr[pInfo->position + 2], jsonStr[pInfo->position + 3], jsonStr[pInfo->position + 4], pInfo->position);
+                fprintf(stderr, "Unexpected unicode 4 hex digits (+U%c%c%c%c) at position %zu\n", jsonStr[pInfo->position + 1], jsonStr[pInfo->position + 2], jsonStr[pInfo->position + 3], jsonStr[pInfo->position + 4], pInfo->position);
                 break;
             case JPE_SYNTAX_ERROR_ARRAY:
-                fprintf(stderr, "Unexpected token '%c' in JSON (while parsing array) at position %d\n", jsonStr[pInfo->position], pInfo->position);
+                fprintf(stderr, "Unexpected token '%c' in JSON (while parsing array) at position %zu\n", jsonStr[pInfo->position], pInfo->position);
                 break;
             case JPE_SYNTAX_ERROR_ARRAY_COMMA:
-                fprintf(stderr, "Unexpected token '%c' in JSON (while parsing array) at position %d: ',' is expected\n", jsonStr[pInfo->position], pInfo->position);
+                fprintf(stderr, "Unexpected token '%c' in JSON (while parsing array) at position %zu: ',' is expected\n", jsonStr[pInfo->position], pInfo->position);
                 break;
             case JPE_SYNTAX_ERROR_OBJECT:
-                fprintf(stderr, "Unexpected token '%c' in JSON (while parsing object) at position %d\n", jsonStr[pInfo->position], pInfo->position);
+                fprintf(stderr, "Unexpected token '%c' in JSON (while parsing object) at position %zu\n", jsonStr[pInfo->position], pInfo->position);
                 break;
             case JPE_SYNTAX_ERROR_OBJECT_KEY:
-                fprintf(stderr, "Unexpected token '%c' in JSON (while parsing object) at position %d: `string` for `key` is expected\n", jsonStr[pInfo->position], pInfo->position);
+                fprintf(stderr, "Unexpected token '%c' in JSON (while parsing object) at position %zu: `string` for `key` is expected\n", jsonStr[pInfo->position], pInfo->position);
                 break;
             case JPE_SYNTAX_ERROR_OBJECT_COLON:
-                fprintf(stderr, "Unexpected token '%c' in JSON (while parsing object) at position %d: ':' is expected\n", jsonStr[pInfo->position], pInfo->position);
+                fprintf(stderr, "Unexpected token '%c' in JSON (while parsing object) at position %zu: ':' is expected\n", jsonStr[pInfo->position], pInfo->position);
                 break;
             case JPE_SYNTAX_ERROR_OBJECT_COMMA:
-                fprintf(stderr, "Unexpected token '%c' in JSON (while parsing object) at position %d: ',' is expected\n", jsonStr[pInfo->position], pInfo->position);
+                fprintf(stderr, "Unexpected token '%c' in JSON (while parsing object) at position %zu: ',' is expected\n", jsonStr[pInfo->position], pInfo->position);
                 break;
             default:
                 return;
         }   
-        fprintf(stderr, "    at Ln %d, Col %d\n", pInfo->line, pInfo->column);
+        fprintf(stderr, "    at Ln %zu, Col %zu\n", pInfo->line, pInfo->column);
     }
 }
@@ -2,13 +2,19 @@
 #define _JSON_PARSER_H_
 
 #include <stdint.h>
+#include <stddef.h>
 
 // JSON SYNTAX [ https://www.json.org/json-en.html ]
 
 typedef enum
 {
     // System Error
-    JPE_OUT_OF_MEMORY = -1,
+    JPE_OUT_OF_MEMORY    = -1,
+    JPE_IO_ERROR         = -2, // Cannot open, stat or map the file (see errno)
+    JPE_INVALID_ARGUMENT = -3, // Invalid Parse Options (e.g. zero-copy without an arena)
+    JPE_NESTING_TOO_DEEP = -4, // Objects and arrays nested deeper than the limit
+    JPE_CANCELLED        = -5, // A callback of parseJsonSax() stopped parsing
+    JPE_INVALID_SNAPSHOT = -6, // Not a snapshot image (or one written by another version / byte order)
     // No Error
     JPE_NO_ERROR = 0,
     // Syntax Error (Unexpected Token)
@@ -16,6 +22,7 @@ typedef enum
     JPE_SYNTAX_ERROR_END            = 101, // End of string while parsing
     JPE_SYNTAX_ERROR_STRING_ESCAPE  = 110, // Invalid Escape Character
     JPE_SYNTAX_ERROR_UNICODE_ESCAPE = 111, // Invalid Unicode Character after \u
+    JPE_SYNTAX_ERROR_STRING_CONTROL = 112, // Unescaped Control Character in String
     JPE_SYNTAX_ERROR_ARRAY          = 120, // Unexpected Token while parsing array
     JPE_SYNTAX_ERROR_ARRAY_COMMA    = 121, // Missing Comma?
     JPE_SYNTAX_ERROR_OBJECT         = 130, // Unexpected Token while parsing object
@@ -36,39 +43,98 @@ typedef enum
 } ElementType;
 
 struct tagObjectNode;
-struct tagArrayNode;
 
 typedef struct tagElement
 {
     ElementType              type;
+    uint32_t                 length;       // number of elements (TYPE_ARRAY), members (TYPE_OBJECT) or bytes (TYPE_STRING)
     union {
         double               dNumberValue;
         int64_t              iNumberValue; // also boolean value
-        char                 *stringValue; // const char*
-        struct tagObjectNode *objectValue;
-        struct tagArrayNode  *arrayValue;
+        char                 *stringValue; // const char* (NOT NUL-terminated in JSON_PARSE_ZERO_COPY mode: use `length`)
+        struct tagObjectNode *objectValue;  // contiguous `length` members
+        struct tagElement    *arrayValue;  // contiguous `length` elements
     };
 } Element;
 
 typedef struct tagObjectNode
 {
     struct tagElement     element;
-    char                 *key; // const char*
-    struct tagObjectNode *next;
+    char                 *key;       // const char* (NOT NUL-terminated in JSON_PARSE_ZERO_COPY mode: use `keyLength`)
+    uint32_t              keyLength; // bytes of key (without '\0')
+    uint32_t              keyHash;   // used by findMember()
 } ObjectNode;
 
-typedef struct tagArrayNode
+// Objects with this many members or more get a hashed key index (smaller ones are searched linearly)
+#ifndef JSON_OBJECT_INDEX_THRESHOLD
+#define JSON_OBJECT_INDEX_THRESHOLD 16
+#endif
+
+// Maximum nesting of objects and arrays (JsonParseOptions::maxDepth overrides it)
+// ** The parser is not recursive: deeper documents fail with JPE_NESTING_TOO_DEEP instead of exhausting the C stack.
+#ifndef JSON_DEFAULT_MAX_DEPTH
+#define JSON_DEFAULT_MAX_DEPTH 1024
+#endif
+
+//
+// Allocator: where the parser gets its memory (`NULL` wherever one is taken: malloc/realloc/free)
+// ** The functions are called with pUserData (a pool, an accounting context, ...) and must be safe to call
+//    from every thread parsing with them. pfnMalloc() / pfnRealloc() return `NULL` if out of memory.
+// ** Whatever owns memory remembers its allocator for teardown (JsonArena, JsonKeyPool, JsonRecordSet, JsonPushParser,
+//    JsonLazyDocument, JsonReformatter); only a calloc()'d tree does not: release it with resetElementEx() and the allocator it was parsed with.
+// ** Entry points without JsonParseOptions take one in their Ex variant (validateJsonEx(), openJsonLazyDocumentEx()).
+// ** Not covered: writeJson() and createJsonSnapshot() return malloc()'d memory (release with free()) and use malloc/realloc/free
+//    for their work; so does openJsonSnapshot() without mmap(). parseJsonFile() / parseJsonFileArena() use the defaults
+//    (parseJsonFileEx() takes pOptions->pAllocator).
+//
+typedef struct tagJsonAllocator
+{
+    void *(*pfnMalloc)(void *pUserData, size_t size);
+    void *(*pfnRealloc)(void *pUserData, void *ptr, size_t size);
+    void  (*pfnFree)(void *pUserData, void *ptr);
+    void   *pUserData;
+} JsonAllocator;
+
+//
+// Arena: all nodes and strings of a parse are bump-allocated from large chunks
+//
+#ifndef JSON_ARENA_DEFAULT_CHUNK_SIZE
+#define JSON_ARENA_DEFAULT_CHUNK_SIZE (64 * 1024)
+#endif
+
+typedef struct tagJsonArenaChunk JsonArenaChunk;
+
+typedef struct tagJsonArena
 {
-    struct tagElement    element;
-    struct tagArrayNode *next;
-} ArrayNode;
+    JsonArenaChunk      *chunks;     // chunks in use (current chunk first)
+    JsonArenaChunk      *freeChunks; // chunks kept by clearJsonArena() for the next parse
+    size_t               chunkSize;  // minimum size of a new chunk
+    const JsonAllocator *pAllocator; // of the chunks (`NULL`: malloc/free)
+} JsonArena;
+
+//
+// Key Pool: every distinct object key is stored once (see JSON_PARSE_INTERN_KEYS)
+//
+#ifndef JSON_KEY_POOL_CHUNK_SIZE
+#define JSON_KEY_POOL_CHUNK_SIZE (4 * 1024)
+#endif
+
+typedef struct tagJsonKeyPoolEntry JsonKeyPoolEntry;
+
+typedef struct tagJsonKeyPool
+{
+    JsonKeyPoolEntry *entries;  // open addressing table
+    size_t            capacity; // power of two (0: no table yet)
+    size_t            count;    // distinct keys
+    JsonArena         arena;    // bytes of the keys
+} JsonKeyPool;
 
 typedef struct tagJsonErrorInfo
 {
     JsonParsingError error;
-    int              line;     // line number start from 1
-    int              column;   // column number start from 1
-    int              position; // zero-based byte index
+    size_t           line;     // line number start from 1
+    size_t           column;   // column number start from 1
+    size_t           position; // zero-based byte index
 } JsonErrorInfo;
 
 //
@@ -78,10 +144,381 @@ typedef struct tagJsonErrorInfo
 //
 JsonParsingError parseJsonString(Element *pOutElement, const char *jsonStr, JsonErrorInfo *pOutErrorInfo);
 
+//
+// Parse into Arena
+// ** All nodes and strings are owned by pArena: do NOT call resetElement() on the result.
+// ** Release them all at once with clearJsonArena() (keeps the memory for the next parse)
+//    or releaseJsonArena() (returns the memory to the system).
+//
+JsonParsingError parseJsonStringArena(Element *pOutElement, const char *jsonStr, JsonArena *pArena, JsonErrorInfo *pOutErrorInfo);
+
+//
+// Parse Length-Delimited Buffer
+// ** data[0 .. length-1] does not need to be NUL-terminated; no byte at or after data[length] is read.
+// ** A '\0' inside the buffer is a syntax error like any other unexpected byte.
+//
+JsonParsingError parseJsonBuffer(Element *pOutElement, const char *data, size_t length, JsonErrorInfo *pOutErrorInfo);
+JsonParsingError parseJsonBufferArena(Element *pOutElement, const char *data, size_t length, JsonArena *pArena, JsonErrorInfo *pOutErrorInfo);
+
+//
+// Parse Options
+// ** Zero-initialized options are the defaults of parseJsonBuffer().
+//
+#define JSON_PARSE_ZERO_COPY   0x0001 // strings without escapes point into the input instead of being copied
+#define JSON_PARSE_INTERN_KEYS 0x0002 // equal keys of one document share one copy (in the arena)
+#define JSON_PARSE_TWO_STAGE   0x0004 // index the structural bytes with SIMD first, then build Elements from the index
+
+//
+// Parse Statistics: what a parse cost (JsonParseOptions::pStats)
+// ** Zeroed and filled by every function taking JsonParseOptions, whether the parse succeeds or not
+//    (up to the error). The push parser adds up its chunks until jsonParserFinish().
+// ** Values are counted as they are made: JSON_ENABLE_PARSE_STATS 0 compiles the counters out of the parser,
+//    leaving bytes, workingBytes and the times.
+// ** Multi-threaded parsing adds up the counts of every thread: parseNanoseconds is then CPU time, totalNanoseconds wall-clock time.
+//
+#ifndef JSON_ENABLE_PARSE_STATS
+#define JSON_ENABLE_PARSE_STATS 1
+#endif
+
+typedef struct tagJsonParseStats
+{
+    size_t   bytes;            // input bytes parsed (to the error if there is one)
+    size_t   objects;
+    size_t   arrays;
+    size_t   strings;          // string values (keys are counted apart)
+    size_t   numbers;
+    size_t   literals;         // true, false and null
+    size_t   keys;
+    size_t   maxDepth;         // deepest nesting of objects / arrays (0: a scalar document)
+    size_t   stringBytes;      // decoded bytes of strings and keys
+    size_t   allocations;      // blocks of nodes and strings: calloc() calls, or bump allocations in the arena
+    size_t   allocatedBytes;
+    size_t   workingBytes;     // largest size of the parser's own buffers (nesting frames, scratch stack and escapes)
+    uint64_t indexNanoseconds; // finding the structure first: stage 1 of JSON_PARSE_TWO_STAGE, splitting the input for threads
+    uint64_t parseNanoseconds; // building the values
+    uint64_t totalNanoseconds;
+} JsonParseStats;
+
+typedef struct tagJsonParseOptions
+{
+    uint32_t             flags;      // JSON_PARSE_*
+    JsonArena           *pArena;     // `NULL`: calloc()'d nodes, release with resetElement() (or resetElementEx( pAllocator ))
+    JsonKeyPool         *pKeyPool;   // `NULL` or keys are interned in this long-lived pool (across parses)
+    size_t               maxDepth;   // `0`: JSON_DEFAULT_MAX_DEPTH
+    JsonParseStats      *pStats;     // `NULL`, or filled with the costs of the parse
+    const JsonAllocator *pAllocator; // `NULL`: malloc/realloc/free; nodes (without pArena) and the parser's own buffers
+    const char * const  *ppPaths;    // `NULL` or the values to keep: JSON Pointers (RFC 6901), see Projection below
+    size_t               pathCount;
+} JsonParseOptions;
+
+//
+// Parse with Options
+// ** pOptions can be `NULL` for the defaults.
+// ** JSON_PARSE_ZERO_COPY requires pOptions->pArena: strings without escapes are slices of data
+//    (valid while data is, NOT NUL-terminated), strings with escapes are decoded into the arena.
+// ** JSON_PARSE_INTERN_KEYS and pKeyPool require pOptions->pArena: keys are NUL-terminated and shared,
+//    so equal keys have equal pointers (within the document, or across every parse using the same pool).
+// ** JSON_PARSE_TWO_STAGE gives the same result and errors; an invalid document is parsed twice to report the error.
+//    It is not used by parseJsonInsitu(), and needs 4 bytes of index per token (documents up to 4 GiB).
+// ** Projection (ppPaths): only the values at the paths (with everything in them) and the containers leading
+//    to them are made, e.g. { "/accessors", "/bufferViews", "/buffers" }. Other members are left out and
+//    other elements of an array are null (indexes are kept); a path through a scalar keeps nothing of it.
+//    Skipped values are passed over by matching brackets and quotes only: nothing is allocated or decoded,
+//    and errors inside them are not reported (beyond an unterminated string or container).
+//    "" keeps the whole document; a path not starting with '/' (or with '~' not followed by '0' / '1') is JPE_INVALID_ARGUMENT.
+//    JSON_PARSE_TWO_STAGE is not used with it, and the push parser does not take it.
+//
+JsonParsingError parseJsonBufferEx(Element *pOutElement, const char *data, size_t length, const JsonParseOptions *pOptions, JsonErrorInfo *pOutErrorInfo);
+
+//
+// Parse In Situ
+// ** Strings are decoded in data itself and NUL-terminated there (over the closing quote),
+//    so no string is copied. data must stay alive and unmodified while the result is used.
+// ** Requires pOptions->pArena (for the nodes); data is left partially decoded on error.
+// ** Line/column of an error after a string with escapes may be off (position is exact).
+//
+JsonParsingError parseJsonInsitu(Element *pOutElement, char *data, size_t length, const JsonParseOptions *pOptions, JsonErrorInfo *pOutErrorInfo);
+
+//
+// Event (SAX) API: report values to callbacks instead of building Elements
+// ** Every callback can be `NULL` (ignored). It returns 0 to go on, anything else stops parsing with JPE_CANCELLED.
+// ** Keys and strings are not copied: they are slices of data, or decoded in a scratch buffer if they have escapes.
+//    They are NOT NUL-terminated and valid only during the callback.
+// ** Memory use does not grow with the document (only with its nesting).
+//
+typedef struct tagJsonSaxHandler
+{
+    int (*startObject)(void *pUserData);
+    int (*endObject)(void *pUserData);
+    int (*startArray)(void *pUserData);
+    int (*endArray)(void *pUserData);
+    int (*key)(void *pUserData, const char *key, size_t keyLength);
+    int (*stringValue)(void *pUserData, const char *value, size_t length);
+    int (*intNumberValue)(void *pUserData, int64_t value);
+    int (*dblNumberValue)(void *pUserData, double value);
+    int (*booleanValue)(void *pUserData, int value);
+    int (*nullValue)(void *pUserData);
+} JsonSaxHandler;
+
+JsonParsingError parseJsonSax(const char *data, size_t length, const JsonSaxHandler *pHandler, void *pUserData, JsonErrorInfo *pOutErrorInfo);
+
+//
+// Validation only: whether data is one JSON value, and where it fails
+// ** The same grammar, error codes and locations as parseJsonBufferEx(), but nothing is made:
+//    strings are checked without being copied or decoded and numbers without being converted.
+// ** Nothing is allocated up to 64 levels of nesting (deeper documents take one block for the nesting frames).
+//
+JsonParsingError validateJson(const char *data, size_t length, JsonErrorInfo *pOutErrorInfo);
+JsonParsingError validateJsonEx(const char *data, size_t length, const JsonAllocator *pAllocator, JsonErrorInfo *pOutErrorInfo);
+
+//
+// Lazy Document: parse on demand
+// ** openJsonLazyDocument() only validates data and indexes its objects and arrays: no Element, string or number is made.
+//    Accessors locate values when they are called and materializeLazyValue() decodes one (with everything in it),
+//    so the cost follows what is read rather than the document size.
+// ** data is not copied: it must outlive the document. A JsonLazyValue is valid until closeJsonLazyDocument().
+// ** The first getLazyLength(), getLazyArrayElement() or findLazyMember() on a container walks it (nested containers are skipped
+//    in O(log n)) and records where its members / elements start: later calls on it index that record (findLazyMember()
+//    still compares the keys in order). Decoded values are not kept: materializeLazyValue() decodes again on every call.
+// ** The accessors write those records into the document: do not call them on one document from several threads at once.
+//    If a record cannot be allocated, the container is walked on every call instead.
+// ** openJsonLazyDocumentEx(): the document, its records and the working buffers use pAllocator (`NULL`: malloc/realloc/free),
+//    and so do the values made by materializeLazyValue() without pArena: release them with resetElementEx( pElement, pAllocator ).
+//
+struct tagJsonLazyContainer;
+
+typedef struct tagJsonLazyDocument
+{
+    const char                  *data;
+    size_t                       length;
+    struct tagJsonLazyContainer *containers; // every object / array, in document order
+    size_t                       containerCount;
+    size_t                       containerCapacity;
+    const JsonAllocator         *pAllocator; // `NULL`: malloc/realloc/free
+} JsonLazyDocument;
+
+typedef struct tagJsonLazyValue
+{
+    const JsonLazyDocument *pDocument;
+    size_t                  offset;    // first byte of the value in pDocument->data
+} JsonLazyValue;
+
+JsonParsingError openJsonLazyDocument(JsonLazyDocument *pDocument, const char *data, size_t length, JsonErrorInfo *pOutErrorInfo);
+JsonParsingError openJsonLazyDocumentEx(JsonLazyDocument *pDocument, const char *data, size_t length, const JsonAllocator *pAllocator, JsonErrorInfo *pOutErrorInfo);
+void closeJsonLazyDocument(JsonLazyDocument *pDocument);
+
+JsonLazyValue getLazyRoot(const JsonLazyDocument *pDocument);
+ElementType getLazyType(const JsonLazyValue *pValue);
+size_t getLazyLength(const JsonLazyValue *pValue); // members / elements, 0 for a scalar
+int getLazyArrayElement(const JsonLazyValue *pArray, size_t index, JsonLazyValue *pOutValue); // 0: not an array or out of range
+int findLazyMember(const JsonLazyValue *pObject, const char *key, size_t keyLength, JsonLazyValue *pOutValue); // 0: not found
+JsonParsingError materializeLazyValue(const JsonLazyValue *pValue, Element *pOutElement, JsonArena *pArena); // pArena can be `NULL`
+
+//
+// Parse File
+// ** The file is memory-mapped read-only and parsed in place (no NUL-terminated copy).
+//    The mapping is released before returning: the result does not refer to it.
+// ** Returns JPE_IO_ERROR (errno is kept) if the file cannot be opened or mapped.
+// ** Do not truncate the file while it is being parsed (the mapping would fault).
+//
+JsonParsingError parseJsonFile(Element *pOutElement, const char *path, JsonErrorInfo *pOutErrorInfo);
+JsonParsingError parseJsonFileArena(Element *pOutElement, const char *path, JsonArena *pArena, JsonErrorInfo *pOutErrorInfo);
+// With the options of parseJsonBufferEx() but JSON_PARSE_ZERO_COPY (JPE_INVALID_ARGUMENT: the data is released before returning)
+JsonParsingError parseJsonFileEx(Element *pOutElement, const char *path, const JsonParseOptions *pOptions, JsonErrorInfo *pOutErrorInfo);
+
+//
+// Push Parser: parse a document that arrives in chunks (e.g. from a socket or a pipe)
+// ** Call jsonParserFeed() for every chunk (split anywhere, even inside a token), then jsonParserFinish() once.
+//    Chunks are parsed as they arrive: nothing is kept but the token split by the last boundary.
+// ** The result is the same as parseJsonBufferEx() over the concatenated chunks (positions count from the first chunk),
+//    but an error may be reported by a later call than the one feeding it.
+// ** createJsonPushParser() returns `NULL` if out of memory or for invalid options (JSON_PARSE_ZERO_COPY, ppPaths, or see parseJsonBufferEx()).
+// ** Errors are sticky: jsonParserFeed() fills pOutErrorInfo only when it returns one.
+//
+typedef struct tagJsonPushParser JsonPushParser;
+
+JsonPushParser *createJsonPushParser(const JsonParseOptions *pOptions);
+JsonParsingError jsonParserFeed(JsonPushParser *pParser, const char *chunk, size_t length, JsonErrorInfo *pOutErrorInfo);
+JsonParsingError jsonParserFinish(JsonPushParser *pParser, Element *pOutElement, JsonErrorInfo *pOutErrorInfo);
+void releaseJsonPushParser(JsonPushParser *pParser);
+
+//
+// JSON Lines (NDJSON): one document per line, parsed by several threads
+// ** Lines with nothing but whitespace are skipped; every other line becomes a JsonRecord, in input order,
+//    with its own JsonErrorInfo (line / column / position in the whole buffer).
+// ** threadCount `0`: one per online CPU. Each thread parses into its own arena, owned by the set:
+//    release everything with releaseJsonRecordSet() (not resetElement()).
+// ** pOptions can be `NULL`; pOptions->pArena and pKeyPool must be `NULL` (JPE_INVALID_ARGUMENT).
+//    With JSON_PARSE_ZERO_COPY, strings point into data.
+// ** Returns the error of the first invalid record (JPE_NO_ERROR if there is none) or JPE_OUT_OF_MEMORY.
+//
+typedef struct tagJsonRecord
+{
+    Element       element;   // TYPE_NULL if errorInfo.error is not JPE_NO_ERROR
+    JsonErrorInfo errorInfo;
+    size_t        offset;    // the line in data
+    size_t        length;
+    size_t        line;      // 1-based
+} JsonRecord;
+
+typedef struct tagJsonRecordSet
+{
+    JsonRecord          *records;
+    size_t               count;
+    JsonArena           *arenas;     // one per thread
+    size_t               arenaCount;
+    const JsonAllocator *pAllocator; // pOptions->pAllocator (of all the above)
+} JsonRecordSet;
+
+JsonParsingError parseJsonLines(JsonRecordSet *pOutSet, const char *data, size_t length, const JsonParseOptions *pOptions, unsigned int threadCount);
+void releaseJsonRecordSet(JsonRecordSet *pSet);
+
+//
+// Parallel parsing of a large root array
+// ** The elements of the root array are parsed in chunks of at least JSON_PARALLEL_CHUNK_SIZE bytes
+//    on threadCount threads (`0`: one per online CPU) and spliced in order: the result and the errors
+//    (with line / column / position in the whole document) are those of parseJsonBufferEx().
+// ** Other root values, small documents, pOptions->pKeyPool and ppPaths are parsed serially in this thread.
+// ** With pOptions->pArena, every thread bump-allocates from an arena of its own, merged into pOptions->pArena;
+//    with JSON_PARSE_INTERN_KEYS, equal keys share one copy per thread.
+//
+JsonParsingError parseJsonArrayParallel(Element *pOutElement, const char *data, size_t length, const JsonParseOptions *pOptions, unsigned int threadCount, JsonErrorInfo* pOutErrorInfo);
+
+//
+// Arena Management
+// ** chunkSize can be `0` for JSON_ARENA_DEFAULT_CHUNK_SIZE
+// ** initJsonArenaEx() takes the chunks from pAllocator (`NULL`: malloc/free), until releaseJsonArena().
+//    Arenas merged by parseJsonArrayParallel() share it.
+//
+void initJsonArena(JsonArena *pArena, size_t chunkSize);
+void initJsonArenaEx(JsonArena *pArena, size_t chunkSize, const JsonAllocator *pAllocator);
+void clearJsonArena(JsonArena *pArena);
+void releaseJsonArena(JsonArena *pArena);
+
+//
+// Key Pool Management
+// ** A pool is not thread-safe: use one per thread. Trees using its keys must not outlive it.
+// ** internJsonKey() returns the pooled copy of key[0 .. keyLength-1] (adding it if needed) or `NULL` if out of memory:
+//    compare it with ObjectNode::key by pointer.
+//
+void initJsonKeyPool(JsonKeyPool *pPool);
+void initJsonKeyPoolEx(JsonKeyPool *pPool, const JsonAllocator *pAllocator);
+void releaseJsonKeyPool(JsonKeyPool *pPool);
+const char *internJsonKey(JsonKeyPool *pPool, const char *key, size_t keyLength);
+
 //
 // Release Element
+// ** resetElementEx() releases a tree parsed with JsonParseOptions::pAllocator (and no pArena).
 //
 void resetElement(Element *pElement);
+void resetElementEx(Element *pElement, const JsonAllocator *pAllocator);
+
+//
+// Array Access in O(1)
+// ** getArrayLength() returns 0 and getArrayElement() returns `NULL` for a non-array or out of range index.
+// ** Tight loops can also index `pElement->arrayValue[0 .. pElement->length - 1]` directly.
+//
+size_t getArrayLength(const Element *pElement);
+const Element *getArrayElement(const Element *pElement, size_t index);
+
+//
+// Object Member Lookup
+// ** Returns the value of the first member named key[0 .. keyLength-1], or `NULL` if not found.
+//
+const Element *findMember(const Element *pObject, const char *key, size_t keyLength);
+
+//
+// Serializer
+// ** Writes pElement as JSON text: compact, or with JSON_WRITE_PRETTY one member / element per line.
+// ** Strings are escaped. Doubles get the shortest digits that parse back to the same double (Grisu2: rarely one more),
+//    with '.' or an exponent so that they stay TYPE_DBL_NUMBER; NaN and infinities are written as null.
+//
+#define JSON_WRITE_PRETTY 0x0001
+
+#ifndef JSON_WRITE_INDENT
+#define JSON_WRITE_INDENT 4 // spaces per level (JSON_WRITE_PRETTY)
+#endif
+
+// malloc()'d and NUL-terminated (release with free()); `NULL` if out of memory
+char *writeJson(const Element *pElement, uint32_t flags, size_t *pOutLength);
+// Into the caller's buffer, NUL-terminated. Returns the length of the whole text as snprintf() does
+// (bufferSize or more: the buffer holds only its beginning), or `0` if out of memory.
+size_t writeJsonBuffer(const Element *pElement, uint32_t flags, char *buffer, size_t bufferSize);
+
+//
+// Reformat: minify (flags `0`) or pretty-print (JSON_WRITE_PRETTY) JSON text without building Elements
+// ** Strings, numbers and literals are copied as they are; whitespace is dropped, or replaced by the layout of
+//    writeJson(). Empty input gives empty output.
+// ** The grammar is checked on the way, with the error codes and locations of parseJsonBufferEx() with the same
+//    pOptions->maxDepth. Output written before an error is not taken back.
+// ** Output goes through a buffer of JSON_REFORMAT_BUFFER_SIZE bytes to pSink: memory does not depend on the size
+//    of the document. A failing pSink stops with JPE_IO_ERROR.
+// ** Of pOptions (`NULL`: defaults), only maxDepth (`0`: JSON_DEFAULT_MAX_DEPTH) and pAllocator (for the reformatter
+//    and its buffers) are used.
+//
+#ifndef JSON_REFORMAT_BUFFER_SIZE
+#define JSON_REFORMAT_BUFFER_SIZE (64 * 1024)
+#endif
+
+// Returns 0 if all of data was written
+typedef int (*JsonSink)(void *pSinkData, const char *data, size_t length);
+int jsonFileSink(void *pFile, const char *data, size_t length); // pSinkData: FILE *
+int jsonFdSink(void *pFd, const char *data, size_t length);     // pSinkData: int * (file descriptor)
+
+// A whole buffer (e.g. memory-mapped), or a file read in chunks
+JsonParsingError reformatJson(const char *data, size_t length, uint32_t flags, const JsonParseOptions *pOptions, JsonSink pSink, void *pSinkData, JsonErrorInfo *pOutErrorInfo);
+JsonParsingError reformatJsonFile(const char *path, uint32_t flags, const JsonParseOptions *pOptions, JsonSink pSink, void *pSinkData, JsonErrorInfo *pOutErrorInfo);
+
+// Chunks split anywhere, as for the push parser; `NULL` if out of memory or without pSink
+typedef struct tagJsonReformatter JsonReformatter;
+
+JsonReformatter *createJsonReformatter(uint32_t flags, const JsonParseOptions *pOptions, JsonSink pSink, void *pSinkData);
+JsonParsingError jsonReformatterFeed(JsonReformatter *pReformatter, const char *chunk, size_t length, JsonErrorInfo *pOutErrorInfo);
+JsonParsingError jsonReformatterFinish(JsonReformatter *pReformatter, JsonErrorInfo *pOutErrorInfo);
+void releaseJsonReformatter(JsonReformatter *pReformatter);
+
+//
+// Binary Snapshot: a parsed tree saved as an image that is used in place, without parsing or building Elements
+// ** The image holds no pointers (only offsets), so it can be memory-mapped anywhere. Keys are stored once per distinct key;
+//    small integers and most short doubles fit in the 8 bytes of their value. Images are limited to 4 GiB.
+// ** openJsonSnapshot() maps the file read-only and checks its header: O(1), pages are read as accessors touch them.
+//    openJsonSnapshotBuffer() uses an image in memory (e.g. from createJsonSnapshot()), which must outlive the snapshot.
+// ** Numbers are in the byte order of the writer: another byte order is JPE_INVALID_SNAPSHOT.
+// ** Accessors check every offset against the image: a damaged image gives empty values, not a crash.
+//    Keys and strings are NUL-terminated slices of the image, valid until closeJsonSnapshot().
+// ** getSnapshotArrayElement() is O(1); findSnapshotMember() uses the same key index as findMember().
+//
+typedef struct tagJsonSnapshot
+{
+    const char *data;   // the image
+    size_t      length;
+    uint64_t    root;
+    int         owned;  // mapped (or read) by openJsonSnapshot()
+} JsonSnapshot;
+
+typedef struct tagJsonSnapshotValue
+{
+    const JsonSnapshot *pSnapshot;
+    uint64_t            slot;      // the encoded value
+} JsonSnapshotValue;
+
+// malloc()'d image (release with free()), or `NULL` if out of memory or over 4 GiB
+char *createJsonSnapshot(const Element *pElement, size_t *pOutLength);
+JsonParsingError saveJsonSnapshot(const Element *pElement, const char *path);
+
+JsonParsingError openJsonSnapshot(JsonSnapshot *pSnapshot, const char *path);
+JsonParsingError openJsonSnapshotBuffer(JsonSnapshot *pSnapshot, const char *data, size_t length);
+void closeJsonSnapshot(JsonSnapshot *pSnapshot);
+
+JsonSnapshotValue getSnapshotRoot(const JsonSnapshot *pSnapshot);
+ElementType getSnapshotType(const JsonSnapshotValue *pValue);
+size_t getSnapshotLength(const JsonSnapshotValue *pValue); // members / elements / bytes (as Element::length), 0 otherwise
+int getSnapshotArrayElement(const JsonSnapshotValue *pArray, size_t index, JsonSnapshotValue *pOutValue); // 0: not an array or out of range
+int getSnapshotMember(const JsonSnapshotValue *pObject, size_t index, const char **pOutKey, size_t *pOutKeyLength, JsonSnapshotValue *pOutValue); // in document order
+int findSnapshotMember(const JsonSnapshotValue *pObject, const char *key, size_t keyLength, JsonSnapshotValue *pOutValue); // 0: not found
+const char *getSnapshotString(const JsonSnapshotValue *pValue, size_t *pOutLength); // `NULL`: not a string
+int64_t getSnapshotInt(const JsonSnapshotValue *pValue);  // TYPE_INT_NUMBER and TYPE_BOOLEAN, 0 otherwise
+double getSnapshotDouble(const JsonSnapshotValue *pValue); // numbers, 0.0 otherwise
 
 //
 // Print Result
@@ -0,0 +1,107 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "testCommon.h"
+
+//
+// Serializer: parse -> writeJson() -> parse gives the same tree, and writeJsonBuffer() truncates as snprintf() does
+//
+
+static void checkRoundTrip(const Element *pElement, uint32_t flags)
+{
+    size_t length = 0;
+    char *text = writeJson( pElement, flags, &length );
+    CHECK( text != (char *)0 && strlen(text) == length );
+    if( !text ) { return; }
+
+    Element element = { 0, };
+    CHECK( parseJsonBufferEx( &element, text, length, (const JsonParseOptions *)0, (JsonErrorInfo *)0 ) == JPE_NO_ERROR );
+    CHECK( isSameElement( &element, pElement ) );
+    if( !isSameElement( &element, pElement ) ) {
+        fprintf( stderr, "  %s\n", text );
+    }
+    resetElement( &element );
+
+    // Into a buffer of every size: the full length is returned and the beginning of the text is kept
+    char *buffer = (char *)malloc( length + 2 );
+    CHECK( writeJsonBuffer( pElement, flags, (char *)0, 0 ) == length );
+    for( size_t bufferSize = 1; bufferSize <= length + 2; bufferSize++ ) {
+        memset( buffer, '#', length + 2 );
+        size_t kept = (bufferSize <= length) ? bufferSize - 1 : length;
+        CHECK( writeJsonBuffer( pElement, flags, buffer, bufferSize ) == length );
+        CHECK( !memcmp( buffer, text, kept ) && buffer[kept] == '\0' );
+    }
+    free( buffer );
+    free( text );
+}
+
+static void checkText(const char *data)
+{
+    Element element = { 0, };
+    CHECK( parseJsonString( &element, data, (JsonErrorInfo *)0 ) == JPE_NO_ERROR );
+    checkRoundTrip( &element, 0 );
+    checkRoundTrip( &element, JSON_WRITE_PRETTY );
+    resetElement( &element );
+}
+
+// The compact text of pElement is expected
+static void checkOutput(const Element *pElement, const char *expected)
+{
+    char *text = writeJson( pElement, 0, (size_t *)0 );
+    CHECK( text && !strcmp( text, expected ) );
+    if( text && strcmp( text, expected ) ) {
+        fprintf( stderr, "  %s (expected %s)\n", text, expected );
+    }
+    free( text );
+}
+
+int main(void)
+{
+    // Every valid document of test1.c
+    for( size_t i = 0; i < JSON_STRING_COUNT; i++ ) {
+        Element element = { 0, };
+        if( parseJsonString( &element, JSON_STRINGS[i], (JsonErrorInfo *)0 ) == JPE_NO_ERROR ) {
+            checkText( JSON_STRINGS[i] );
+        }
+        resetElement( &element );
+    }
+
+    // Doubles at the edges of the shortest digits and of the integer range
+    const char *NUMBERS[] = {
+        "1e-7", "9223372036854775808", "-9223372036854775809", "1.7976931348623157e308", "-1.7976931348623157e308",
+        "4.9e-324", "2.2250738585072014e-308", "0.1", "1e21", "123456789012345680000", "-0.0", "5e-324",
+        "9223372036854775807", "-9223372036854775808", "0",
+    };
+    for( size_t i = 0; i < sizeof(NUMBERS) / sizeof(NUMBERS[0]); i++ ) {
+        checkText( NUMBERS[i] );
+    }
+    char numbers[1024];
+    size_t length = (size_t)sprintf( numbers, "[" );
+    for( size_t i = 0; i < sizeof(NUMBERS) / sizeof(NUMBERS[0]); i++ ) {
+        length += (size_t)sprintf( numbers + length, "%s%s", i ? "," : "", NUMBERS[i] );
+    }
+    sprintf( numbers + length, "]" );
+    checkText( numbers );
+
+    // Escaping: quotes, backslashes and every control character (NUL too); '/' and UTF-8 are written as they are
+    Element string = { 0, };
+    CHECK( parseJsonString( &string, "\"\\\"\\\\/\\b\\f\\n\\r\\t\\u0000\\u0001\\u001f\\u007f\\u00e9\xf0\x9f\x98\x80\"", (JsonErrorInfo *)0 ) == JPE_NO_ERROR );
+    checkOutput( &string, "\"\\\"\\\\/\\b\\f\\n\\r\\t\\u0000\\u0001\\u001f\x7f\xc3\xa9\xf0\x9f\x98\x80\"" );
+    checkRoundTrip( &string, 0 );
+    resetElement( &string );
+    checkText( "{\"key \\\"\\n\\u0002\":\"\\t\",\"\":[\"\\\\\"]}" );
+
+    // NaN and infinities are written as null (they are not JSON)
+    Element values[4] = {
+        { .type = TYPE_DBL_NUMBER, .dNumberValue = NAN },
+        { .type = TYPE_DBL_NUMBER, .dNumberValue = INFINITY },
+        { .type = TYPE_DBL_NUMBER, .dNumberValue = -INFINITY },
+        { .type = TYPE_DBL_NUMBER, .dNumberValue = 1.5 },
+    };
+    Element array = { .type = TYPE_ARRAY, .length = 4, .arrayValue = values };
+    checkOutput( &array, "[null,null,null,1.5]" );
+    checkOutput( &values[0], "null" );
+    CHECK( writeJsonBuffer( &array, 0, numbers, 8 ) == strlen("[null,null,null,1.5]") && !strcmp( numbers, "[null,n" ) );
+
+    return testResult( "serializer" );
+}
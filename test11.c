@@ -0,0 +1,250 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "testCommon.h"
+
+//
+// JsonAllocator: with pAllocator set, the parser takes no memory from malloc() & co. directly
+//
+
+// malloc() & co. are wrapped to count the calls of the parser (see the Makefile); the hooks use the real ones
+static long long directCount = 0;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+void *__wrap_malloc(size_t size)
+{
+    directCount++;
+    return __real_malloc( size );
+}
+
+void *__wrap_calloc(size_t count, size_t size)
+{
+    directCount++;
+    return __real_calloc( count, size );
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    directCount++;
+    return __real_realloc( ptr, size );
+}
+
+void __wrap_free(void *ptr)
+{
+    if( ptr ) { directCount++; }
+    __real_free( ptr );
+}
+
+// Blocks of the hooks start 16 bytes after a header: free() of one of them (or a hook given a block of malloc()) fails loudly
+#define HOOK_HEADER 16
+#define HOOK_MAGIC  0x4A534F4E414C4C43ull
+
+typedef struct
+{
+    long long allocations; // blocks made (realloc() of `NULL` too)
+    long long releases;    // blocks freed (realloc() to a new block frees the old one)
+} HookCounts;
+
+static void *hookMalloc(void *pUserData, size_t size)
+{
+    char *pBlock = (char *)__real_malloc( size + HOOK_HEADER );
+    if( !pBlock ) { return (void *)0; }
+    *(unsigned long long *)pBlock = HOOK_MAGIC;
+    ((HookCounts *)pUserData)->allocations++;
+    return pBlock + HOOK_HEADER;
+}
+
+static void hookFree(void *pUserData, void *ptr)
+{
+    if( !ptr ) { return; }
+    char *pBlock = (char *)ptr - HOOK_HEADER;
+    if( *(unsigned long long *)pBlock != HOOK_MAGIC ) {
+        fprintf( stderr, "hookFree(): not a block of the hooks\n" );
+        abort();
+    }
+    *(unsigned long long *)pBlock = 0;
+    ((HookCounts *)pUserData)->releases++;
+    __real_free( pBlock );
+}
+
+static void *hookRealloc(void *pUserData, void *ptr, size_t size)
+{
+    if( !ptr ) { return hookMalloc( pUserData, size ); }
+    char *pBlock = (char *)ptr - HOOK_HEADER;
+    if( *(unsigned long long *)pBlock != HOOK_MAGIC ) {
+        fprintf( stderr, "hookRealloc(): not a block of the hooks\n" );
+        abort();
+    }
+    pBlock = (char *)__real_realloc( pBlock, size + HOOK_HEADER );
+    return pBlock ? pBlock + HOOK_HEADER : (void *)0;
+}
+
+static HookCounts counts;
+static const JsonAllocator ALLOCATOR = { hookMalloc, hookRealloc, hookFree, &counts };
+
+static void startCounting(void)
+{
+    memset( &counts, 0, sizeof(counts) );
+    directCount = 0;
+}
+
+// Nothing direct, everything released, and the hooks were used
+static void checkCounts(const char *what)
+{
+    CHECK( directCount == 0 );
+    CHECK( counts.allocations > 0 && counts.allocations == counts.releases );
+    if( directCount || counts.allocations == 0 || counts.allocations != counts.releases ) {
+        fprintf( stderr, "  %s: %lld direct, %lld made, %lld released by the hooks\n", what, directCount, counts.allocations, counts.releases );
+    }
+}
+
+static int nullSink(void *pSinkData, const char *data, size_t length)
+{
+    (void)pSinkData; (void)data; (void)length;
+    return 0;
+}
+
+// Every document of test1.c (valid or not), parsed with the options
+static void parseCorpus(const JsonParseOptions *pOptions)
+{
+    for( size_t i = 0; i < JSON_STRING_COUNT; i++ ) {
+        Element element = { 0, };
+        JsonErrorInfo info;
+        parseJsonBufferEx( &element, JSON_STRINGS[i], strlen(JSON_STRINGS[i]), pOptions, &info );
+        if( pOptions->pArena ) { clearJsonArena( pOptions->pArena ); }
+        else { resetElementEx( &element, &ALLOCATOR ); }
+    }
+}
+
+int main(void)
+{
+    static char document[3 * 1024 * 1024 + 4096];
+    JsonErrorInfo info;
+
+    // A bit of everything: long numbers (copied for strtod()), escapes, deep nesting (frames on the heap), many members
+    const char *MIXED =
+        "{\"n\":1.00000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000001e-3,"
+        "\"s\":\"\\u00e9\\n\\\"\",\"deep\":[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[1]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]],"
+        "\"a\":1,\"b\":2,\"c\":3,\"d\":4,\"e\":5,\"f\":6,\"g\":7,\"h\":8,\"i\":9,\"j\":10,\"k\":11,\"l\":12,\"m\":13,\"o\":14,\"p\":15,\"q\":16,\"r\":17}";
+
+    // Engine, two-stage and projection, with the test1.c corpus (errors included)
+    const char *PATHS[] = { "/deep/0", "/s" };
+    JsonParseOptions options = { .pAllocator = &ALLOCATOR, };
+    startCounting();
+    parseCorpus( &options );
+    Element element = { 0, };
+    CHECK( parseJsonBufferEx( &element, MIXED, strlen(MIXED), &options, &info ) == JPE_NO_ERROR );
+    resetElementEx( &element, &ALLOCATOR );
+    checkCounts( "engine" );
+
+    startCounting();
+    options.flags = JSON_PARSE_TWO_STAGE;
+    parseCorpus( &options );
+    CHECK( parseJsonBufferEx( &element, MIXED, strlen(MIXED), &options, &info ) == JPE_NO_ERROR );
+    resetElementEx( &element, &ALLOCATOR );
+    checkCounts( "two-stage" );
+
+    startCounting();
+    options.flags = 0;
+    options.ppPaths = PATHS;
+    options.pathCount = 2;
+    CHECK( parseJsonBufferEx( &element, MIXED, strlen(MIXED), &options, &info ) == JPE_NO_ERROR );
+    resetElementEx( &element, &ALLOCATOR );
+    checkCounts( "projection" );
+
+    // Arena, interned keys and a key pool
+    startCounting();
+    JsonArena arena;
+    JsonKeyPool pool;
+    initJsonArenaEx( &arena, 0, &ALLOCATOR );
+    initJsonKeyPoolEx( &pool, &ALLOCATOR );
+    JsonParseOptions arenaOptions = { .pArena = &arena, .pAllocator = &ALLOCATOR, .flags = JSON_PARSE_INTERN_KEYS, };
+    parseCorpus( &arenaOptions );
+    arenaOptions.flags = JSON_PARSE_ZERO_COPY | JSON_PARSE_TWO_STAGE;
+    arenaOptions.pKeyPool = &pool;
+    parseCorpus( &arenaOptions );
+    CHECK( parseJsonBufferEx( &element, MIXED, strlen(MIXED), &arenaOptions, &info ) == JPE_NO_ERROR );
+    releaseJsonKeyPool( &pool );
+    releaseJsonArena( &arena );
+    checkCounts( "arena and key pool" );
+
+    // JSON Lines on several threads, and a root array in parallel
+    size_t length = 0;
+    for( int i = 0; i < 200; i++ ) {
+        length += (size_t)sprintf( document + length, (i % 50 == 7) ? "{\"bad\":}\n" : "%s\n", MIXED );
+    }
+    startCounting();
+    JsonRecordSet set;
+    JsonParseOptions lineOptions = { .pAllocator = &ALLOCATOR, };
+    CHECK( parseJsonLines( &set, document, length, &lineOptions, 4 ) == JPE_SYNTAX_ERROR_OBJECT );
+    releaseJsonRecordSet( &set );
+    checkCounts( "JSON Lines" );
+
+    length = 0;
+    document[length++] = '[';
+    while( length < 3 * 1024 * 1024 ) {
+        length += (size_t)sprintf( document + length, "%s,", MIXED );
+    }
+    document[length - 1] = ']';
+    startCounting();
+    options.ppPaths = (const char * const *)0;
+    options.pathCount = 0;
+    CHECK( parseJsonArrayParallel( &element, document, length, &options, 4, &info ) == JPE_NO_ERROR );
+    resetElementEx( &element, &ALLOCATOR );
+    checkCounts( "parallel array" );
+
+    // Push parser, byte by byte
+    startCounting();
+    for( size_t i = 0; i <= JSON_STRING_COUNT; i++ ) {
+        const char *data = (i < JSON_STRING_COUNT) ? JSON_STRINGS[i] : MIXED;
+        JsonPushParser *pParser = createJsonPushParser( &options );
+        CHECK( pParser != (JsonPushParser *)0 );
+        JsonParsingError ret = JPE_NO_ERROR;
+        for( size_t j = 0; data[j] && ret == JPE_NO_ERROR; j++ ) {
+            ret = jsonParserFeed( pParser, data + j, 1, &info );
+        }
+        if( ret == JPE_NO_ERROR ) {
+            element = (Element){ 0, };
+            if( jsonParserFinish( pParser, &element, &info ) == JPE_NO_ERROR ) { resetElementEx( &element, &ALLOCATOR ); }
+        }
+        releaseJsonPushParser( pParser );
+    }
+    checkCounts( "push parser" );
+
+    // Validation, lazy document and reformatter
+    startCounting();
+    CHECK( validateJsonEx( MIXED, strlen(MIXED), &ALLOCATOR, &info ) == JPE_NO_ERROR );
+    checkCounts( "validateJsonEx" );
+
+    startCounting();
+    JsonLazyDocument lazyDocument;
+    CHECK( openJsonLazyDocumentEx( &lazyDocument, MIXED, strlen(MIXED), &ALLOCATOR, &info ) == JPE_NO_ERROR );
+    JsonLazyValue root = getLazyRoot( &lazyDocument ), value, item;
+    CHECK( findLazyMember( &root, "deep", 4, &value ) && getLazyArrayElement( &value, 0, &item ) && getLazyLength( &root ) == 20 );
+    CHECK( findLazyMember( &root, "n", 1, &value ) && getLazyType( &value ) == TYPE_DBL_NUMBER );
+    CHECK( materializeLazyValue( &root, &element, (JsonArena *)0 ) == JPE_NO_ERROR );
+    resetElementEx( &element, &ALLOCATOR );
+    closeJsonLazyDocument( &lazyDocument );
+    checkCounts( "lazy document" );
+
+    startCounting();
+    CHECK( reformatJson( MIXED, strlen(MIXED), JSON_WRITE_PRETTY, &options, nullSink, (void *)0, &info ) == JPE_NO_ERROR );
+    JsonReformatter *pReformatter = createJsonReformatter( 0, &options, nullSink, (void *)0 );
+    for( size_t j = 0; MIXED[j]; j++ ) {
+        jsonReformatterFeed( pReformatter, MIXED + j, 1, &info ); // (long number split: the token is kept)
+    }
+    CHECK( jsonReformatterFinish( pReformatter, &info ) == JPE_NO_ERROR );
+    releaseJsonReformatter( pReformatter );
+    checkCounts( "reformatter" );
+
+    // File
+    startCounting();
+    CHECK( parseJsonFileEx( &element, "Fox.gltf", &options, &info ) == JPE_NO_ERROR );
+    resetElementEx( &element, &ALLOCATOR );
+    checkCounts( "parseJsonFileEx" );
+
+    return testResult( "allocator" );
+}
@@ -0,0 +1,157 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "testCommon.h"
+
+//
+// Reformatter: the errors of parseJsonBufferEx() in one buffer or byte by byte, and the layout of writeJson()
+//
+
+// Output collected in a growable buffer
+typedef struct
+{
+    char  *data;
+    size_t length;
+    size_t capacity;
+    int    callsLeft; // the sink fails when it reaches 0 (`-1`: never)
+} Output;
+
+static int outputSink(void *pSinkData, const char *data, size_t length)
+{
+    Output *pOutput = (Output *)pSinkData;
+    if( pOutput->callsLeft == 0 ) { return 1; }
+    if( pOutput->callsLeft > 0 ) { pOutput->callsLeft--; }
+    if( pOutput->capacity - pOutput->length < length + 1 ) {
+        while( pOutput->capacity - pOutput->length < length + 1 ) { pOutput->capacity = pOutput->capacity ? pOutput->capacity * 2 : 256; }
+        pOutput->data = (char *)realloc( pOutput->data, pOutput->capacity );
+    }
+    memcpy( pOutput->data + pOutput->length, data, length );
+    pOutput->length += length;
+    pOutput->data[pOutput->length] = '\0';
+    return 0;
+}
+
+// In chunks of `step` bytes (`0`: reformatJson() in one buffer)
+static JsonParsingError reformat(const char *data, size_t length, uint32_t flags, size_t maxDepth, size_t step, Output *pOutput, JsonErrorInfo *pOutErrorInfo)
+{
+    JsonParseOptions options = { .maxDepth = maxDepth, };
+    pOutput->length = 0;
+    if( pOutput->data ) { pOutput->data[0] = '\0'; }
+    if( step == 0 ) {
+        return reformatJson( data, length, flags, &options, outputSink, pOutput, pOutErrorInfo );
+    }
+
+    JsonReformatter *pReformatter = createJsonReformatter( flags, &options, outputSink, pOutput );
+    if( !pReformatter ) { return JPE_OUT_OF_MEMORY; }
+    JsonParsingError ret = JPE_NO_ERROR;
+    for( size_t offset = 0; offset < length && ret == JPE_NO_ERROR; offset += step ) {
+        ret = jsonReformatterFeed( pReformatter, data + offset, (length - offset < step) ? length - offset : step, pOutErrorInfo );
+    }
+    if( ret == JPE_NO_ERROR ) { ret = jsonReformatterFinish( pReformatter, pOutErrorInfo ); }
+    releaseJsonReformatter( pReformatter );
+    return ret;
+}
+
+static void checkReformat(const char *data, size_t length, size_t maxDepth)
+{
+    JsonParseOptions options = { .maxDepth = maxDepth, };
+    Element element = { 0, };
+    JsonErrorInfo info = { 0, };
+    JsonParsingError ret = parseJsonBufferEx( &element, data, length, &options, &info );
+
+    Output output = { .callsLeft = -1, };
+    const size_t STEPS[] = { 0, 1, 7 };
+    for( uint32_t flags = 0; flags <= JSON_WRITE_PRETTY; flags++ ) {
+        for( size_t i = 0; i < sizeof(STEPS) / sizeof(STEPS[0]); i++ ) {
+            JsonErrorInfo reformatInfo = { 0, };
+            JsonParsingError reformatRet = reformat( data, length, flags, maxDepth, STEPS[i], &output, &reformatInfo );
+            if( length == 0 ) { // empty input gives empty output (the parser has no value to return)
+                CHECK( reformatRet == JPE_NO_ERROR && output.length == 0 );
+                continue;
+            }
+            CHECK( ret == reformatRet );
+            if( ret != JPE_NO_ERROR ) { // (the location of a success is the end of the input, where the parser reports none)
+                CHECK( isSameErrorInfo( &info, &reformatInfo ) );
+                if( !isSameErrorInfo( &info, &reformatInfo ) ) {
+                    fprintf( stderr, "  %.*s (step %zu): %d at %zu:%zu (%zu), reformat %d at %zu:%zu (%zu)\n", (int)length, data, STEPS[i],
+                             info.error, info.line, info.column, info.position,
+                             reformatInfo.error, reformatInfo.line, reformatInfo.column, reformatInfo.position );
+                }
+            }
+            else {
+                // The same tree; the text of writeJson() (canonical tokens) is reformatted to itself
+                Element reformatted = { 0, };
+                CHECK( parseJsonBuffer( &reformatted, output.data, output.length, (JsonErrorInfo *)0 ) == JPE_NO_ERROR );
+                CHECK( isSameElement( &reformatted, &element ) );
+                resetElement( &reformatted );
+
+                size_t textLength = 0;
+                char *text = writeJson( &element, flags, &textLength );
+                CHECK( reformat( text, textLength, flags, maxDepth, STEPS[i], &output, (JsonErrorInfo *)0 ) == JPE_NO_ERROR );
+                CHECK( output.length == textLength && !memcmp( output.data, text, textLength ) );
+                free( text );
+            }
+        }
+    }
+    free( output.data );
+    resetElement( &element );
+}
+
+int main(void)
+{
+    const char *MORE_STRINGS[] = {
+        "[12345.678e-9, -0, true, false, null, \"\\u00e9\\\"\\\\\", {\"key\\n\": []}]",
+        "  {\"a\" :\r\n \"b\" }  ",
+        "\"\\u00\"",
+        "\"\\u12x4\"",
+        "\"unterminated",
+        "{\"a\":\"unterminated",
+        "[\"tab\tinside\"]",
+        "{\"a\":1 \"b\":2}",
+        "{\"a\" 1}",
+        "{1:2}",
+        "[1,]",
+        "[1 2]",
+        "[tru]",
+        "[1.]",
+        "-",
+        "1e",
+        "[1, 2",
+        "{\"a\":1",
+        "{\"a\":1}x",
+        "\xc3\xa9",
+        "",
+        "   ",
+    };
+    for( size_t i = 0; i < JSON_STRING_COUNT + sizeof(MORE_STRINGS) / sizeof(MORE_STRINGS[0]); i++ ) {
+        const char *data = (i < JSON_STRING_COUNT) ? JSON_STRINGS[i] : MORE_STRINGS[i - JSON_STRING_COUNT];
+        checkReformat( data, strlen(data), 0 );
+    }
+
+    // Nesting limit of pOptions->maxDepth
+    const char *NESTED = "[[[[{\"a\":[1]}]]]]";
+    checkReformat( NESTED, strlen(NESTED), 5 );
+    checkReformat( NESTED, strlen(NESTED), 6 );
+    checkReformat( NESTED, strlen(NESTED), 0 );
+
+    // A failing sink: when the buffer fills up (in the middle of the input) or at the end
+    static char document[4 * JSON_REFORMAT_BUFFER_SIZE];
+    size_t length = 0;
+    document[length++] = '[';
+    while( length < sizeof(document) - 64 ) {
+        length += (size_t)sprintf( document + length, "{\"key\" : [1, 2.5, \"value\"]}," );
+    }
+    document[length - 1] = ']';
+    for( int callsLeft = 0; callsLeft < 4; callsLeft++ ) {
+        for( size_t step = 0; step <= 1000; step += 1000 ) {
+            Output output = { .callsLeft = callsLeft, };
+            JsonErrorInfo info = { 0, };
+            CHECK( reformat( document, length, 0, 0, step, &output, &info ) == JPE_IO_ERROR && info.error == JPE_IO_ERROR );
+            free( output.data );
+        }
+    }
+    Output output = { .callsLeft = 0, };
+    CHECK( reformat( "[1]", 3, 0, 0, 0, &output, (JsonErrorInfo *)0 ) == JPE_IO_ERROR );
+    free( output.data );
+
+    return testResult( "reformatter" );
+}
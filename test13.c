@@ -0,0 +1,226 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "testCommon.h"
+
+//
+// Event (SAX) API: the events rebuild the tree of parseJsonBufferEx(), and a callback can stop parsing where it is called
+//
+
+#define MAX_LEVELS 256
+
+// The tree made from the events (as parseJsonString() would make it), and what the callbacks saw
+typedef struct
+{
+    Element     root;
+    Element     levels[MAX_LEVELS]; // open containers
+    size_t      capacities[MAX_LEVELS];
+    char       *keys[MAX_LEVELS];   // the key of the next member (objects)
+    uint32_t    keyLengths[MAX_LEVELS];
+    size_t      depth;
+
+    const char *data;               // the input: unescaped strings are slices of it
+    size_t      length;
+    size_t      slices;             // keys and strings in data
+    size_t      copies;             // keys and strings decoded elsewhere
+
+    size_t      eventCount;
+    size_t      cancelAt;           // the event that returns 1 (SIZE_MAX: none)
+    char        trace[256];         // one character per event (the first ones)
+} Builder;
+
+static char *copyText(Builder *pBuilder, const char *text, size_t length)
+{
+    if( text >= pBuilder->data && text + length <= pBuilder->data + pBuilder->length ) { pBuilder->slices++; }
+    else { pBuilder->copies++; }
+    char *copy = (char *)malloc( length + 1 );
+    memcpy( copy, text, length );
+    copy[length] = '\0';
+    return copy;
+}
+
+// Returns 1 (stop) for the event pBuilder->cancelAt
+static int onEvent(Builder *pBuilder, char event)
+{
+    if( pBuilder->eventCount < sizeof(pBuilder->trace) - 1 ) {
+        pBuilder->trace[pBuilder->eventCount] = event;
+        pBuilder->trace[pBuilder->eventCount + 1] = '\0';
+    }
+    return pBuilder->eventCount++ == pBuilder->cancelAt;
+}
+
+static void addValue(Builder *pBuilder, Element value)
+{
+    if( pBuilder->depth == 0 ) {
+        pBuilder->root = value;
+        return;
+    }
+    size_t level = pBuilder->depth - 1;
+    Element *pContainer = &(pBuilder->levels[level]);
+    size_t itemSize = (pContainer->type == TYPE_OBJECT) ? sizeof(ObjectNode) : sizeof(Element);
+    if( pContainer->length == pBuilder->capacities[level] ) {
+        pBuilder->capacities[level] = pBuilder->capacities[level] ? pBuilder->capacities[level] * 2 : 4;
+        pContainer->arrayValue = (Element *)realloc( pContainer->arrayValue, pBuilder->capacities[level] * itemSize );
+    }
+    if( pContainer->type == TYPE_OBJECT ) {
+        ObjectNode node = { .element = value, .key = pBuilder->keys[level], .keyLength = pBuilder->keyLengths[level], };
+        pContainer->objectValue[pContainer->length++] = node;
+        pBuilder->keys[level] = (char *)0;
+    }
+    else {
+        pContainer->arrayValue[pContainer->length++] = value;
+    }
+}
+
+static int onStart(Builder *pBuilder, ElementType type)
+{
+    if( pBuilder->depth == MAX_LEVELS ) { return 1; }
+    pBuilder->levels[pBuilder->depth] = (Element){ .type = type, };
+    pBuilder->capacities[pBuilder->depth] = 0;
+    pBuilder->keys[pBuilder->depth] = (char *)0;
+    pBuilder->depth++;
+    return 0;
+}
+
+static int onEnd(Builder *pBuilder)
+{
+    pBuilder->depth--;
+    addValue( pBuilder, pBuilder->levels[pBuilder->depth] );
+    return 0;
+}
+
+static int startObject(void *pUserData) { return onEvent( (Builder *)pUserData, '{' ) || onStart( (Builder *)pUserData, TYPE_OBJECT ); }
+static int startArray(void *pUserData)  { return onEvent( (Builder *)pUserData, '[' ) || onStart( (Builder *)pUserData, TYPE_ARRAY ); }
+static int endObject(void *pUserData)   { return onEvent( (Builder *)pUserData, '}' ) || onEnd( (Builder *)pUserData ); }
+static int endArray(void *pUserData)    { return onEvent( (Builder *)pUserData, ']' ) || onEnd( (Builder *)pUserData ); }
+
+static int key(void *pUserData, const char *key, size_t keyLength)
+{
+    Builder *pBuilder = (Builder *)pUserData;
+    if( onEvent( pBuilder, 'k' ) ) { return 1; }
+    pBuilder->keys[pBuilder->depth - 1] = copyText( pBuilder, key, keyLength );
+    pBuilder->keyLengths[pBuilder->depth - 1] = (uint32_t)keyLength;
+    return 0;
+}
+
+static int stringValue(void *pUserData, const char *value, size_t length)
+{
+    Builder *pBuilder = (Builder *)pUserData;
+    if( onEvent( pBuilder, 's' ) ) { return 1; }
+    addValue( pBuilder, (Element){ .type = TYPE_STRING, .length = (uint32_t)length, .stringValue = copyText( pBuilder, value, length ) } );
+    return 0;
+}
+
+static int intNumberValue(void *pUserData, int64_t value)
+{
+    if( onEvent( (Builder *)pUserData, 'i' ) ) { return 1; }
+    addValue( (Builder *)pUserData, (Element){ .type = TYPE_INT_NUMBER, .iNumberValue = value } );
+    return 0;
+}
+
+static int dblNumberValue(void *pUserData, double value)
+{
+    if( onEvent( (Builder *)pUserData, 'd' ) ) { return 1; }
+    addValue( (Builder *)pUserData, (Element){ .type = TYPE_DBL_NUMBER, .dNumberValue = value } );
+    return 0;
+}
+
+static int booleanValue(void *pUserData, int value)
+{
+    if( onEvent( (Builder *)pUserData, 'b' ) ) { return 1; }
+    addValue( (Builder *)pUserData, (Element){ .type = TYPE_BOOLEAN, .iNumberValue = value } );
+    return 0;
+}
+
+static int nullValue(void *pUserData)
+{
+    if( onEvent( (Builder *)pUserData, 'n' ) ) { return 1; }
+    addValue( (Builder *)pUserData, (Element){ .type = TYPE_NULL, } );
+    return 0;
+}
+
+static const JsonSaxHandler HANDLER = {
+    startObject, endObject, startArray, endArray, key, stringValue, intNumberValue, dblNumberValue, booleanValue, nullValue,
+};
+
+static JsonParsingError parseEvents(Builder *pBuilder, const char *data, size_t length, size_t cancelAt, JsonErrorInfo *pOutErrorInfo)
+{
+    memset( pBuilder, 0, sizeof(*pBuilder) );
+    pBuilder->data = data;
+    pBuilder->length = length;
+    pBuilder->cancelAt = cancelAt;
+    return parseJsonSax( data, length, &HANDLER, pBuilder, pOutErrorInfo );
+}
+
+// What is left of the tree (and of the containers left open by an error or a cancel)
+static void releaseBuilder(Builder *pBuilder)
+{
+    while( pBuilder->depth ) {
+        free( pBuilder->keys[pBuilder->depth - 1] );
+        onEnd( pBuilder );
+    }
+    resetElement( &(pBuilder->root) );
+}
+
+static void checkEvents(const char *data)
+{
+    size_t length = strlen(data);
+    Element element = { 0, };
+    JsonErrorInfo info = { 0, }, saxInfo = { 0, };
+    JsonParsingError ret = parseJsonBufferEx( &element, data, length, (const JsonParseOptions *)0, &info );
+
+    Builder builder;
+    JsonParsingError saxRet = parseEvents( &builder, data, length, SIZE_MAX, &saxInfo );
+    CHECK( ret == saxRet );
+    CHECK( isSameErrorInfo( &info, &saxInfo ) );
+    CHECK( ret != JPE_NO_ERROR || (builder.depth == 0 && isSameElement( &(builder.root), &element )) );
+    releaseBuilder( &builder );
+    resetElement( &element );
+}
+
+// Stopped by every event in turn: JPE_CANCELLED at POSITIONS[event], and no event after it
+static void checkCancel(const char *data, const char *trace, const size_t *pPositions)
+{
+    size_t length = strlen(data);
+    for( size_t i = 0; i < strlen(trace); i++ ) {
+        Builder builder;
+        JsonErrorInfo info = { 0, };
+        CHECK( parseEvents( &builder, data, length, i, &info ) == JPE_CANCELLED );
+        CHECK( info.error == JPE_CANCELLED && info.position == pPositions[i] && info.line == 1 );
+        CHECK( builder.eventCount == i + 1 && !strncmp( builder.trace, trace, i + 1 ) );
+        if( info.position != pPositions[i] ) {
+            fprintf( stderr, "  %s: event %zu '%c' stopped at %zu (expected %zu)\n", data, i, trace[i], info.position, pPositions[i] );
+        }
+        releaseBuilder( &builder );
+    }
+}
+
+int main(void)
+{
+    // Every document of test1.c (errors with the locations of parseJsonBufferEx())
+    for( size_t i = 0; i < JSON_STRING_COUNT; i++ ) {
+        checkEvents( JSON_STRINGS[i] );
+    }
+
+    // The event sequence; start events stop at the bracket, others after their token
+    const char *EVERY_KIND = "{\"k\":[1,2.5,\"s\",true,null,{}]}";
+    Builder builder;
+    CHECK( parseEvents( &builder, EVERY_KIND, strlen(EVERY_KIND), SIZE_MAX, (JsonErrorInfo *)0 ) == JPE_NO_ERROR );
+    CHECK( !strcmp( builder.trace, "{k[idsbn{}]}" ) );
+    releaseBuilder( &builder );
+    const size_t POSITIONS[] = { 0, 4, 5, 7, 11, 15, 20, 25, 26, 28, 29, 30 };
+    checkCancel( EVERY_KIND, "{k[idsbn{}]}", POSITIONS );
+    checkEvents( EVERY_KIND );
+
+    // Keys and strings without escapes are slices of data; with escapes they are decoded (elsewhere)
+    const char *ESCAPES = "{\"plain\":\"text\",\"k\\u0065y\":\"a\\nb\",\"x\":[\"\\\"\",\"\"]}";
+    CHECK( parseEvents( &builder, ESCAPES, strlen(ESCAPES), SIZE_MAX, (JsonErrorInfo *)0 ) == JPE_NO_ERROR );
+    CHECK( builder.slices == 4 && builder.copies == 3 );
+    releaseBuilder( &builder );
+    checkEvents( ESCAPES );
+
+    // Callbacks left `NULL` are skipped
+    JsonSaxHandler none = { 0, };
+    CHECK( parseJsonSax( EVERY_KIND, strlen(EVERY_KIND), &none, (void *)0, (JsonErrorInfo *)0 ) == JPE_NO_ERROR );
+
+    return testResult( "events" );
+}
@@ -0,0 +1,89 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "testCommon.h"
+
+//
+// parseJsonLines(): every record is what parseJsonBuffer() makes of its line, located in the whole buffer
+//
+
+static void checkLines(const char *data, size_t length, const JsonParseOptions *pOptions, unsigned int threadCount)
+{
+    JsonRecordSet set;
+    JsonParsingError ret = parseJsonLines( &set, data, length, pOptions, threadCount );
+
+    // Walk the lines as a reader would: blank ones (whitespace and '\r' only) are not records
+    JsonParsingError firstError = JPE_NO_ERROR;
+    size_t count = 0, lineNumber = 1;
+    for( size_t offset = 0; offset < length; lineNumber++ ) {
+        const char *pNewLine = (const char *)memchr( data + offset, '\n', length - offset );
+        size_t lineLength = pNewLine ? (size_t)(pNewLine - (data + offset)) : length - offset;
+        size_t blank = 0;
+        while( blank < lineLength && strchr( " \t\r", data[offset + blank] ) ) { blank++; }
+
+        if( blank < lineLength ) {
+            Element element = { 0, };
+            JsonErrorInfo info = { 0, };
+            JsonParsingError lineRet = parseJsonBuffer( &element, data + offset, lineLength, &info );
+            if( firstError == JPE_NO_ERROR ) { firstError = lineRet; }
+            info.line += lineNumber - 1;
+            info.position += offset;
+
+            CHECK( count < set.count );
+            if( count < set.count ) {
+                const JsonRecord *pRecord = &(set.records[count]);
+                CHECK( pRecord->offset == offset && pRecord->length == lineLength && pRecord->line == lineNumber );
+                CHECK( isSameErrorInfo( &(pRecord->errorInfo), &info ) );
+                CHECK( lineRet == JPE_NO_ERROR ? isSameElement( &(pRecord->element), &element ) : pRecord->element.type == TYPE_NULL );
+                if( !isSameErrorInfo( &(pRecord->errorInfo), &info ) ) {
+                    fprintf( stderr, "  line %zu: %d at %zu:%zu (%zu), expected %d at %zu:%zu (%zu)\n", lineNumber,
+                             pRecord->errorInfo.error, pRecord->errorInfo.line, pRecord->errorInfo.column, pRecord->errorInfo.position,
+                             info.error, info.line, info.column, info.position );
+                }
+            }
+            count++;
+            resetElement( &element );
+        }
+        offset += lineLength + 1;
+    }
+    CHECK( set.count == count );
+    CHECK( ret == firstError );
+    releaseJsonRecordSet( &set );
+}
+
+int main(void)
+{
+    // Every one-line document of test1.c (valid or not), with blank lines and "\r\n" in between, many times over
+    const char *SEPARATORS[] = { "\n", "\r\n", "\n\n", "\n   \n", "\n\t\r\n", " \r\n \n" };
+    static char data[1024 * 1024];
+    size_t length = 0;
+    for( size_t round = 0; round < 20; round++ ) {
+        for( size_t i = 0; i < JSON_STRING_COUNT; i++ ) {
+            if( strchr( JSON_STRINGS[i], '\n' ) || strlen(JSON_STRINGS[i]) + 8 > sizeof(data) - length ) { continue; }
+            length += (size_t)sprintf( data + length, "%s%s", JSON_STRINGS[i], SEPARATORS[(round + i) % (sizeof(SEPARATORS) / sizeof(SEPARATORS[0]))] );
+        }
+    }
+    length += (size_t)sprintf( data + length, "{\"last\":\"line without a newline\"}" );
+
+    JsonParseOptions zeroCopy = { .flags = JSON_PARSE_ZERO_COPY | JSON_PARSE_INTERN_KEYS, };
+    const unsigned int THREAD_COUNTS[] = { 1, 3, 8, 0 };
+    for( size_t i = 0; i < sizeof(THREAD_COUNTS) / sizeof(THREAD_COUNTS[0]); i++ ) {
+        checkLines( data, length, (const JsonParseOptions *)0, THREAD_COUNTS[i] );
+        checkLines( data, length, &zeroCopy, THREAD_COUNTS[i] );
+    }
+
+    // Only valid records; only blank lines; nothing
+    const char *VALID = "[1]\r\n\r\n{\"a\":\"b\"}\n  \"x\"  \n";
+    checkLines( VALID, strlen(VALID), (const JsonParseOptions *)0, 2 );
+    checkLines( "\n \r\n\t\n", 5, (const JsonParseOptions *)0, 2 );
+    checkLines( "", 0, (const JsonParseOptions *)0, 2 );
+
+    // Options the record set can not take
+    JsonArena arena;
+    initJsonArena( &arena, 0 );
+    JsonParseOptions withArena = { .pArena = &arena, };
+    JsonRecordSet set;
+    CHECK( parseJsonLines( &set, VALID, strlen(VALID), &withArena, 2 ) == JPE_INVALID_ARGUMENT );
+    releaseJsonArena( &arena );
+
+    return testResult( "JSON Lines" );
+}
@@ -0,0 +1,87 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "testCommon.h"
+
+//
+// JsonParseStats: the counts of a known document, the same for every engine
+//
+
+typedef struct
+{
+    size_t bytes, objects, arrays, strings, numbers, literals, keys, maxDepth, stringBytes;
+} ExpectedStats;
+
+static void checkStats(const JsonParseStats *pStats, const ExpectedStats *pExpected, const char *what)
+{
+    int same = pStats->bytes == pExpected->bytes && pStats->objects == pExpected->objects && pStats->arrays == pExpected->arrays &&
+               pStats->strings == pExpected->strings && pStats->numbers == pExpected->numbers && pStats->literals == pExpected->literals &&
+               pStats->keys == pExpected->keys && pStats->maxDepth == pExpected->maxDepth && pStats->stringBytes == pExpected->stringBytes;
+    CHECK( same );
+    if( !same ) {
+        fprintf( stderr, "  %s: bytes %zu objects %zu arrays %zu strings %zu numbers %zu literals %zu keys %zu maxDepth %zu stringBytes %zu\n", what,
+                 pStats->bytes, pStats->objects, pStats->arrays, pStats->strings, pStats->numbers, pStats->literals, pStats->keys,
+                 pStats->maxDepth, pStats->stringBytes );
+    }
+}
+
+// With and without an arena, with and without JSON_PARSE_TWO_STAGE
+static void checkParse(const char *data, JsonParsingError expectedRet, const ExpectedStats *pExpected)
+{
+    JsonArena arena;
+    initJsonArena( &arena, 0 );
+    for( int variant = 0; variant < 4; variant++ ) {
+        JsonParseStats stats;
+        memset( &stats, 0xFF, sizeof(stats) ); // (zeroed by the parser)
+        JsonParseOptions options = { .pStats = &stats, .pArena = (variant & 1) ? &arena : (JsonArena *)0,
+                                     .flags = (variant & 2) ? JSON_PARSE_TWO_STAGE : 0, };
+        Element element = { 0, };
+        CHECK( parseJsonBufferEx( &element, data, strlen(data), &options, (JsonErrorInfo *)0 ) == expectedRet );
+        checkStats( &stats, pExpected, (variant & 2) ? "two-stage" : "engine" );
+        // (a literal root takes no memory)
+        CHECK( expectedRet != JPE_NO_ERROR || pExpected->maxDepth == 0 || (stats.allocations > 0 && stats.allocatedBytes > 0 && stats.workingBytes > 0) );
+        if( variant & 1 ) { clearJsonArena( &arena ); }
+        else { resetElement( &element ); }
+    }
+    releaseJsonArena( &arena );
+
+    // The push parser adds up its chunks
+    JsonParseStats stats;
+    JsonParseOptions options = { .pStats = &stats, };
+    JsonPushParser *pParser = createJsonPushParser( &options );
+    JsonParsingError ret = JPE_NO_ERROR;
+    size_t length = strlen(data);
+    for( size_t offset = 0; offset < length && ret == JPE_NO_ERROR; offset += 3 ) {
+        ret = jsonParserFeed( pParser, data + offset, (length - offset < 3) ? length - offset : 3, (JsonErrorInfo *)0 );
+    }
+    Element element = { 0, };
+    if( ret == JPE_NO_ERROR ) { ret = jsonParserFinish( pParser, &element, (JsonErrorInfo *)0 ); }
+    CHECK( ret == expectedRet );
+    checkStats( &stats, pExpected, "push parser" );
+    if( ret == JPE_NO_ERROR ) { resetElement( &element ); }
+    releaseJsonPushParser( pParser );
+}
+
+int main(void)
+{
+    // 3 objects, 3 arrays, 2 strings ("s", "xé": 3 bytes), 2 numbers, 2 literals, 4 keys, 3 levels
+    const char *DOCUMENT = "{\"a\":[1,2.5,\"s\",true,null,{\"b\":\"x\\u00e9\"}],\"c\":{},\"d\":[[]]}";
+    ExpectedStats expected = { .bytes = strlen(DOCUMENT), .objects = 3, .arrays = 3, .strings = 2, .numbers = 2, .literals = 2,
+                               .keys = 4, .maxDepth = 3, .stringBytes = 1 + 3 + 4, };
+    checkParse( DOCUMENT, JPE_NO_ERROR, &expected );
+
+    // Whitespace around it is parsed too
+    const char *SPACED = "  [ \"abc\" , -7 ]\n";
+    ExpectedStats spacedExpected = { .bytes = strlen(SPACED), .arrays = 1, .strings = 1, .numbers = 1, .maxDepth = 1, .stringBytes = 3, };
+    checkParse( SPACED, JPE_NO_ERROR, &spacedExpected );
+
+    // A scalar document: depth 0
+    ExpectedStats scalarExpected = { .bytes = 4, .literals = 1, };
+    checkParse( "true", JPE_NO_ERROR, &scalarExpected );
+
+    // Up to the error: what was made before it
+    const char *INVALID = "[1,{\"k\":2},x]";
+    ExpectedStats invalidExpected = { .bytes = 11, .objects = 1, .arrays = 1, .numbers = 2, .keys = 1, .maxDepth = 2, .stringBytes = 1, };
+    checkParse( INVALID, JPE_SYNTAX_ERROR_ARRAY, &invalidExpected );
+
+    return testResult( "parse stats" );
+}
@@ -0,0 +1,78 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "testCommon.h"
+
+//
+// JSON_PARSE_TWO_STAGE: the same result and errors as the engine alone
+//
+
+static void checkTwoStage(const char *data, size_t length, size_t maxDepth, JsonArena *pArena)
+{
+    JsonParseOptions options = { .pArena = pArena, .maxDepth = maxDepth, };
+    JsonParseOptions twoStageOptions = options;
+    twoStageOptions.flags |= JSON_PARSE_TWO_STAGE;
+
+    Element element = { 0, }, twoStageElement = { 0, };
+    JsonErrorInfo info = { 0, }, twoStageInfo = { 0, };
+    JsonParsingError ret = parseJsonBufferEx( &element, data, length, &options, &info );
+    JsonParsingError twoStageRet = parseJsonBufferEx( &twoStageElement, data, length, &twoStageOptions, &twoStageInfo );
+
+    CHECK( ret == twoStageRet );
+    CHECK( isSameErrorInfo( &info, &twoStageInfo ) );
+    CHECK( isSameElement( &element, &twoStageElement ) );
+    if( !isSameErrorInfo( &info, &twoStageInfo ) ) {
+        fprintf( stderr, "  %.*s: %d at %zu, two-stage %d at %zu\n", (int)length, data, info.error, info.position, twoStageInfo.error, twoStageInfo.position );
+    }
+
+    if( pArena ) {
+        clearJsonArena( pArena );
+    }
+    else {
+        resetElement( &element );
+        resetElement( &twoStageElement );
+    }
+}
+
+int main(void)
+{
+    JsonArena arena;
+    initJsonArena( &arena, 0 );
+
+    for( size_t i = 0; i < JSON_STRING_COUNT; i++ ) {
+        checkTwoStage( JSON_STRINGS[i], strlen(JSON_STRINGS[i]), 0, (JsonArena *)0 );
+        checkTwoStage( JSON_STRINGS[i], strlen(JSON_STRINGS[i]), 0, &arena );
+    }
+
+    // Quotes, escapes and errors on both sides of the 64-byte blocks of stage 1
+    const char *ITEMS[] = {
+        "\"a\\\\\"",          // escaped backslash before the closing quote
+        "\"\\\"]\"",          // escaped quote, then a bracket inside the string
+        "{\"k\\u00e9\":[]}",
+        "\"unterminated",
+        "\"tab\tinside\"",
+        "\"\\x\"",
+        "tru",
+        "[1,]",
+        "{\"a\" 1}",
+    };
+    char buffer[256];
+    for( size_t item = 0; item < sizeof(ITEMS) / sizeof(ITEMS[0]); item++ ) {
+        for( size_t padding = 50; padding < 80; padding++ ) {
+            size_t length = 0;
+            buffer[length++] = '[';
+            memset( buffer + length, ' ', padding );
+            length += padding;
+            length += (size_t)sprintf( buffer + length, "%s, 1]", ITEMS[item] );
+            checkTwoStage( buffer, length, 0, (JsonArena *)0 );
+            checkTwoStage( buffer, length - 1, 0, (JsonArena *)0 ); // (without the closing bracket)
+        }
+    }
+
+    // Nesting limit
+    const char *NESTED = "[[[[[1]]]]]";
+    checkTwoStage( NESTED, strlen(NESTED), 4, (JsonArena *)0 );
+    checkTwoStage( NESTED, strlen(NESTED), 5, (JsonArena *)0 );
+
+    releaseJsonArena( &arena );
+    return testResult( "two-stage" );
+}
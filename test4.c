@@ -0,0 +1,102 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "testCommon.h"
+
+//
+// parseJsonArrayParallel(): the result and errors of parseJsonBufferEx() on a root array of several chunks
+//
+
+#define DOCUMENT_SIZE (6 * 1024 * 1024) // chunks are 1 MiB or more (JSON_PARALLEL_CHUNK_SIZE)
+#define THREAD_COUNT  4
+
+static void checkParallel(const char *data, size_t length, JsonArena *pArena)
+{
+    JsonParseOptions options = { .pArena = pArena, };
+    Element element = { 0, }, parallelElement = { 0, };
+    JsonErrorInfo info = { 0, }, parallelInfo = { 0, };
+    JsonParsingError ret = parseJsonBufferEx( &element, data, length, &options, &info );
+    JsonParsingError parallelRet = parseJsonArrayParallel( &parallelElement, data, length, &options, THREAD_COUNT, &parallelInfo );
+
+    CHECK( ret == parallelRet );
+    CHECK( isSameErrorInfo( &info, &parallelInfo ) );
+    CHECK( ret != JPE_NO_ERROR || isSameElement( &element, &parallelElement ) ); // (on error the engine may leave the root it read)
+    if( !isSameErrorInfo( &info, &parallelInfo ) ) {
+        fprintf( stderr, "  %d at %zu:%zu (%zu), parallel %d at %zu:%zu (%zu)\n", info.error, info.line, info.column, info.position,
+                 parallelInfo.error, parallelInfo.line, parallelInfo.column, parallelInfo.position );
+    }
+
+    if( pArena ) {
+        clearJsonArena( pArena );
+    }
+    else {
+        resetElement( &element );
+        resetElement( &parallelElement );
+    }
+}
+
+// The first element after offset (one past its ',')
+static size_t nextElement(const char *data, size_t offset)
+{
+    const char *pComma = strstr( data + offset, ",\n" );
+    return (size_t)(pComma - data) + 2;
+}
+
+int main(void)
+{
+    // Elements full of ',' ']' '"' (in strings), so that chunk boundaries fall next to them
+    const char *ITEMS[] = {
+        "\"a, b], \\\"c\\\" [d\"",
+        "{\"key, ]\":[1,-2.5e3,\"\\\\\"],\"x\":{\"y\":null}}",
+        "[\",\",\"]\",\"\\\"\",[]]",
+        "123456789",
+        "\"\\u00e9, \\\"]\"",
+        "true",
+    };
+    char *document = (char *)malloc( DOCUMENT_SIZE + 256 );
+    char *copy = (char *)malloc( DOCUMENT_SIZE + 256 );
+    if( !document || !copy ) { return 1; }
+
+    size_t length = 0;
+    document[length++] = '[';
+    for( size_t i = 0; length < DOCUMENT_SIZE; i++ ) {
+        length += (size_t)sprintf( document + length, "%s%s", i ? ",\n" : "", ITEMS[i % (sizeof(ITEMS) / sizeof(ITEMS[0]))] );
+    }
+    length += (size_t)sprintf( document + length, "]\n" );
+
+    JsonArena arena;
+    initJsonArena( &arena, 0 );
+
+    // Valid
+    checkParallel( document, length, (JsonArena *)0 );
+    checkParallel( document, length, &arena );
+
+    // An error around every chunk boundary and in the middle of later chunks
+    const size_t OFFSETS[] = { 1024 * 1024 - 8, 1024 * 1024, 2 * 1024 * 1024 + 3, 3 * 1024 * 1024 + 512 * 1024, DOCUMENT_SIZE - 100 };
+    const char *ERRORS[] = { "tru", "\"\\x\"", "1 2", "[1,]", "{\"a\" 1}" };
+    for( size_t i = 0; i < sizeof(OFFSETS) / sizeof(OFFSETS[0]); i++ ) {
+        for( size_t j = 0; j < sizeof(ERRORS) / sizeof(ERRORS[0]); j++ ) {
+            size_t at = nextElement( document, OFFSETS[i] );
+            memcpy( copy, document, at );
+            size_t copyLength = at + (size_t)sprintf( copy + at, "%s,", ERRORS[j] );
+            memcpy( copy + copyLength, document + at, length - at );
+            copyLength += length - at;
+            checkParallel( copy, copyLength, (JsonArena *)0 );
+        }
+    }
+
+    // Invalid documents that mislead the pre-scan of the split points: a stray quote or bracket, a missing end
+    const char STRAYS[] = { '"', ']', '[', '\\' };
+    for( size_t i = 0; i < sizeof(STRAYS); i++ ) {
+        size_t at = nextElement( document, 2 * 1024 * 1024 + 100 ) - 2;
+        memcpy( copy, document, length );
+        copy[at] = STRAYS[i]; // (over a ',')
+        checkParallel( copy, length, (JsonArena *)0 );
+    }
+    checkParallel( document, length - 2, (JsonArena *)0 ); // without the closing bracket
+    checkParallel( document, length - 4, (JsonArena *)0 ); // inside the last element
+
+    releaseJsonArena( &arena );
+    free( document );
+    free( copy );
+    return testResult( "parallel array" );
+}
@@ -0,0 +1,78 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "testCommon.h"
+
+//
+// Push parser: any split of the input gives the tree and the error of one parseJsonBufferEx()
+//
+
+// Feed data in chunks: up to `split` first, then `step` bytes at a time (each chunk a copy that is freed right after)
+static JsonParsingError pushParse(const char *data, size_t length, size_t split, size_t step, Element *pOutElement, JsonErrorInfo *pOutErrorInfo)
+{
+    JsonPushParser *pParser = createJsonPushParser( (const JsonParseOptions *)0 );
+    if( !pParser ) { return JPE_OUT_OF_MEMORY; }
+
+    JsonParsingError ret = JPE_NO_ERROR;
+    for( size_t offset = 0; offset < length && ret == JPE_NO_ERROR; ) {
+        size_t size = (offset < split) ? split - offset : step;
+        if( size > length - offset ) { size = length - offset; }
+        char *chunk = (char *)malloc( size );
+        memcpy( chunk, data + offset, size );
+        ret = jsonParserFeed( pParser, chunk, size, pOutErrorInfo );
+        free( chunk );
+        offset += size;
+    }
+    if( ret == JPE_NO_ERROR ) { ret = jsonParserFinish( pParser, pOutElement, pOutErrorInfo ); }
+    releaseJsonPushParser( pParser );
+    return ret;
+}
+
+static void checkPush(const char *data, size_t length, size_t split, size_t step)
+{
+    Element element = { 0, }, pushElement = { 0, };
+    JsonErrorInfo info = { 0, }, pushInfo = { 0, };
+    JsonParsingError ret = parseJsonBufferEx( &element, data, length, (const JsonParseOptions *)0, &info );
+    JsonParsingError pushRet = pushParse( data, length, split, step, &pushElement, &pushInfo );
+
+    CHECK( ret == pushRet );
+    CHECK( isSameErrorInfo( &info, &pushInfo ) );
+    CHECK( ret != JPE_NO_ERROR || isSameElement( &element, &pushElement ) ); // (on error the engine may leave the root it read)
+    if( !isSameErrorInfo( &info, &pushInfo ) ) {
+        fprintf( stderr, "  %.*s (split %zu, step %zu): %d at %zu, push %d at %zu\n", (int)length, data, split, step,
+                 info.error, info.position, pushInfo.error, pushInfo.position );
+    }
+
+    resetElement( &element );
+    resetElement( &pushElement );
+}
+
+int main(void)
+{
+    // Tokens, escapes and errors for the splits to fall into
+    const char *MORE_STRINGS[] = {
+        "[12345.678e-9, -0, true, false, null, \"\\u00e9\\\"\\\\\", {\"key\\n\": []}]",
+        "  {\"a\" : \"b\" }  ",
+        "\"\\u00\"",
+        "\"unterminated",
+        "[1, 2",
+        "{\"a\":1",
+        "tru",
+        "1e",
+        "",
+        "   ",
+    };
+
+    for( size_t i = 0; i < JSON_STRING_COUNT + sizeof(MORE_STRINGS) / sizeof(MORE_STRINGS[0]); i++ ) {
+        const char *data = (i < JSON_STRING_COUNT) ? JSON_STRINGS[i] : MORE_STRINGS[i - JSON_STRING_COUNT];
+        size_t length = strlen(data);
+
+        checkPush( data, length, 0, 1 );                 // byte by byte
+        checkPush( data, length, 0, length ? length : 1 ); // in one chunk
+        for( size_t split = 1; split < length; split++ ) {  // in two chunks, split anywhere (inside tokens too)
+            checkPush( data, length, split, length );
+        }
+        checkPush( data, length, 0, 3 );
+    }
+
+    return testResult( "push parser" );
+}
@@ -0,0 +1,148 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "testCommon.h"
+
+//
+// Binary snapshot: createJsonSnapshot() -> openJsonSnapshotBuffer() reads back the parsed tree
+//
+
+// The snapshot value holds pElement (found by index and by key)
+static int isSameSnapshotValue(const JsonSnapshotValue *pValue, const Element *pElement)
+{
+    if( getSnapshotType( pValue ) != pElement->type ) { return 0; }
+    switch( pElement->type )
+    {
+        case TYPE_NULL:       return getSnapshotLength( pValue ) == 0;
+        case TYPE_BOOLEAN:
+        case TYPE_INT_NUMBER: return getSnapshotInt( pValue ) == pElement->iNumberValue;
+        case TYPE_DBL_NUMBER:
+        {
+            double value = getSnapshotDouble( pValue );
+            return !memcmp( &value, &(pElement->dNumberValue), sizeof(double) );
+        }
+        case TYPE_STRING:
+        {
+            size_t length = 0;
+            const char *string = getSnapshotString( pValue, &length );
+            return string && length == pElement->length && !memcmp( string, pElement->stringValue, length ) && string[length] == '\0';
+        }
+        case TYPE_ARRAY:
+            if( getSnapshotLength( pValue ) != pElement->length ) { return 0; }
+            for( uint32_t i = 0; i < pElement->length; i++ ) {
+                JsonSnapshotValue item;
+                if( !getSnapshotArrayElement( pValue, i, &item ) || !isSameSnapshotValue( &item, &(pElement->arrayValue[i]) ) ) { return 0; }
+            }
+            JsonSnapshotValue past;
+            return !getSnapshotArrayElement( pValue, pElement->length, &past );
+        case TYPE_OBJECT:
+            if( getSnapshotLength( pValue ) != pElement->length ) { return 0; }
+            for( uint32_t i = 0; i < pElement->length; i++ ) {
+                const ObjectNode *pNode = &(pElement->objectValue[i]);
+                const char *key = (const char *)0;
+                size_t keyLength = 0;
+                JsonSnapshotValue member, found;
+                if( !getSnapshotMember( pValue, i, &key, &keyLength, &member ) ||
+                    keyLength != pNode->keyLength || memcmp( key, pNode->key, keyLength ) ||
+                    !isSameSnapshotValue( &member, &(pNode->element) ) ) {
+                    return 0;
+                }
+                // The first member of that name, as findMember() finds it
+                if( !findSnapshotMember( pValue, pNode->key, pNode->keyLength, &found ) ||
+                    !isSameSnapshotValue( &found, findMember( pElement, pNode->key, pNode->keyLength ) ) ) {
+                    return 0;
+                }
+            }
+            JsonSnapshotValue missing;
+            return !findSnapshotMember( pValue, "no such key", 11, &missing );
+    }
+    return 0;
+}
+
+static void checkSnapshot(const char *data)
+{
+    Element element = { 0, };
+    CHECK( parseJsonString( &element, data, (JsonErrorInfo *)0 ) == JPE_NO_ERROR );
+
+    size_t length = 0;
+    char *image = createJsonSnapshot( &element, &length );
+    CHECK( image != (char *)0 );
+    if( image ) {
+        JsonSnapshot snapshot;
+        CHECK( openJsonSnapshotBuffer( &snapshot, image, length ) == JPE_NO_ERROR );
+        JsonSnapshotValue root = getSnapshotRoot( &snapshot );
+        CHECK( isSameSnapshotValue( &root, &element ) );
+        closeJsonSnapshot( &snapshot );
+        free( image );
+    }
+    resetElement( &element );
+}
+
+int main(void)
+{
+    // Every valid document of test1.c
+    for( size_t i = 0; i < JSON_STRING_COUNT; i++ ) {
+        Element element = { 0, };
+        if( parseJsonString( &element, JSON_STRINGS[i], (JsonErrorInfo *)0 ) == JPE_NO_ERROR ) {
+            checkSnapshot( JSON_STRINGS[i] );
+        }
+        resetElement( &element );
+    }
+
+    // An object with the hashed key index (JSON_OBJECT_INDEX_THRESHOLD members or more), with values of every kind:
+    // small and boxed integers, doubles in place and boxed, shared keys and a repeated key
+    char document[4096];
+    size_t length = (size_t)sprintf( document, "{" );
+    for( int i = 0; i < 40; i++ ) {
+        length += (size_t)sprintf( document + length, "\"member%d\":", i );
+        switch( i % 8 ) {
+            case 0: length += (size_t)sprintf( document + length, "%d,", i * 1000 ); break;
+            case 1: length += (size_t)sprintf( document + length, "-9223372036854775808," ); break;
+            case 2: length += (size_t)sprintf( document + length, "%d.25,", i ); break;
+            case 3: length += (size_t)sprintf( document + length, "0.1," ); break;
+            case 4: length += (size_t)sprintf( document + length, "\"value \\u00e9 %d\",", i ); break;
+            case 5: length += (size_t)sprintf( document + length, "[true,false,null,{\"member%d\":[]}],", i ); break;
+            case 6: length += (size_t)sprintf( document + length, "{},"); break;
+            case 7: length += (size_t)sprintf( document + length, "\"\","); break;
+        }
+    }
+    length += (size_t)sprintf( document + length, "\"member0\":\"again\"}" );
+    checkSnapshot( document );
+
+    // Damaged images are rejected by the header check, or read as empty values
+    Element element = { 0, };
+    parseJsonString( &element, document, (JsonErrorInfo *)0 );
+    size_t imageLength = 0;
+    char *image = createJsonSnapshot( &element, &imageLength );
+    char *damaged = (char *)malloc( imageLength );
+    CHECK( image && damaged );
+    if( image && damaged ) {
+        JsonSnapshot snapshot;
+        const size_t DAMAGED_BYTES[] = { 0, 3, 4, 6 }; // magic, version, byte order
+        for( size_t i = 0; i < sizeof(DAMAGED_BYTES) / sizeof(DAMAGED_BYTES[0]); i++ ) {
+            memcpy( damaged, image, imageLength );
+            damaged[DAMAGED_BYTES[i]] ^= 0x40;
+            CHECK( openJsonSnapshotBuffer( &snapshot, damaged, imageLength ) == JPE_INVALID_SNAPSHOT );
+        }
+        CHECK( openJsonSnapshotBuffer( &snapshot, image, imageLength - 8 ) == JPE_INVALID_SNAPSHOT ); // truncated
+        CHECK( openJsonSnapshotBuffer( &snapshot, image, 8 ) == JPE_INVALID_SNAPSHOT );
+
+        memcpy( damaged, image, imageLength );
+        memset( damaged + imageLength - 64, 0xFF, 64 ); // offsets past the end of the image
+        CHECK( openJsonSnapshotBuffer( &snapshot, damaged, imageLength ) == JPE_NO_ERROR );
+        JsonSnapshotValue root = getSnapshotRoot( &snapshot ), member;
+        for( size_t i = 0; i < getSnapshotLength( &root ); i++ ) {
+            const char *key = (const char *)0;
+            size_t keyLength = 0;
+            if( getSnapshotMember( &root, i, &key, &keyLength, &member ) ) {
+                getSnapshotLength( &member ); // (must not crash)
+                getSnapshotString( &member, &keyLength );
+            }
+        }
+        closeJsonSnapshot( &snapshot );
+    }
+    free( image );
+    free( damaged );
+    resetElement( &element );
+
+    return testResult( "snapshot" );
+}
@@ -0,0 +1,85 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "testCommon.h"
+
+//
+// Projection (JsonParseOptions::ppPaths): only the values at the paths are made
+//
+
+// Parse data keeping pathCount paths, and compare with the expected document (parsed in full)
+static void checkProjection(const char *data, const char * const *ppPaths, size_t pathCount, const char *expected)
+{
+    JsonParseOptions options = { .ppPaths = ppPaths, .pathCount = pathCount, };
+    Element element = { 0, }, expectedElement = { 0, };
+    JsonErrorInfo info = { 0, };
+    CHECK( parseJsonBufferEx( &element, data, strlen(data), &options, &info ) == JPE_NO_ERROR );
+    CHECK( parseJsonString( &expectedElement, expected, (JsonErrorInfo *)0 ) == JPE_NO_ERROR );
+    CHECK( isSameElement( &element, &expectedElement ) );
+    resetElement( &element );
+    resetElement( &expectedElement );
+}
+
+static void checkProjectionError(const char *data, const char * const *ppPaths, size_t pathCount, JsonParsingError error, size_t position)
+{
+    JsonParseOptions options = { .ppPaths = ppPaths, .pathCount = pathCount, };
+    Element element = { 0, };
+    JsonErrorInfo info = { 0, };
+    CHECK( parseJsonBufferEx( &element, data, strlen(data), &options, &info ) == error );
+    CHECK( info.error == error && info.position == position );
+    if( info.position != position ) {
+        fprintf( stderr, "  %s: %d at %zu (expected %d at %zu)\n", data, info.error, info.position, error, position );
+    }
+    resetElement( &element );
+}
+
+int main(void)
+{
+    const char *DOCUMENT =
+        "{\"a\":{\"b\":[10,{\"c\":1,\"d\":[2,3]},\"x\",{\"c\":4}],\"e\":5},"
+        "\"f\":[1,2,{\"g\":null}],"
+        "\"s/t\":{\"u~v\":true,\"w\":false},"
+        "\"h\":\"scalar\","
+        "\"k\\u0065y\":\"escaped\"}";
+
+    // Nested paths: other members are left out, other elements are null (indexes are kept)
+    const char *NESTED[] = { "/a/b/1/c", "/a/b/3", "/f" };
+    checkProjection( DOCUMENT, NESTED, 3, "{\"a\":{\"b\":[null,{\"c\":1},null,{\"c\":4}]},\"f\":[1,2,{\"g\":null}]}" );
+    const char *ELEMENT[] = { "/f/2/g" };
+    checkProjection( DOCUMENT, ELEMENT, 1, "{\"f\":[null,null,{\"g\":null}]}" );
+
+    // "~1" is '/', "~0" is '~'; keys with escapes are matched once decoded
+    const char *ESCAPED[] = { "/s~1t/u~0v", "/key" };
+    checkProjection( DOCUMENT, ESCAPED, 2, "{\"s/t\":{\"u~v\":true},\"key\":\"escaped\"}" );
+
+    // A path through a scalar (or to nothing) keeps nothing of it
+    const char *THROUGH_SCALAR[] = { "/h/0", "/a/e/x", "/none", "/f/9" };
+    checkProjection( DOCUMENT, THROUGH_SCALAR, 4, "{\"a\":{},\"f\":[null,null,null]}" );
+
+    // "" keeps the whole document
+    const char *WHOLE[] = { "/f", "" };
+    checkProjection( DOCUMENT, WHOLE, 2, DOCUMENT );
+    checkProjection( "[1,{\"a\":2}]", WHOLE + 1, 1, "[1,{\"a\":2}]" );
+
+    // A root array: elements are selected by index
+    const char *INDEXES[] = { "/1/a", "/3" };
+    checkProjection( "[0,{\"a\":1,\"b\":2},[3],\"x\"]", INDEXES, 2, "[null,{\"a\":1},null,\"x\"]" );
+
+    // Invalid paths
+    const char *NO_SLASH[] = { "a/b" };
+    const char *BAD_TILDE[] = { "/a~2" };
+    const char *TRAILING_TILDE[] = { "/f", "/a~" };
+    checkProjectionError( DOCUMENT, NO_SLASH, 1, JPE_INVALID_ARGUMENT, 0 );
+    checkProjectionError( DOCUMENT, BAD_TILDE, 1, JPE_INVALID_ARGUMENT, 0 );
+    checkProjectionError( DOCUMENT, TRAILING_TILDE, 2, JPE_INVALID_ARGUMENT, 0 );
+
+    // Skipped values: an unterminated string or container is reported (at the end of the input), and so are errors in kept values
+    const char *KEEP[] = { "/keep" };
+    const char *UNTERMINATED_STRING = "{\"keep\":1,\"skip\":[\"abc, 1], \"keep\":2}";
+    checkProjectionError( UNTERMINATED_STRING, KEEP, 1, JPE_SYNTAX_ERROR_END, strlen(UNTERMINATED_STRING) );
+    const char *UNTERMINATED_ARRAY = "{\"keep\":1,\"skip\":[[1,2]";
+    checkProjectionError( UNTERMINATED_ARRAY, KEEP, 1, JPE_SYNTAX_ERROR_END, strlen(UNTERMINATED_ARRAY) );
+    checkProjectionError( "{\"skip\":1,\"keep\":[1,]}", KEEP, 1, JPE_SYNTAX_ERROR_OBJECT, 20 );
+    checkProjection( "{\"skip\":[1,,tru,{\"\\x\":}],\"keep\":1}", KEEP, 1, "{\"keep\":1}" ); // (other errors in skipped values are not)
+
+    return testResult( "projection" );
+}
@@ -0,0 +1,85 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "testCommon.h"
+
+//
+// validateJson(): the result and errors of parseJsonBufferEx(), without allocating
+//
+
+// malloc() & co. are wrapped to count the allocations (see the Makefile)
+static long long allocationCount = 0;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size)
+{
+    allocationCount++;
+    return __real_malloc( size );
+}
+
+void *__wrap_calloc(size_t count, size_t size)
+{
+    allocationCount++;
+    return __real_calloc( count, size );
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    allocationCount++;
+    return __real_realloc( ptr, size );
+}
+
+// Returns the number of allocations of validateJson()
+static long long checkValidate(const char *data, size_t length)
+{
+    Element element = { 0, };
+    JsonErrorInfo info = { 0, }, validateInfo = { 0, };
+    JsonParsingError ret = parseJsonBufferEx( &element, data, length, (const JsonParseOptions *)0, &info );
+    resetElement( &element );
+
+    long long count = allocationCount;
+    JsonParsingError validateRet = validateJson( data, length, &validateInfo );
+    count = allocationCount - count;
+
+    CHECK( ret == validateRet );
+    CHECK( isSameErrorInfo( &info, &validateInfo ) );
+    if( !isSameErrorInfo( &info, &validateInfo ) ) {
+        fprintf( stderr, "  %.*s: %d at %zu, validate %d at %zu\n", (int)(length < 80 ? length : 80), data,
+                 info.error, info.position, validateInfo.error, validateInfo.position );
+    }
+    return count;
+}
+
+// depth arrays in one another
+static size_t nestedArrays(char *buffer, size_t depth)
+{
+    memset( buffer, '[', depth );
+    memset( buffer + depth, ']', depth );
+    buffer[2 * depth] = '\0';
+    return 2 * depth;
+}
+
+int main(void)
+{
+    for( size_t i = 0; i < JSON_STRING_COUNT; i++ ) {
+        CHECK( checkValidate( JSON_STRINGS[i], strlen(JSON_STRINGS[i]) ) == 0 );
+    }
+
+    // Nesting: the inline frames hold 64 levels; one more takes a block, up to the limit of the parser
+    static char buffer[2 * (JSON_DEFAULT_MAX_DEPTH + 1) + 1];
+    CHECK( checkValidate( buffer, nestedArrays( buffer, 64 ) ) == 0 );
+    CHECK( checkValidate( buffer, nestedArrays( buffer, 65 ) ) == 1 );
+    CHECK( validateJson( buffer, nestedArrays( buffer, 65 ), (JsonErrorInfo *)0 ) == JPE_NO_ERROR );
+    checkValidate( buffer, nestedArrays( buffer, JSON_DEFAULT_MAX_DEPTH ) );
+    checkValidate( buffer, nestedArrays( buffer, JSON_DEFAULT_MAX_DEPTH + 1 ) );
+    checkValidate( buffer, nestedArrays( buffer, 65 ) - 1 ); // (unterminated, with the frames on the heap)
+
+    // Long numbers and strings are checked in place
+    const char *LONG_VALUES = "[1.00000000000000000000000000000000000000000000000000000000000000000000000000000000000001e-5,"
+                              "\"\\u00e9\\ud83d\\ude00 a string longer than any scratch buffer would be kept inline, to be sure\"]";
+    CHECK( checkValidate( LONG_VALUES, strlen(LONG_VALUES) ) == 0 );
+
+    return testResult( "validate" );
+}
@@ -0,0 +1,117 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "testCommon.h"
+
+//
+// Lazy document: the accessors and materializeLazyValue() read what parseJsonBufferEx() makes
+//
+
+// The lazy value holds pElement (read twice, so that the recorded containers are read too)
+static int isSameLazyValue(const JsonLazyValue *pValue, const Element *pElement, JsonArena *pArena)
+{
+    if( getLazyType( pValue ) != pElement->type ) { return 0; }
+
+    Element materialized = { 0, };
+    int same = (materializeLazyValue( pValue, &materialized, pArena ) == JPE_NO_ERROR && isSameElement( &materialized, pElement ));
+    if( !pArena ) { resetElement( &materialized ); }
+    if( !same ) { return 0; }
+
+    for( int pass = 0; pass < 2; pass++ ) {
+        switch( pElement->type )
+        {
+            case TYPE_ARRAY:
+                if( getLazyLength( pValue ) != pElement->length ) { return 0; }
+                for( uint32_t i = 0; i < pElement->length; i++ ) {
+                    JsonLazyValue item;
+                    if( !getLazyArrayElement( pValue, i, &item ) || !isSameLazyValue( &item, &(pElement->arrayValue[i]), pArena ) ) { return 0; }
+                }
+                JsonLazyValue past;
+                if( getLazyArrayElement( pValue, pElement->length, &past ) || findLazyMember( pValue, "", 0, &past ) ) { return 0; }
+                break;
+            case TYPE_OBJECT:
+                if( getLazyLength( pValue ) != pElement->length ) { return 0; }
+                for( uint32_t i = 0; i < pElement->length; i++ ) {
+                    // The first member of that name, as findMember() finds it
+                    const ObjectNode *pNode = &(pElement->objectValue[i]);
+                    JsonLazyValue member;
+                    if( !findLazyMember( pValue, pNode->key, pNode->keyLength, &member ) ||
+                        !isSameLazyValue( &member, findMember( pElement, pNode->key, pNode->keyLength ), pArena ) ) {
+                        return 0;
+                    }
+                }
+                JsonLazyValue missing;
+                if( findLazyMember( pValue, "no such key", 11, &missing ) || getLazyArrayElement( pValue, 0, &missing ) ) { return 0; }
+                break;
+            default:
+                if( getLazyLength( pValue ) != 0 ) { return 0; }
+                break;
+        }
+    }
+    return 1;
+}
+
+static void checkLazy(const char *data, JsonArena *pArena)
+{
+    Element element = { 0, };
+    JsonErrorInfo info = { 0, }, lazyInfo = { 0, };
+    JsonParsingError ret = parseJsonBufferEx( &element, data, strlen(data), (const JsonParseOptions *)0, &info );
+
+    JsonLazyDocument document;
+    JsonParsingError lazyRet = openJsonLazyDocument( &document, data, strlen(data), &lazyInfo );
+    CHECK( ret == lazyRet );
+    CHECK( isSameErrorInfo( &info, &lazyInfo ) );
+    if( ret == JPE_NO_ERROR && lazyRet == JPE_NO_ERROR ) {
+        JsonLazyValue root = getLazyRoot( &document );
+        CHECK( isSameLazyValue( &root, &element, pArena ) );
+    }
+    if( lazyRet == JPE_NO_ERROR ) {
+        closeJsonLazyDocument( &document );
+    }
+
+    resetElement( &element );
+    if( pArena ) { clearJsonArena( pArena ); }
+}
+
+int main(void)
+{
+    JsonArena arena;
+    initJsonArena( &arena, 0 );
+
+    const char *MORE_STRINGS[] = {
+        "{\"k\\u0065y\":1,\"key\":2,\"a\\\"b\":[{},[],\"\"],\"\":-0.5e3}", // escaped keys, a repeated key, empty containers
+        "[[1,[2,[3,[4]]]],{\"a\":{\"b\":{\"c\":[true,false,null]}}},123456789012345678901234567890]",
+        "  [ 1 , \"x\" ,\t{ \"y\" : [ ] } ]  ",
+        "\"only a string\"",
+        "-12",
+    };
+
+    for( size_t i = 0; i < JSON_STRING_COUNT + sizeof(MORE_STRINGS) / sizeof(MORE_STRINGS[0]); i++ ) {
+        const char *data = (i < JSON_STRING_COUNT) ? JSON_STRINGS[i] : MORE_STRINGS[i - JSON_STRING_COUNT];
+        checkLazy( data, (JsonArena *)0 );
+        checkLazy( data, &arena );
+    }
+
+    // A large array, read out of order
+    char *document = (char *)malloc( 16 * 10000 + 16 );
+    size_t length = 0;
+    document[length++] = '[';
+    for( int i = 0; i < 10000; i++ ) {
+        length += (size_t)sprintf( document + length, i ? ",{\"v\":%d}" : "{\"v\":%d}", i );
+    }
+    sprintf( document + length, "]" );
+    JsonLazyDocument lazyDocument;
+    CHECK( openJsonLazyDocument( &lazyDocument, document, strlen(document), (JsonErrorInfo *)0 ) == JPE_NO_ERROR );
+    JsonLazyValue root = getLazyRoot( &lazyDocument );
+    for( int i = 9999; i >= 0; i -= 7 ) {
+        JsonLazyValue item, value;
+        Element element = { 0, };
+        CHECK( getLazyArrayElement( &root, (size_t)i, &item ) && findLazyMember( &item, "v", 1, &value ) );
+        CHECK( materializeLazyValue( &value, &element, (JsonArena *)0 ) == JPE_NO_ERROR && element.iNumberValue == i );
+    }
+    CHECK( getLazyLength( &root ) == 10000 );
+    closeJsonLazyDocument( &lazyDocument );
+    free( document );
+
+    releaseJsonArena( &arena );
+    return testResult( "lazy document" );
+}
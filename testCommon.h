@@ -0,0 +1,64 @@
+#ifndef _TEST_COMMON_H_
+#define _TEST_COMMON_H_
+
+#include <stdio.h>
+#include <string.h>
+#include "jsonParser.h"
+#include "testCorpus.h"
+
+//
+// Checks of the self-checking tests (`make check`): main() returns testResult()
+//
+static int testFailures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if( !(condition) ) { \
+            fprintf( stderr, "%s:%d: CHECK( %s ) failed\n", __FILE__, __LINE__, #condition ); \
+            testFailures++; \
+        } \
+    } while( 0 )
+
+static inline int testResult(const char *name)
+{
+    printf( "%s: %s\n", name, testFailures ? "FAILED" : "OK" );
+    return testFailures != 0;
+}
+
+// Same type and value; members (with their keys) and elements in the same order
+static inline int isSameElement(const Element *pA, const Element *pB)
+{
+    if( pA->type != pB->type ) { return 0; }
+    switch( pA->type )
+    {
+        case TYPE_NULL:       return 1;
+        case TYPE_BOOLEAN:
+        case TYPE_INT_NUMBER: return pA->iNumberValue == pB->iNumberValue;
+        case TYPE_DBL_NUMBER: return !memcmp( &(pA->dNumberValue), &(pB->dNumberValue), sizeof(double) );
+        case TYPE_STRING:     return pA->length == pB->length && !memcmp( pA->stringValue, pB->stringValue, pA->length );
+        case TYPE_ARRAY:
+            if( pA->length != pB->length ) { return 0; }
+            for( uint32_t i = 0; i < pA->length; i++ ) {
+                if( !isSameElement( &(pA->arrayValue[i]), &(pB->arrayValue[i]) ) ) { return 0; }
+            }
+            return 1;
+        case TYPE_OBJECT:
+            if( pA->length != pB->length ) { return 0; }
+            for( uint32_t i = 0; i < pA->length; i++ ) {
+                const ObjectNode *pNodeA = &(pA->objectValue[i]), *pNodeB = &(pB->objectValue[i]);
+                if( pNodeA->keyLength != pNodeB->keyLength || memcmp( pNodeA->key, pNodeB->key, pNodeA->keyLength ) ||
+                    !isSameElement( &(pNodeA->element), &(pNodeB->element) ) ) {
+                    return 0;
+                }
+            }
+            return 1;
+    }
+    return 0;
+}
+
+static inline int isSameErrorInfo(const JsonErrorInfo *pA, const JsonErrorInfo *pB)
+{
+    return pA->error == pB->error && pA->line == pB->line && pA->column == pB->column && pA->position == pB->position;
+}
+
+#endif // _TEST_COMMON_H_